@@ -0,0 +1,95 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <boost/config.hpp>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> theAllocationCount(0);
+
+uint64_t AllocationCounter::getCount()
+{
+    return theAllocationCount.load(std::memory_order_relaxed);
+}
+
+static void *allocate(std::size_t size)
+{
+    theAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Allocating zero bytes must still return a unique pointer.
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) BOOST_NOEXCEPT
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) BOOST_NOEXCEPT
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) BOOST_NOEXCEPT
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) BOOST_NOEXCEPT
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) BOOST_NOEXCEPT
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) BOOST_NOEXCEPT
+{
+    std::free(ptr);
+}
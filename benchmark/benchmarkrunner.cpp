@@ -0,0 +1,148 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "benchmarkrunner.h"
+
+#include "allocationcounter.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+#include <rapidjson/prettywriter.h>
+#include <stdexcept>
+#include <util/rapidjson_iostreams.h>
+
+BenchmarkRunner::BenchmarkRunner(int iterations) : myIterations(iterations)
+{
+}
+
+void BenchmarkRunner::run(const std::string &name, const Function &function)
+{
+    function();
+
+    int itemCount = -1;
+    const uint64_t startAllocations = AllocationCounter::getCount();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < myIterations; ++i)
+        itemCount = function();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    const uint64_t allocations =
+        AllocationCounter::getCount() - startAllocations;
+
+    Result result;
+    result.myName = name;
+    result.myIterations = myIterations;
+    result.myTime =
+        std::chrono::duration<double, std::milli>(end - start).count() /
+        myIterations;
+    result.myAllocations = allocations / myIterations;
+    result.myItemCount = itemCount;
+    myResults.push_back(result);
+
+    std::cout << std::left << std::setw(56) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(12)
+              << result.myTime << " ms" << std::setw(12)
+              << result.myAllocations << " allocs";
+    if (itemCount >= 0)
+        std::cout << std::setw(10) << itemCount << " items";
+    std::cout << std::endl;
+}
+
+void BenchmarkRunner::writeJson(std::ostream &os) const
+{
+    Util::RapidJSON::OStreamWrapper stream(os);
+    rapidjson::PrettyWriter<Util::RapidJSON::OStreamWrapper> writer(stream);
+
+    writer.StartObject();
+    for (const Result &result : myResults)
+    {
+        writer.Key(result.myName.c_str());
+        writer.StartObject();
+        writer.Key("iterations");
+        writer.Int(result.myIterations);
+        writer.Key("time_ms");
+        writer.Double(result.myTime);
+        writer.Key("allocations");
+        writer.Uint64(result.myAllocations);
+        if (result.myItemCount >= 0)
+        {
+            writer.Key("items");
+            writer.Int(result.myItemCount);
+        }
+        writer.EndObject();
+    }
+    writer.EndObject();
+}
+
+bool BenchmarkRunner::checkThresholds(const std::string &filename,
+                                      double tolerance,
+                                      std::ostream &errors) const
+{
+    std::ifstream file(filename);
+    if (!file)
+        throw std::runtime_error("Could not open " + filename);
+
+    Util::RapidJSON::IStreamWrapper stream(file);
+    rapidjson::Document document;
+    document.ParseStream(stream);
+
+    if (document.HasParseError())
+    {
+        throw std::runtime_error(
+            "Could not parse " + filename + ": " +
+            GetParseError_En(document.GetParseError()));
+    }
+    else if (!document.IsObject())
+        throw std::runtime_error("Expected a JSON object in " + filename);
+
+    bool passed = true;
+    for (const Result &result : myResults)
+    {
+        auto threshold = document.FindMember(result.myName.c_str());
+        if (threshold == document.MemberEnd())
+            continue;
+
+        const rapidjson::Value &limits = threshold->value;
+
+        auto maxTime = limits.FindMember("time_ms");
+        if (maxTime != limits.MemberEnd() &&
+            result.myTime > maxTime->value.GetDouble() * tolerance)
+        {
+            errors << result.myName << ": " << result.myTime
+                   << " ms exceeds the threshold of "
+                   << maxTime->value.GetDouble() * tolerance << " ms"
+                   << std::endl;
+            passed = false;
+        }
+
+        auto maxAllocations = limits.FindMember("allocations");
+        if (maxAllocations != limits.MemberEnd() &&
+            result.myAllocations > maxAllocations->value.GetUint64())
+        {
+            errors << result.myName << ": " << result.myAllocations
+                   << " allocations exceeds the threshold of "
+                   << maxAllocations->value.GetUint64() << std::endl;
+            passed = false;
+        }
+    }
+
+    return passed;
+}
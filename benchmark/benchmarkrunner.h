@@ -0,0 +1,73 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCHMARK_BENCHMARKRUNNER_H
+#define BENCHMARK_BENCHMARKRUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// Times benchmarks and counts their allocations, and compares the results
+/// against the thresholds for detecting performance regressions.
+class BenchmarkRunner
+{
+public:
+    struct Result
+    {
+        std::string myName;
+        int myIterations;
+        /// Average wall time of an iteration, in milliseconds.
+        double myTime;
+        /// Average number of allocations in an iteration.
+        uint64_t myAllocations;
+        /// The number of items (e.g. in the scene) that were created by an
+        /// iteration, or -1 if not applicable.
+        int myItemCount;
+    };
+
+    /// A benchmark returns the number of items that it created, or -1.
+    typedef std::function<int()> Function;
+
+    explicit BenchmarkRunner(int iterations);
+
+    /// Runs the benchmark, after running it once without timing it to warm up
+    /// any caches.
+    void run(const std::string &name, const Function &function);
+
+    const std::vector<Result> &getResults() const { return myResults; }
+
+    /// Writes the results as JSON.
+    void writeJson(std::ostream &os) const;
+
+    /// Checks the results against the thresholds in a JSON file, which maps
+    /// benchmark names to their maximum "time_ms" and "allocations". The time
+    /// thresholds are scaled by the tolerance (e.g. for debug builds).
+    /// Benchmarks without a threshold are not checked.
+    /// Returns false and reports the failures if any threshold was exceeded.
+    /// @throw std::runtime_error if the file could not be read.
+    bool checkThresholds(const std::string &filename, double tolerance,
+                         std::ostream &errors) const;
+
+private:
+    const int myIterations;
+    std::vector<Result> myResults;
+};
+
+#endif
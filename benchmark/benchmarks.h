@@ -0,0 +1,52 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCHMARK_BENCHMARKS_H
+#define BENCHMARK_BENCHMARKS_H
+
+#include <string>
+
+class BenchmarkRunner;
+class Document;
+class Score;
+
+namespace Benchmarks
+{
+/// Stacks boxes of varying widths with the vertical layout.
+void runVerticalLayout(BenchmarkRunner &runner);
+
+/// Lays out staves with an increasing number of ornamented positions.
+void runOrnamentedStaff(BenchmarkRunner &runner);
+
+/// Computes the layout, standard notation notes, and stems of each staff.
+void runLayout(BenchmarkRunner &runner, const std::string &prefix,
+               const Score &score);
+
+/// Generates the MIDI events for export, and the first events for playback.
+void runMidi(BenchmarkRunner &runner, const std::string &prefix,
+             const Score &score);
+
+/// Renders the score's audio with the built-in synthesizer.
+void runSynthesizer(BenchmarkRunner &runner, const std::string &prefix,
+                    const Score &score);
+
+/// Renders the document, and moves the caret through the rendered score.
+void runRender(BenchmarkRunner &runner, const std::string &prefix,
+               Document &document);
+}
+
+#endif
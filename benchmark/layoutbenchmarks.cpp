@@ -0,0 +1,147 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "benchmarks.h"
+
+#include "benchmarkrunner.h"
+#include "scoregenerator.h"
+
+#include <memory>
+#include <painters/layoutinfo.h>
+#include <painters/musicfont.h>
+#include <painters/verticallayout.h>
+#include <QFontMetricsF>
+#include <QGraphicsRectItem>
+#include <random>
+#include <score/score.h>
+#include <vector>
+
+void Benchmarks::runVerticalLayout(BenchmarkRunner &runner)
+{
+    std::mt19937 generator(42);
+
+    // The time should depend on the number of boxes, but not on their width.
+    for (int count : { 1000, 10000 })
+    {
+        for (int span : { 4, 64, 1024 })
+        {
+            std::uniform_int_distribution<int> leftDist(0, 2048 - span);
+            std::vector<int> lefts;
+            for (int i = 0; i < count; ++i)
+                lefts.push_back(leftDist(generator));
+
+            runner.run("VerticalLayout/boxes=" + std::to_string(count) +
+                           "/span=" + std::to_string(span),
+                       [&]() {
+                           VerticalLayout layout;
+                           for (int left : lefts)
+                               layout.addBox(left, left + span, 1);
+                           return -1;
+                       });
+        }
+    }
+}
+
+void Benchmarks::runOrnamentedStaff(BenchmarkRunner &runner)
+{
+    for (int numPositions : { 64, 256, 1024 })
+    {
+        Score score;
+        score.insertSystem(ScoreGenerator::makeOrnamentedSystem(numPositions));
+
+        const Score &constScore = score;
+        const System &system = constScore.getSystems()[0];
+        const Staff &staff = system.getStaves()[0];
+
+        runner.run("LayoutInfo/ornamented/positions=" +
+                       std::to_string(numPositions),
+                   [&]() {
+                       LayoutInfo layout(score, system, 0, staff, 0);
+                       return -1;
+                   });
+    }
+}
+
+/// Calls the function for each staff in the score.
+template <typename Function>
+static void forEachStaff(const Score &score, Function function)
+{
+    int systemIndex = 0;
+    for (const System &system : score.getSystems())
+    {
+        int staffIndex = 0;
+        for (const Staff &staff : system.getStaves())
+            function(system, systemIndex, staff, staffIndex++);
+
+        ++systemIndex;
+    }
+}
+
+void Benchmarks::runLayout(BenchmarkRunner &runner, const std::string &prefix,
+                           const Score &score)
+{
+    runner.run(prefix + "/LayoutInfo", [&]() {
+        forEachStaff(score, [&](const System &system, int systemIndex,
+                                const Staff &staff, int staffIndex) {
+            LayoutInfo layout(score, system, systemIndex, staff, staffIndex);
+        });
+        return -1;
+    });
+
+    // Compute the layouts once, and then time the standard notation and the
+    // stems on their own.
+    std::vector<std::unique_ptr<LayoutInfo>> layouts;
+    forEachStaff(score, [&](const System &system, int systemIndex,
+                            const Staff &staff, int staffIndex) {
+        layouts.emplace_back(new LayoutInfo(score, system, systemIndex, staff,
+                                            staffIndex));
+    });
+
+    runner.run(prefix + "/StdNotationNote", [&]() {
+        auto layout = layouts.begin();
+        forEachStaff(score, [&](const System &system, int systemIndex,
+                                const Staff &staff, int staffIndex) {
+            std::vector<StdNotationNote> notes;
+            std::array<std::vector<NoteStem>, Staff::NUM_VOICES> stems;
+            std::array<std::vector<BeamGroup>, Staff::NUM_VOICES> groups;
+            StdNotationNote::getNotesInStaff(score, system, systemIndex, staff,
+                                             staffIndex, **layout++, notes,
+                                             stems, groups);
+        });
+        return -1;
+    });
+
+    const QFont font = MusicFont::getFont(MusicFont::DEFAULT_FONT_SIZE);
+    const QFontMetricsF fm(font);
+
+    runner.run(prefix + "/NoteStems", [&]() {
+        QGraphicsRectItem parent;
+        for (const std::unique_ptr<LayoutInfo> &layout : layouts)
+        {
+            for (int voice = 0; voice < Staff::NUM_VOICES; ++voice)
+            {
+                for (const BeamGroup &group : layout->getBeamGroups(voice))
+                {
+                    group.drawStems(&parent, layout->getNoteStems(voice), font,
+                                    fm, *layout);
+                }
+            }
+        }
+
+        return parent.childItems().size();
+    });
+}
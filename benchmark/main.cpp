@@ -0,0 +1,192 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "benchmarkrunner.h"
+#include "benchmarks.h"
+#include "scoregenerator.h"
+
+#include <app/documentmanager.h>
+#include <app/settingsmanager.h>
+#include <boost/program_options.hpp>
+#include <formats/fileformatmanager.h>
+#include <fstream>
+#include <iostream>
+#include <painters/musicfont.h>
+#include <QApplication>
+#include <QFileInfo>
+#include <score/score.h>
+#include <string>
+#include <vector>
+
+static void importScore(FileFormatManager &manager,
+                        const std::string &filename, Score &score)
+{
+    QFileInfo fileInfo(QString::fromStdString(filename));
+    boost::optional<FileFormat> format =
+        manager.findFormat(fileInfo.suffix().toStdString());
+    if (!format)
+        throw std::runtime_error("Unsupported file type: " + filename);
+
+    manager.importFile(score, filename, *format);
+}
+
+/// Runs the layout, render, and MIDI benchmarks for a score.
+static void runScoreBenchmarks(BenchmarkRunner &runner,
+                               const std::string &prefix, Document &document)
+{
+    Benchmarks::runLayout(runner, prefix, document.getScore());
+    Benchmarks::runMidi(runner, prefix, document.getScore());
+    Benchmarks::runRender(runner, prefix, document);
+}
+
+int main(int argc, char *argv[])
+{
+    // The score is rendered, but no windows are shown.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    std::vector<std::string> files;
+    std::string outputFile;
+    std::string thresholdsFile;
+    double tolerance = 1;
+    int iterations = 5;
+    int numSystems = 200;
+
+    namespace po = boost::program_options;
+    po::options_description desc(
+        "Usage: pte_benchmarks [options] [files...]\nTimes the layout, "
+        "rendering, and MIDI generation of synthetic scores and of the given "
+        "files.\n\nOptions");
+    try
+    {
+        desc.add_options()
+            ("help,h", "Displays this help.")
+            ("output,o", po::value<std::string>(&outputFile),
+             "Writes the results to a JSON file.")
+            ("thresholds", po::value<std::string>(&thresholdsFile),
+             "Fails if a result exceeds the thresholds in a JSON file.")
+            ("tolerance", po::value<double>(&tolerance),
+             "Scales the time thresholds (e.g. for debug builds).")
+            ("iterations", po::value<int>(&iterations),
+             "The number of times to run each benchmark.")
+            ("systems", po::value<int>(&numSystems),
+             "The number of systems in the largest synthetic score.")
+            ("files", po::value<std::vector<std::string>>(&files),
+             "Additional scores to benchmark.");
+        po::positional_options_description p;
+        p.add("files", -1);
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv)
+                      .options(desc)
+                      .positional(p)
+                      .run(),
+                  vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if (iterations < 1)
+            throw po::error("--iterations must be at least 1");
+    }
+    catch (po::error &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    MusicFont::loadFonts();
+
+    BenchmarkRunner runner(iterations);
+
+    try
+    {
+        Benchmarks::runVerticalLayout(runner);
+        Benchmarks::runOrnamentedStaff(runner);
+
+        // Use the default settings, so that the results don't depend on the
+        // user's configuration.
+        SettingsManager settingsManager;
+        FileFormatManager formatManager(settingsManager);
+
+        for (const std::string &file : files)
+        {
+            Document document;
+            importScore(formatManager, file, document.getScore());
+            const QFileInfo fileInfo(QString::fromStdString(file));
+            runScoreBenchmarks(runner, fileInfo.fileName().toStdString(),
+                               document);
+        }
+
+        for (int systems : { numSystems / 10, numSystems })
+        {
+            Document document;
+            ScoreGenerator::makeLargeScore(document.getScore(), systems, 4);
+            runScoreBenchmarks(runner, "synthetic/systems=" +
+                                           std::to_string(systems),
+                               document);
+        }
+
+        // Only the MIDI generation depends on the number of repeats.
+        {
+            Score score;
+            ScoreGenerator::makeLargeScore(score, numSystems / 10, 4);
+            ScoreGenerator::addRepeat(score, 10);
+            Benchmarks::runMidi(runner, "repeated/systems=" +
+                                            std::to_string(numSystems / 10) +
+                                            "/repeats=10",
+                                score);
+        }
+
+        // The audio rendering only needs a moderately sized score.
+        {
+            Score score;
+            ScoreGenerator::makeLargeScore(score, numSystems / 10, 4);
+            Benchmarks::runSynthesizer(
+                runner, "synthetic/systems=" + std::to_string(numSystems / 10),
+                score);
+        }
+
+        if (!outputFile.empty())
+        {
+            std::ofstream output(outputFile);
+            if (!output)
+                throw std::runtime_error("Could not write " + outputFile);
+
+            runner.writeJson(output);
+        }
+
+        if (!thresholdsFile.empty() &&
+            !runner.checkThresholds(thresholdsFile, tolerance, std::cerr))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "benchmarks.h"
+
+#include "benchmarkrunner.h"
+
+#include <audio/midieventstream.h>
+#include <midi/midifile.h>
+#include <midi/synthesizer.h>
+
+void Benchmarks::runMidi(BenchmarkRunner &runner, const std::string &prefix,
+                         const Score &score)
+{
+    runner.run(prefix + "/MidiFile", [&]() {
+        MidiFile file;
+        file.load(score, MidiFile::LoadOptions());
+
+        size_t numEvents = 0;
+        for (const MidiEventList &track : file.getTracks())
+            numEvents += track.size();
+
+        return static_cast<int>(numEvents);
+    });
+
+    // The time until playback can start shouldn't depend on the length of the
+    // score.
+    runner.run(prefix + "/MidiEventStream", [&]() {
+        MidiEventStream stream(score, MidiFile::LoadOptions(), 4);
+        MidiEventList events;
+        stream.readEvents(events);
+        return static_cast<int>(events.size());
+    });
+}
+
+void Benchmarks::runSynthesizer(BenchmarkRunner &runner,
+                                const std::string &prefix, const Score &score)
+{
+    MidiFile file;
+    file.load(score, MidiFile::LoadOptions());
+
+    // Rendering should be much faster than real time.
+    runner.run(prefix + "/Synthesizer", [&]() {
+        size_t numFrames = 0;
+        Synthesizer synth;
+        synth.render(file, [&](const float *, size_t frames) {
+            numFrames += frames;
+        });
+
+        return static_cast<int>(numFrames);
+    });
+}
@@ -0,0 +1,59 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "benchmarks.h"
+
+#include "benchmarkrunner.h"
+
+#include <app/documentmanager.h>
+#include <app/scorearea.h>
+#include <score/score.h>
+
+void Benchmarks::runRender(BenchmarkRunner &runner, const std::string &prefix,
+                           Document &document)
+{
+    ScoreArea scoreArea(nullptr);
+
+    runner.run(prefix + "/renderDocument", [&]() {
+        scoreArea.renderDocument(document);
+        return scoreArea.scene()->items().size();
+    });
+
+    // Move the caret through every position of the score, which updates the
+    // caret painter.
+    Caret &caret = document.getCaret();
+    runner.run(prefix + "/CaretPainter", [&]() {
+        caret.moveToFirstSystem();
+        caret.moveToStartPosition();
+
+        const int numSystems =
+            static_cast<int>(document.getScore().getSystems().size());
+        for (int i = 0; i < numSystems; ++i)
+        {
+            int prevPosition = -1;
+            while (caret.getLocation().getPositionIndex() != prevPosition)
+            {
+                prevPosition = caret.getLocation().getPositionIndex();
+                caret.moveHorizontal(1);
+            }
+
+            caret.moveSystem(1);
+        }
+
+        return -1;
+    });
+}
@@ -0,0 +1,151 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scoregenerator.h"
+
+#include <score/score.h>
+#include <string>
+
+System ScoreGenerator::makeOrnamentedSystem(int numPositions)
+{
+    System system;
+    Staff staff(6);
+
+    // Leave room for a barline after every 16 positions.
+    const int BAR_LENGTH = 17;
+    int position = 0;
+
+    for (int i = 0; i < numPositions; ++i)
+    {
+        position = i + 1 + i / (BAR_LENGTH - 1);
+
+        Position pos(position, Position::SixteenthNote);
+        pos.insertNote(Note(i % 6, i % 12));
+        pos.setProperty(Position::LetRing);
+        pos.setProperty(Position::Vibrato, i % 16 < 12);
+        pos.setProperty(Position::PalmMuting, i % 8 < 6);
+        pos.setProperty(Position::TremoloPicking, i % 4 == 0);
+        pos.setProperty(Position::Staccato, i % 3 == 0);
+        staff.getVoices()[0].insertPosition(pos);
+
+        if (i % 8 == 0)
+            staff.insertDynamic(Dynamic(position, Dynamic::mf));
+    }
+
+    system.insertStaff(staff);
+
+    for (int bar = BAR_LENGTH; bar < position; bar += BAR_LENGTH)
+        system.insertBarline(Barline(bar, Barline::SingleBar));
+    system.getBarlines().back().setPosition(position + 1);
+
+    return system;
+}
+
+/// Fills a bar of 4/4 with four eighth notes and eight sixteenth notes.
+static void addBar(Voice &voice, int barIndex, int firstPosition)
+{
+    for (int i = 0; i < 12; ++i)
+    {
+        Position pos(firstPosition + i, i < 4 ? Position::EighthNote
+                                              : Position::SixteenthNote);
+
+        // Start the last bar of the system with a rest.
+        if (barIndex == 3 && i == 0)
+            pos.setProperty(Position::Rest);
+        else
+        {
+            Note note(i % 6, (i * 5 + barIndex) % 15);
+            if (barIndex == 1 && i % 4 == 3)
+                note.setProperty(Note::ShiftSlide);
+            else if (barIndex == 2 && i % 4 == 1)
+                note.setBend(Bend(Bend::BendAndRelease, 4));
+
+            pos.insertNote(note);
+            if (i % 4 == 0)
+                pos.insertNote(Note((i + 2) % 6, (i * 3) % 12));
+        }
+
+        pos.setProperty(Position::LetRing, barIndex == 1);
+        pos.setProperty(Position::Vibrato, barIndex == 2 && i >= 4);
+        pos.setProperty(Position::Staccato, i % 5 == 0);
+        voice.insertPosition(pos);
+    }
+}
+
+void ScoreGenerator::makeLargeScore(Score &score, int numSystems,
+                                    int numStaves)
+{
+    const int BAR_COUNT = 4;
+    const int BAR_LENGTH = 13;
+
+    Instrument instrument;
+    instrument.setDescription("Guitar");
+    score.insertInstrument(instrument);
+
+    PlayerChange players;
+    for (int i = 0; i < numStaves; ++i)
+    {
+        Player player;
+        player.setDescription("Player " + std::to_string(i + 1));
+        score.insertPlayer(player);
+        players.insertActivePlayer(i, ActivePlayer(i, 0));
+    }
+
+    ScoreUtils::addStandardFilters(score);
+
+    for (int i = 0; i < numSystems; ++i)
+    {
+        System system;
+
+        for (int j = 0; j < numStaves; ++j)
+        {
+            Staff staff(6);
+            for (int bar = 0; bar < BAR_COUNT; ++bar)
+            {
+                addBar(staff.getVoices()[0], bar,
+                       bar * BAR_LENGTH + 1);
+            }
+
+            staff.insertDynamic(Dynamic(1, Dynamic::mf));
+            system.insertStaff(staff);
+        }
+
+        for (int bar = 1; bar < BAR_COUNT; ++bar)
+            system.insertBarline(Barline(bar * BAR_LENGTH, Barline::SingleBar));
+        system.getBarlines().back().setPosition(BAR_COUNT * BAR_LENGTH);
+
+        if (i == 0)
+        {
+            system.insertPlayerChange(players);
+            system.insertTempoMarker(TempoMarker(0));
+        }
+        system.insertChord(ChordText(1, ChordName()));
+
+        score.insertSystem(system);
+    }
+}
+
+void ScoreGenerator::addRepeat(Score &score, int repeatCount)
+{
+    System &firstSystem = score.getSystems().front();
+    firstSystem.getBarlines().front().setBarType(Barline::RepeatStart);
+
+    System &lastSystem = score.getSystems().back();
+    Barline &lastBar = lastSystem.getBarlines().back();
+    lastBar.setBarType(Barline::RepeatEnd);
+    lastBar.setRepeatCount(repeatCount);
+}
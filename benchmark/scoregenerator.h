@@ -0,0 +1,40 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCHMARK_SCOREGENERATOR_H
+#define BENCHMARK_SCOREGENERATOR_H
+
+class Score;
+class System;
+
+/// Creates synthetic scores for the benchmarks.
+namespace ScoreGenerator
+{
+/// Creates a system with a staff where every position has symbols that are
+/// stacked above the tab staff (let ring, vibrato, palm muting, etc).
+System makeOrnamentedSystem(int numPositions);
+
+/// Fills the score with systems of beamed notes, chords, rests, bends, slides
+/// and other symbols, with a player for each staff.
+void makeLargeScore(Score &score, int numSystems, int numStaves);
+
+/// Surrounds the whole score with a repeat that is played the given number of
+/// times.
+void addRepeat(Score &score, int repeatCount);
+}
+
+#endif
@@ -27,16 +27,12 @@ PolishScore::PolishScore(Score &score)
 
 void PolishScore::redo()
 {
-    for (const System &system : myScore.getSystems())
-        myOriginalSystems.push_back(system);
-
+    myOriginalSystems = myScore.getSystemsSnapshot();
     ScoreUtils::polishScore(myScore);
 }
 
 void PolishScore::undo()
 {
-    std::copy(myOriginalSystems.begin(), myOriginalSystems.end(),
-              myScore.getSystems().begin());
-
-    myOriginalSystems.clear();
+    myScore.restoreSystemsSnapshot(myOriginalSystems);
+    myOriginalSystems = Score::SystemList();
 }
@@ -89,6 +89,7 @@
 #include <audio/settings.h>
 
 #include <boost/lexical_cast.hpp>
+#include <boost/optional/optional.hpp>
 #include <boost/range/algorithm/transform.hpp>
 #include <chrono>
 
@@ -121,12 +122,16 @@
 
 #include <formats/fileformatmanager.h>
 
+#include <painters/glyphbatchitem.h>
+#include <painters/musicfont.h>
+#include <painters/systemrastercache.h>
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDesktopServices>
 #include <QDockWidget>
 #include <QFileDialog>
-#include <QFontDatabase>
+#include <QGuiApplication>
 #include <QKeyEvent>
 #include <QMenuBar>
 #include <QMessageBox>
@@ -134,8 +139,10 @@
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QPrintPreviewDialog>
+#include <QScreen>
 #include <QScrollArea>
 #include <QTabBar>
+#include <QTimer>
 #include <QUrl>
 #include <QVBoxLayout>
 
@@ -162,17 +169,14 @@ PowerTabEditor::PowerTabEditor()
       myInstrumentPanel(nullptr),
       myInstrumentDockWidget(nullptr),
       myPlaybackWidget(nullptr),
-      myPlaybackArea(nullptr)
+      myPlaybackArea(nullptr),
+      myPlaybackTimer(nullptr)
 {
     this->setWindowIcon(QIcon(":icons/app_icon.png"));
 
     setAcceptDrops(true);
 
-    // Load the music notation font.
-    QFontDatabase::addApplicationFont(":fonts/emmentaler-13.otf");
-    // Load the tab note font.
-    QFontDatabase::addApplicationFont(":fonts/LiberationSans-Regular.ttf");
-    QFontDatabase::addApplicationFont(":fonts/LiberationSerif-Regular.ttf");
+    MusicFont::loadFonts();
 
     connect(myUndoManager.get(), SIGNAL(redrawNeeded(int)), this,
             SLOT(redrawSystem(int)));
@@ -181,6 +185,10 @@ PowerTabEditor::PowerTabEditor()
     connect(myUndoManager.get(), SIGNAL(cleanChanged(bool)), this,
             SLOT(updateModified(bool)));
 
+    myPlaybackTimer = new QTimer(this);
+    connect(myPlaybackTimer, &QTimer::timeout, this,
+            &PowerTabEditor::updatePlaybackLocation);
+
     myTuningDictionary->loadInBackground();
     mySettingsManager->load(Paths::getConfigDir());
 
@@ -340,6 +348,8 @@ bool PowerTabEditor::closeTab(int index)
     myUndoManager->removeStack(index);
     myDocumentManager->removeDocument(index);
     delete myTabWidget->widget(index);
+    // Release any glyphs that were only used by the closed document.
+    GlyphBatchItem::clearCache();
 
     // Get the index of the tab that we will now switch to.
     const int currentIndex = myTabWidget->currentIndex();
@@ -566,7 +576,8 @@ void PowerTabEditor::editFileInformation()
     }
 }
 
-void PowerTabEditor::startStopPlayback(bool from_measure_start)
+void PowerTabEditor::startStopPlayback(bool from_measure_start,
+                                       bool loop_selection)
 {
     myIsPlaying = !myIsPlaying;
 
@@ -582,6 +593,28 @@ void PowerTabEditor::startStopPlayback(bool from_measure_start)
             moveCaretToNextBar();
         }
 
+        // Find the bars that contain the selection, and start playback from
+        // the first bar.
+        boost::optional<SystemLocation> loop_end;
+        if (loop_selection)
+        {
+            const ScoreLocation &location = getLocation();
+            const System &system = location.getSystem();
+            const int first = std::min(location.getSelectionStart(),
+                                       location.getPositionIndex());
+            const int last = std::max(location.getSelectionStart(),
+                                      location.getPositionIndex());
+
+            const Barline *start_bar = system.getPreviousBarline(first + 1);
+            const Barline *end_bar = system.getNextBarline(last);
+            loop_end = end_bar ? SystemLocation(location.getSystemIndex(),
+                                                end_bar->getPosition())
+                               : SystemLocation(location.getSystemIndex() + 1,
+                                                0);
+
+            getCaret().moveToPosition(start_bar->getPosition());
+        }
+
         getCaret().setIsInPlaybackMode(true);
         myPlaybackWidget->setPlaybackMode(true);
         enableEditing(false);
@@ -591,10 +624,18 @@ void PowerTabEditor::startStopPlayback(bool from_measure_start)
             new MidiPlayer(*mySettingsManager, location,
                            myPlaybackWidget->getPlaybackSpeed()));
 
+        if (loop_end)
+            myMidiPlayer->setLoop(*loop_end);
+
+        for (unsigned int i = 0; i < location.getScore().getPlayers().size();
+             ++i)
+        {
+            myMidiPlayer->setPlayerMuted(i, myMixer->isPlayerMuted(i));
+            myMidiPlayer->setPlayerSolo(i, myMixer->isPlayerSolo(i));
+        }
+
         connect(myMidiPlayer.get(), SIGNAL(playbackSystemChanged(int)), this,
                 SLOT(moveCaretToSystem(int)));
-        connect(myMidiPlayer.get(), SIGNAL(playbackPositionChanged(int)), this,
-                SLOT(moveCaretToPosition(int)));
         connect(myMidiPlayer.get(), SIGNAL(finished()), this,
                 SLOT(startStopPlayback()));
         connect(myPlaybackWidget, &PlaybackWidget::playbackSpeedChanged,
@@ -605,9 +646,18 @@ void PowerTabEditor::startStopPlayback(bool from_measure_start)
         });
 
         myMidiPlayer->start();
+
+        // Rather than being notified about every note, follow the playback
+        // position once per frame.
+        const qreal refresh_rate =
+            QGuiApplication::primaryScreen()->refreshRate();
+        myPlaybackTimer->start(
+            static_cast<int>(1000 / (refresh_rate > 0 ? refresh_rate : 60)));
     }
     else
     {
+        myPlaybackTimer->stop();
+
         // If we manually stop playback, tell the midi thread to finish.
         if (myMidiPlayer && myMidiPlayer->isRunning())
         {
@@ -1609,6 +1659,13 @@ void PowerTabEditor::editPlayer(int playerIndex, const Player &player,
             new EditPlayer(location.getScore(), playerIndex, player),
             UndoManager::AFFECTS_ALL_SYSTEMS);
     }
+
+    // Let the changes be heard immediately during playback.
+    if (myIsPlaying && myMidiPlayer)
+    {
+        myMidiPlayer->setPlayerVolume(playerIndex, player.getMaxVolume());
+        myMidiPlayer->setPlayerPan(playerIndex, player.getPan());
+    }
 }
 
 void PowerTabEditor::removePlayer(int index)
@@ -1626,6 +1683,30 @@ void PowerTabEditor::editInstrument(int index, const Instrument &instrument)
     myUndoManager->push(
         new EditInstrument(location.getScore(), index, instrument),
         UndoManager::AFFECTS_ALL_SYSTEMS);
+
+    // During playback, switch the players that are currently using the
+    // instrument over to the new preset.
+    if (myIsPlaying && myMidiPlayer)
+    {
+        const PlayerChange *players = ScoreUtils::getCurrentPlayers(
+            location.getScore(), location.getSystemIndex(),
+            location.getPositionIndex());
+        if (!players)
+            return;
+
+        for (unsigned int i = 0; i < location.getSystem().getStaves().size();
+             ++i)
+        {
+            for (const ActivePlayer &player : players->getActivePlayers(i))
+            {
+                if (player.getInstrumentNumber() == index)
+                {
+                    myMidiPlayer->setPlayerPreset(player.getPlayerNumber(),
+                                                  instrument.getMidiPreset());
+                }
+            }
+        }
+    }
 }
 
 void PowerTabEditor::removeInstrument(int index)
@@ -1881,6 +1962,13 @@ void PowerTabEditor::createCommands()
         startStopPlayback(/* from_measure_start */ true);
     });
 
+    myLoopSelectionCommand = new Command(
+        tr("Loop Selection"), "Playback.LoopSelection", QKeySequence(), this);
+    connect(myLoopSelectionCommand, &QAction::triggered, [this]() {
+        startStopPlayback(/* from_measure_start */ false,
+                          /* loop_selection */ true);
+    });
+
     myStopCommand =
         new Command(tr("Stop"), "Playback.Stop", Qt::ALT + Qt::Key_Space, this);
     connect(myStopCommand, &QAction::triggered, this,
@@ -2533,7 +2621,7 @@ void PowerTabEditor::createMixer()
     scroll->setMinimumSize(0, 150);
 
     myMixer = new Mixer(scroll, *myTuningDictionary, myPlayerEditPubSub,
-                        myPlayerRemovePubSub);
+                        myPlayerRemovePubSub, myPlayerMuteSoloPubSub);
 
     scroll->setWidget(myMixer);
     myMixerDockWidget->setWidget(scroll);
@@ -2546,6 +2634,31 @@ void PowerTabEditor::createMixer()
     myPlayerRemovePubSub.subscribe([=](int index) {
         removePlayer(index);
     });
+    myPlayerMuteSoloPubSub.subscribe([=](int index, bool muted, bool solo) {
+        if (myIsPlaying && myMidiPlayer)
+        {
+            myMidiPlayer->setPlayerMuted(index, muted);
+            myMidiPlayer->setPlayerSolo(index, solo);
+        }
+    });
+}
+
+void PowerTabEditor::updatePlaybackLocation()
+{
+    if (!myIsPlaying || !myMidiPlayer)
+        return;
+
+    // Moving to a new system is signalled separately, so wait until the caret
+    // has moved there.
+    const SystemLocation playback_location =
+        myMidiPlayer->getPlaybackLocation();
+    const ScoreLocation &location = getLocation();
+
+    if (playback_location.getSystem() == location.getSystemIndex() &&
+        playback_location.getPosition() != location.getPositionIndex())
+    {
+        moveCaretToPosition(playback_location.getPosition());
+    }
 }
 
 void PowerTabEditor::createInstrumentPanel()
@@ -2675,6 +2788,7 @@ void PowerTabEditor::createMenus()
     myPlaybackMenu = menuBar()->addMenu(tr("Play&back"));
     myPlaybackMenu->addAction(myPlayPauseCommand);
     myPlaybackMenu->addAction(myPlayFromStartOfMeasureCommand);
+    myPlaybackMenu->addAction(myLoopSelectionCommand);
     myPlaybackMenu->addAction(myStopCommand);
     myPlaybackMenu->addAction(myRewindCommand);
     myPlaybackMenu->addAction(myMetronomeCommand);
@@ -2934,6 +3048,13 @@ void PowerTabEditor::setupNewTab()
     });
 
     auto scorearea = new ScoreArea(this);
+    {
+        auto settings = mySettingsManager->getReadHandle();
+        scorearea->setRasterCacheEnabled(
+            settings->get(Settings::SystemRasterCache));
+        SystemRasterCache::getInstance().setBudget(
+            settings->get(Settings::SystemRasterCacheBudget) * 1024LL * 1024);
+    }
     scorearea->renderDocument(doc);
     scorearea->installEventFilter(this);
 
@@ -3035,7 +3156,8 @@ void PowerTabEditor::updateCommands()
     if (myIsPlaying)
         return;
 
-    ScoreLocation location = getLocation();
+    // Only use const accessors, to avoid bumping the score's revisions.
+    const ScoreLocation &location = getLocation();
     const Score &score = location.getScore();
     if (score.getSystems().empty())
         return;
@@ -3255,6 +3377,7 @@ void PowerTabEditor::enableEditing(bool enable)
     myPrintCommand->setEnabled(enable);
     myPrintPreviewCommand->setEnabled(enable);
     myPlayFromStartOfMeasureCommand->setEnabled(enable);
+    myLoopSelectionCommand->setEnabled(enable);
     myAddPlayerCommand->setEnabled(enable);
     myAddInstrumentCommand->setEnabled(enable);
     myPlayerChangeCommand->setEnabled(enable);
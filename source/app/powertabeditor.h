@@ -36,6 +36,7 @@ class MidiPlayer;
 class Mixer;
 class PlaybackWidget;
 class QActionGroup;
+class QTimer;
 class RecentFiles;
 class ScoreArea;
 class ScoreLocation;
@@ -116,8 +117,10 @@ private slots:
     /// Opens the file information dialog.
     void editFileInformation();
 
-    /// Starts or stops playback of the score.
-    void startStopPlayback(bool from_measure_start = false);
+    /// Starts or stops playback of the score. When looping, the bars
+    /// containing the selection are repeated until playback is stopped.
+    void startStopPlayback(bool from_measure_start = false,
+                           bool loop_selection = false);
 
     /// Redraws only the given system.
     void redrawSystem(int);
@@ -285,6 +288,9 @@ private:
     /// Build the instrument panel.
     void createInstrumentPanel();
 
+    /// Moves the caret to the latest playback location.
+    void updatePlaybackLocation();
+
     /// Load any custom keyboard shortcuts.
     void loadKeyboardShortcuts();
     /// Save any custom keyboard shortcuts.
@@ -394,6 +400,7 @@ private:
     std::unique_ptr<TuningDictionary> myTuningDictionary;
     PlayerEditPubSub myPlayerEditPubSub;
     PlayerRemovePubSub myPlayerRemovePubSub;
+    PlayerMuteSoloPubSub myPlayerMuteSoloPubSub;
     InstrumentEditPubSub myInstrumentEditPubSub;
     InstrumentRemovePubSub myInstrumentRemovePubSub;
     /// Tracks whether we are currently in playback mode.
@@ -410,6 +417,8 @@ private:
     QDockWidget *myInstrumentDockWidget;
     PlaybackWidget *myPlaybackWidget;
     QWidget *myPlaybackArea;
+    /// Polls the playback location once per display frame.
+    QTimer *myPlaybackTimer;
 
     QMenu *myFileMenu;
     Command *myNewDocumentCommand;
@@ -437,6 +446,7 @@ private:
     QMenu *myPlaybackMenu;
     Command *myPlayPauseCommand;
     Command *myPlayFromStartOfMeasureCommand;
+    Command *myLoopSelectionCommand;
     Command *myStopCommand;
     Command *myRewindCommand;
     Command *myMetronomeCommand;
@@ -33,4 +33,10 @@ class PlayerRemovePubSub : public PubSub<void (int)>
 {
 };
 
+/// Notifications about a player being muted or soloed. This only affects
+/// playback, and is not saved with the score.
+class PlayerMuteSoloPubSub : public PubSub<void (int, bool, bool)>
+{
+};
+
 #endif
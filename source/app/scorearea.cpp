@@ -21,14 +21,20 @@
 #include <app/pubsub/clickpubsub.h>
 #include <chrono>
 #include <future>
+#include <algorithm>
 #include <painters/caretpainter.h>
+#include <painters/layoutcache.h>
 #include <painters/scoreinforenderer.h>
+#include <painters/systemrastercache.h>
 #include <painters/systemrenderer.h>
 #include <QDebug>
 #include <QGraphicsItem>
 #include <QGraphicsSceneDragDropEvent>
+#include <QHelpEvent>
+#include <QMouseEvent>
 #include <QPrinter>
 #include <QScrollBar>
+#include <QToolTip>
 #include <score/score.h>
 
 static const double SYSTEM_SPACING = 50;
@@ -42,23 +48,48 @@ ScoreArea::ScoreArea(QWidget *parent)
     : QGraphicsView(parent),
       myScoreInfoBlock(nullptr),
       myCaretPainter(nullptr),
-      myClickPubSub(std::make_shared<ClickPubSub>())
+      myRasterCacheEnabled(false),
+      myDetailLevel(DetailLevel::Full),
+      myPressedSystem(-1),
+      mySelectionStart(0),
+      mySelectionString(0),
+      myClickPubSub(std::make_shared<ClickPubSub>()),
+      myLayoutCache(std::make_shared<LayoutCache>())
 {
     setScene(&myScene);
+    // Track the mouse to indicate which symbols can be clicked on.
+    viewport()->setMouseTracking(true);
+}
+
+void ScoreArea::setRasterCacheEnabled(bool enabled)
+{
+    myRasterCacheEnabled = enabled;
 }
 
 void ScoreArea::renderDocument(const Document &document)
 {
+    renderDocument(document,
+                   getDetailLevel(document.getViewOptions().getZoom() / 100.0));
+}
+
+void ScoreArea::renderDocument(const Document &document, DetailLevel level)
+{
+    myDetailLevel = level;
     myScene.clear();
     myRenderedSystems.clear();
+    myPressedRegion.reset();
+    myPressedStaff.reset();
+    if (!myDocument || &*myDocument != &document)
+        myLayoutCache->clear();
     myDocument = document;
 
     const Score &score = document.getScore();
+    myLayoutCache->update(score);
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    myCaretPainter =
-        new CaretPainter(document.getCaret(), document.getViewOptions());
+    myCaretPainter = new CaretPainter(document.getCaret(),
+                                      document.getViewOptions(), myLayoutCache);
     myCaretPainter->subscribeToMovement([=]() {
         adjustScroll();
     });
@@ -68,6 +99,7 @@ void ScoreArea::renderDocument(const Document &document)
     myRenderedSystems.reserve(score.getSystems().size());
     for (unsigned int i = 0; i < score.getSystems().size(); ++i)
         myRenderedSystems.append(nullptr);
+    myClickIndices.assign(score.getSystems().size(), ClickIndex());
 
 #if 0
     const int num_threads = std::thread::hardware_concurrency();
@@ -88,8 +120,10 @@ void ScoreArea::renderDocument(const Document &document)
         {
             for (int i = left; i < right; ++i)
             {
-                SystemRenderer render(this, score, document.getViewOptions());
+                SystemRenderer render(score, document.getViewOptions(),
+                                      myLayoutCache, level);
                 myRenderedSystems[i] = render(score.getSystems()[i], i);
+                myClickIndices[i] = render.getClickIndex();
             }
         }, left, right));
     }
@@ -106,6 +140,7 @@ void ScoreArea::renderDocument(const Document &document)
     for (QGraphicsItem *system : myRenderedSystems)
     {
         system->setPos(0, height);
+        cacheSystem(system);
         myScene.addItem(system);
         height += system->boundingRect().height() + SYSTEM_SPACING;
 
@@ -123,34 +158,52 @@ void ScoreArea::renderDocument(const Document &document)
 
 void ScoreArea::redrawSystem(int index)
 {
-    // Delete and remove the system from the scene.
-    delete myRenderedSystems.takeAt(index);
-
     const Score &score = myDocument->getScore();
-    SystemRenderer render(this, score, myDocument->getViewOptions());
-    QGraphicsItem *newSystem = render(score.getSystems()[index], index);
+    myLayoutCache->update(score);
+    SystemRenderer render(score, myDocument->getViewOptions(), myLayoutCache,
+                          myDetailLevel);
 
-    double height = 0;
-    if (index > 0)
+    QGraphicsItem *system = myRenderedSystems[index];
+    const double prevHeight = system->boundingRect().height();
+
+    // If possible, only redraw the staves that changed. Otherwise, delete and
+    // redraw the whole system.
+    if (!render.redrawStaves(system, myClickIndices[index],
+                             score.getSystems()[index], index))
     {
-        height = myRenderedSystems.at(index - 1)->sceneBoundingRect().bottom() +
+        delete system;
+        system = render(score.getSystems()[index], index);
+        myRenderedSystems[index] = system;
+
+        double y = 0;
+        if (index > 0)
+        {
+            y = myRenderedSystems.at(index - 1)->sceneBoundingRect().bottom() +
                 SYSTEM_SPACING;
+        }
+
+        system->setPos(0, y);
+        myScene.addItem(system);
     }
 
-    newSystem->setPos(0, height);
-    height += newSystem->boundingRect().height() + SYSTEM_SPACING;
-    myCaretPainter->setSystemRect(index, newSystem->sceneBoundingRect());
+    myClickIndices[index] = render.getClickIndex();
+    myCaretPainter->setSystemRect(index, system->sceneBoundingRect());
 
-    myScene.addItem(newSystem);
-    myRenderedSystems.insert(index, newSystem);
+    // Replacing the system (or some of its staves) also discards its cached
+    // image.
+    cacheSystem(system);
 
-    // Shift the following systems.
-    for (int i = index + 1; i < myRenderedSystems.size(); ++i)
+    // Shift the following systems, unless the height didn't change.
+    if (system->boundingRect().height() != prevHeight)
     {
-        QGraphicsItem *system = myRenderedSystems[i];
-        system->setPos(0, height);
-        height += system->boundingRect().height() + SYSTEM_SPACING;
-        myCaretPainter->setSystemRect(i, system->sceneBoundingRect());
+        double height = system->sceneBoundingRect().bottom() + SYSTEM_SPACING;
+        for (int i = index + 1; i < myRenderedSystems.size(); ++i)
+        {
+            QGraphicsItem *next = myRenderedSystems[i];
+            next->setPos(0, height);
+            height += next->boundingRect().height() + SYSTEM_SPACING;
+            myCaretPainter->setSystemRect(i, next->sceneBoundingRect());
+        }
     }
 
     // The spacing may have changed, so update the caret's position and redraw
@@ -160,6 +213,11 @@ void ScoreArea::redrawSystem(int index)
 
 void ScoreArea::print(QPrinter &printer)
 {
+    // Always print the full score, even if the view is zoomed out.
+    const DetailLevel viewLevel = myDetailLevel;
+    if (viewLevel != DetailLevel::Full)
+        renderDocument(*myDocument, DetailLevel::Full);
+
     QPainter painter;
     painter.begin(&printer);
 
@@ -208,6 +266,9 @@ void ScoreArea::print(QPrinter &printer)
 
     myCaretPainter->show();
     painter.end();
+
+    if (viewLevel != DetailLevel::Full)
+        renderDocument(*myDocument, viewLevel);
 }
 
 std::shared_ptr<ClickPubSub> ScoreArea::getClickPubSub() const
@@ -215,6 +276,11 @@ std::shared_ptr<ClickPubSub> ScoreArea::getClickPubSub() const
     return myClickPubSub;
 }
 
+std::shared_ptr<LayoutCache> ScoreArea::getLayoutCache() const
+{
+    return myLayoutCache;
+}
+
 void ScoreArea::adjustScroll()
 {
     if (myDocument->getCaret().isInPlaybackMode())
@@ -227,6 +293,155 @@ void ScoreArea::adjustScroll()
         ensureVisible(myCaretPainter->sceneBoundingRect(), 0, 0);
 }
 
+void ScoreArea::cacheSystem(QGraphicsItem *system)
+{
+    // Discard the image of a system that was partially redrawn.
+    bool wasCached = false;
+    for (QGraphicsItem *child : system->childItems())
+    {
+        if (dynamic_cast<CachedSystemItem *>(child))
+        {
+            delete child;
+            wasCached = true;
+        }
+    }
+
+    // If the setting was disabled since, the reused items need to paint
+    // themselves again.
+    if (myRasterCacheEnabled)
+        new CachedSystemItem(system, this);
+    else if (wasCached)
+        CachedSystemItem::enablePainting(system);
+}
+
+int ScoreArea::findSystem(const QPointF &pos) const
+{
+    // The systems are ordered from top to bottom.
+    auto it = std::upper_bound(
+        myRenderedSystems.begin(), myRenderedSystems.end(), pos.y(),
+        [](double y, const QGraphicsItem *system) { return y < system->y(); });
+
+    if (it == myRenderedSystems.begin())
+        return -1;
+
+    --it;
+    if (pos.y() > (*it)->y() + (*it)->boundingRect().height())
+        return -1;
+
+    return static_cast<int>(it - myRenderedSystems.begin());
+}
+
+const ClickIndex::Region *ScoreArea::findRegion(const QPointF &pos) const
+{
+    const int system = findSystem(pos);
+    if (system < 0)
+        return nullptr;
+
+    return myClickIndices[system].findRegion(
+        pos - myRenderedSystems[system]->pos());
+}
+
+void ScoreArea::publishSelection(int position)
+{
+    ScoreLocation location(myDocument->getScore(), myPressedSystem,
+                           myPressedStaff->myStaff);
+    location.setSelectionStart(mySelectionStart);
+    location.setPositionIndex(position);
+    location.setString(mySelectionString);
+
+    myClickPubSub->publish(ClickType::Selection, location);
+}
+
+void ScoreArea::mousePressEvent(QMouseEvent *event)
+{
+    myPressedRegion.reset();
+    myPressedStaff.reset();
+
+    const QPointF scenePos = mapToScene(event->pos());
+    myPressedSystem = findSystem(scenePos);
+    if (myPressedSystem < 0)
+        return;
+
+    const ClickIndex &index = myClickIndices[myPressedSystem];
+    const QPointF pos = scenePos - myRenderedSystems[myPressedSystem]->pos();
+
+    // Symbols are clicked when the mouse is released.
+    if (const ClickIndex::Region *region = index.findRegion(pos))
+    {
+        myPressedRegion = *region;
+        return;
+    }
+
+    // Only use the left mouse button for making selections.
+    const ClickIndex::StaffRegion *staff = index.findStaff(pos);
+    if (!staff || event->button() != Qt::LeftButton)
+        return;
+
+    const int string = staff->getString(pos.y());
+    if (string < 0)
+        return;
+
+    myPressedStaff = *staff;
+    mySelectionStart = staff->getPosition(pos.x());
+    mySelectionString = string;
+    publishSelection(mySelectionStart);
+}
+
+void ScoreArea::mouseMoveEvent(QMouseEvent *event)
+{
+    const QPointF scenePos = mapToScene(event->pos());
+
+    // Extend the selection while dragging.
+    if (myPressedStaff && (event->buttons() & Qt::LeftButton))
+    {
+        const QPointF pos =
+            scenePos - myRenderedSystems[myPressedSystem]->pos();
+        publishSelection(myPressedStaff->getPosition(pos.x()));
+        return;
+    }
+
+    if (findRegion(scenePos))
+        viewport()->setCursor(Qt::PointingHandCursor);
+    else
+        viewport()->unsetCursor();
+}
+
+void ScoreArea::mouseReleaseEvent(QMouseEvent *)
+{
+    myPressedStaff.reset();
+    if (!myPressedRegion)
+        return;
+
+    // Clicking on a symbol may e.g. open a dialog and redraw the score, so
+    // reset the state before publishing.
+    const ClickIndex::Region region = *myPressedRegion;
+    myPressedRegion.reset();
+
+    const ScoreLocation location(myDocument->getScore(), myPressedSystem,
+                                 region.myStaff, region.myPosition);
+    myClickPubSub->publish(region.myType, location);
+}
+
+bool ScoreArea::viewportEvent(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip)
+    {
+        auto helpEvent = static_cast<QHelpEvent *>(event);
+        const ClickIndex::Region *region =
+            findRegion(mapToScene(helpEvent->pos()));
+
+        if (region && !region->myToolTip.isEmpty())
+        {
+            QToolTip::showText(helpEvent->globalPos(), region->myToolTip,
+                               viewport());
+            return true;
+        }
+    }
+
+    // Otherwise, show the tooltips of any items in the scene.
+    return QGraphicsView::viewportEvent(event);
+}
+
 void ScoreArea::focusInEvent(QFocusEvent *)
 {
     myScene.update(myCaretPainter->sceneBoundingRect());
@@ -245,4 +460,12 @@ void ScoreArea::refreshZoom()
     QTransform xform;
     xform.scale(scale_factor, scale_factor);
     setTransform(xform);
+
+    // The cached images need to be redrawn at the new scale.
+    SystemRasterCache::getInstance().removeGroup(this);
+
+    // Switch to a simpler drawing of the score when zoomed out far enough.
+    const DetailLevel level = getDetailLevel(scale_factor);
+    if (level != myDetailLevel)
+        renderDocument(*myDocument, level);
 }
@@ -20,13 +20,17 @@
 
 #include <boost/optional.hpp>
 #include <memory>
+#include <painters/clickindex.h>
+#include <painters/detaillevel.h>
 #include <QGraphicsScene>
 #include <QGraphicsView>
 #include <score/staff.h>
+#include <vector>
 
 class CaretPainter;
 class ClickPubSub;
 class Document;
+class LayoutCache;
 class QPrinter;
 
 /// The visual display of the score.
@@ -46,31 +50,66 @@ public:
 
     void renderDocument(const Document &document);
 
+    /// Enables drawing the systems from cached images, which makes scrolling
+    /// cheaper for large scores. This applies to the next render.
+    void setRasterCacheEnabled(bool enabled);
+
     void refreshZoom();
 
     void print(QPrinter &printer);
 
     /// Redraws the specified system, and shifts the following systems as
-    /// necessary.
+    /// necessary. When possible, only the modified staves are redrawn.
     void redrawSystem(int index);
 
     std::shared_ptr<ClickPubSub> getClickPubSub() const;
+    std::shared_ptr<LayoutCache> getLayoutCache() const;
 
 protected:
     virtual void focusInEvent(QFocusEvent *event) override;
     virtual void focusOutEvent(QFocusEvent *event) override;
+    virtual void mousePressEvent(QMouseEvent *event) override;
+    virtual void mouseMoveEvent(QMouseEvent *event) override;
+    virtual void mouseReleaseEvent(QMouseEvent *event) override;
+    /// Shows the tooltips of the clickable symbols.
+    virtual bool viewportEvent(QEvent *event) override;
 
 private:
+    /// Renders the document at the given level of detail.
+    void renderDocument(const Document &document, DetailLevel level);
     /// Adjusts the scroll location whenever the caret moves.
     void adjustScroll();
+    /// Draws the system from a cached image, if enabled.
+    void cacheSystem(QGraphicsItem *system);
+    /// Returns the index of the system at the given scene position, or -1.
+    int findSystem(const QPointF &pos) const;
+    /// Returns the clickable symbol at the given scene position, if any.
+    const ClickIndex::Region *findRegion(const QPointF &pos) const;
+    /// Publishes a selection from the start of the drag to the given position.
+    void publishSelection(int position);
 
     Scene myScene;
     boost::optional<const Document &> myDocument;
     QGraphicsItem *myScoreInfoBlock;
     QList<QGraphicsItem *> myRenderedSystems;
     CaretPainter *myCaretPainter;
+    bool myRasterCacheEnabled;
+    DetailLevel myDetailLevel;
+    /// The clickable regions of each rendered system.
+    std::vector<ClickIndex> myClickIndices;
+
+    /// The system that the mouse was pressed in.
+    int myPressedSystem;
+    /// The symbol that the mouse was pressed on, which is clicked when the
+    /// mouse is released.
+    boost::optional<ClickIndex::Region> myPressedRegion;
+    /// The staff where a selection is being dragged out.
+    boost::optional<ClickIndex::StaffRegion> myPressedStaff;
+    int mySelectionStart;
+    int mySelectionString;
 
     std::shared_ptr<ClickPubSub> myClickPubSub;
+    std::shared_ptr<LayoutCache> myLayoutCache;
 };
 
 #endif
@@ -0,0 +1,376 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scoreexporter.h"
+
+#include <algorithm>
+#include <app/viewoptions.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <memory>
+#include <painters/itempainter.h>
+#include <painters/layoutcache.h>
+#include <painters/scoreinforenderer.h>
+#include <painters/systemrenderer.h>
+#include <QDir>
+#include <QFileInfo>
+#include <QGraphicsItem>
+#include <QImage>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSvgGenerator>
+#include <score/score.h>
+#include <stdexcept>
+#include <thread>
+#include <util/parallelfor.h>
+
+/// Spacing between systems, in the same units as the score area.
+static const double SYSTEM_SPACING = 50;
+
+/// Number of scores to render at once for each thread. This limits the
+/// memory that is used when exporting a large number of scores.
+static const int SCORES_PER_THREAD = 4;
+
+namespace
+{
+/// An item that is drawn on a page.
+struct PageItem
+{
+    QGraphicsItem *myItem;
+    /// The area of the item to draw, in item coordinates.
+    QRectF mySource;
+    /// The position of the item, relative to the page's margins.
+    QPointF myPosition;
+    double myScale;
+};
+
+typedef std::vector<PageItem> Page;
+
+/// The rendered items and pages for a score.
+struct RenderedScore
+{
+    RenderedScore() : myJob(nullptr), myScore(nullptr)
+    {
+    }
+
+    const ScoreExporter::Job *myJob;
+    /// The score, which is owned by the job or was loaded for this batch.
+    const Score *myScore;
+    Score myLoadedScore;
+    std::shared_ptr<LayoutCache> myLayoutCache;
+    /// The score information, followed by each system.
+    std::vector<std::unique_ptr<QGraphicsItem>> myItems;
+    std::vector<Page> myPages;
+};
+
+/// Splits the score's items into pages, scaling the systems to fit the width
+/// of the page.
+void paginate(RenderedScore &score, const QSizeF &area)
+{
+    std::vector<QRectF> sources;
+    double left = 0;
+    double right = 0;
+    for (const std::unique_ptr<QGraphicsItem> &item : score.myItems)
+    {
+        // Include children outside the item's bounds, such as bar numbers.
+        const QRectF source =
+            item->boundingRect() | item->childrenBoundingRect();
+        left = sources.empty() ? source.left()
+                               : std::min(left, source.left());
+        right = sources.empty() ? source.right()
+                                : std::max(right, source.right());
+        sources.push_back(source);
+    }
+
+    const double scale = area.width() / std::max(1.0, right - left);
+    Page page;
+    double y = 0;
+
+    for (size_t i = 0; i < score.myItems.size(); ++i)
+    {
+        const QRectF &source = sources[i];
+        const double height = source.height() * scale;
+        if (!page.empty() && y + height > area.height())
+        {
+            score.myPages.push_back(page);
+            page.clear();
+            y = 0;
+        }
+
+        PageItem pageItem;
+        pageItem.myItem = score.myItems[i].get();
+        pageItem.mySource = source;
+        pageItem.myPosition = QPointF((source.left() - left) * scale, y);
+        pageItem.myScale = scale;
+        page.push_back(pageItem);
+
+        // Use half of the spacing after the score information.
+        y += height + (i == 0 ? 0.5 : 1.0) * SYSTEM_SPACING * scale;
+    }
+
+    if (!page.empty())
+        score.myPages.push_back(page);
+}
+
+void drawPage(QPainter &painter, const Page &page)
+{
+    for (const PageItem &item : page)
+    {
+        painter.save();
+        painter.translate(item.myPosition);
+        painter.scale(item.myScale, item.myScale);
+        painter.translate(-item.mySource.topLeft());
+        painter.setClipRect(item.mySource);
+        ItemPainter::paintTree(&painter, item.myItem);
+        painter.restore();
+    }
+}
+
+std::string getPageFilename(const std::string &filename, int page)
+{
+    const QFileInfo info(QString::fromStdString(filename));
+    const QString name = QString("%1-%2.%3")
+                             .arg(info.completeBaseName())
+                             .arg(page + 1)
+                             .arg(info.suffix());
+    return QDir(info.path()).filePath(name).toStdString();
+}
+
+void writePdf(const RenderedScore &score, const QPageLayout &layout,
+              int resolution)
+{
+    const std::string &filename = score.myJob->myFilename;
+    QPdfWriter writer(QString::fromStdString(filename));
+    writer.setPageLayout(layout);
+    writer.setResolution(resolution);
+
+    // The painter's origin is at the page's margins.
+    QPainter painter;
+    if (!painter.begin(&writer))
+        throw std::runtime_error("Unable to write " + filename);
+
+    for (size_t i = 0; i < score.myPages.size(); ++i)
+    {
+        if (i > 0)
+            writer.newPage();
+
+        drawPage(painter, score.myPages[i]);
+    }
+
+    painter.end();
+}
+
+void writeSvg(const Page &page, const std::string &filename,
+              const QPageLayout &layout, int resolution)
+{
+    const QRect pageRect = layout.fullRectPixels(resolution);
+
+    QSvgGenerator generator;
+    generator.setFileName(QString::fromStdString(filename));
+    generator.setSize(pageRect.size());
+    generator.setViewBox(pageRect);
+    generator.setResolution(resolution);
+
+    QPainter painter;
+    if (!painter.begin(&generator))
+        throw std::runtime_error("Unable to write " + filename);
+
+    painter.translate(layout.paintRectPixels(resolution).topLeft());
+    drawPage(painter, page);
+    painter.end();
+}
+
+void writePng(const Page &page, const std::string &filename,
+              const QPageLayout &layout, int resolution)
+{
+    const QRect pageRect = layout.fullRectPixels(resolution);
+    const int dotsPerMeter = qRound(resolution / 0.0254);
+
+    QImage image(pageRect.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    image.setDotsPerMeterX(dotsPerMeter);
+    image.setDotsPerMeterY(dotsPerMeter);
+
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing |
+                           QPainter::TextAntialiasing);
+    painter.translate(layout.paintRectPixels(resolution).topLeft());
+    drawPage(painter, page);
+    painter.end();
+
+    if (!image.save(QString::fromStdString(filename), "PNG"))
+        throw std::runtime_error("Unable to write " + filename);
+}
+}
+
+ScoreExporter::ScoreExporter(Format format, int threadCount)
+    : myFormat(format),
+      myThreadCount(threadCount),
+      myResolution(300),
+      myPageLayout(QPageSize(QPageSize::Letter), QPageLayout::Portrait,
+                   QMarginsF(0.5, 0.5, 0.5, 0.5), QPageLayout::Inch)
+{
+    if (myThreadCount <= 0)
+    {
+        myThreadCount =
+            std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+}
+
+boost::optional<ScoreExporter::Format> ScoreExporter::findFormat(
+    const std::string &name)
+{
+    const std::string lowerName = boost::algorithm::to_lower_copy(name);
+    if (lowerName == "pdf")
+        return Format::Pdf;
+    else if (lowerName == "svg")
+        return Format::Svg;
+    else if (lowerName == "png")
+        return Format::Png;
+    else
+        return boost::none;
+}
+
+std::string ScoreExporter::getExtension(Format format)
+{
+    switch (format)
+    {
+        case Format::Pdf:
+            return "pdf";
+        case Format::Svg:
+            return "svg";
+        case Format::Png:
+            return "png";
+    }
+
+    return "";
+}
+
+void ScoreExporter::setResolution(int dpi)
+{
+    myResolution = dpi;
+}
+
+void ScoreExporter::setPageLayout(const QPageLayout &layout)
+{
+    myPageLayout = layout;
+}
+
+std::vector<std::string> ScoreExporter::exportScore(
+    const Score &score, const std::string &filename) const
+{
+    return exportScores({ Job(score, filename) });
+}
+
+std::vector<std::string> ScoreExporter::exportScores(
+    const std::vector<Job> &jobs) const
+{
+    std::vector<std::string> files;
+    const ViewOptions viewOptions;
+    const QRect paintRect = myPageLayout.paintRectPixels(myResolution);
+    const size_t batchSize = myThreadCount * SCORES_PER_THREAD;
+
+    for (size_t start = 0; start < jobs.size(); start += batchSize)
+    {
+        const size_t count = std::min(batchSize, jobs.size() - start);
+        std::vector<RenderedScore> scores(count);
+
+        // Render the systems from all of the scores in parallel.
+        std::vector<std::pair<int, int>> items;
+        for (size_t i = 0; i < count; ++i)
+        {
+            RenderedScore &rendered = scores[i];
+            rendered.myJob = &jobs[start + i];
+            if (rendered.myJob->myScore)
+                rendered.myScore = rendered.myJob->myScore;
+            else
+            {
+                rendered.myJob->myLoader(rendered.myLoadedScore);
+                rendered.myScore = &rendered.myLoadedScore;
+            }
+            const Score &score = *rendered.myScore;
+
+            rendered.myLayoutCache = std::make_shared<LayoutCache>();
+            rendered.myLayoutCache->update(score);
+            rendered.myItems.resize(score.getSystems().size() + 1);
+
+            for (size_t j = 0; j < rendered.myItems.size(); ++j)
+                items.emplace_back(static_cast<int>(i), static_cast<int>(j));
+        }
+
+        parallelFor(static_cast<int>(items.size()), [&](int index) {
+            RenderedScore &rendered = scores[items[index].first];
+            const Score &score = *rendered.myScore;
+            const int item = items[index].second;
+
+            if (item == 0)
+            {
+                rendered.myItems[item].reset(
+                    ScoreInfoRenderer::render(score.getScoreInfo()));
+            }
+            else
+            {
+                SystemRenderer render(score, viewOptions,
+                                      rendered.myLayoutCache);
+                rendered.myItems[item].reset(
+                    render(score.getSystems()[item - 1], item - 1));
+            }
+        }, myThreadCount);
+
+        for (RenderedScore &rendered : scores)
+            paginate(rendered, paintRect.size());
+
+        if (myFormat == Format::Pdf)
+        {
+            parallelFor(static_cast<int>(count), [&](int index) {
+                writePdf(scores[index], myPageLayout, myResolution);
+            }, myThreadCount);
+
+            for (const RenderedScore &rendered : scores)
+                files.push_back(rendered.myJob->myFilename);
+        }
+        else
+        {
+            // Each page is written to a separate file.
+            std::vector<std::pair<const Page *, std::string>> pages;
+            for (const RenderedScore &rendered : scores)
+            {
+                for (size_t i = 0; i < rendered.myPages.size(); ++i)
+                {
+                    pages.emplace_back(
+                        &rendered.myPages[i],
+                        getPageFilename(rendered.myJob->myFilename,
+                                        static_cast<int>(i)));
+                }
+            }
+
+            parallelFor(static_cast<int>(pages.size()), [&](int index) {
+                const Page &page = *pages[index].first;
+                const std::string &filename = pages[index].second;
+
+                if (myFormat == Format::Svg)
+                    writeSvg(page, filename, myPageLayout, myResolution);
+                else
+                    writePng(page, filename, myPageLayout, myResolution);
+            }, myThreadCount);
+
+            for (const auto &page : pages)
+                files.push_back(page.second);
+        }
+    }
+
+    return files;
+}
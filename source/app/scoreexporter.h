@@ -0,0 +1,101 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef APP_SCOREEXPORTER_H
+#define APP_SCOREEXPORTER_H
+
+#include <boost/optional/optional.hpp>
+#include <functional>
+#include <QPageLayout>
+#include <string>
+#include <vector>
+
+class Score;
+
+/// Renders scores to PDF, SVG, or PNG files without a score area or window,
+/// so that scores can be exported from the command line. The systems and
+/// pages are rendered on multiple threads.
+class ScoreExporter
+{
+public:
+    enum class Format
+    {
+        Pdf,
+        Svg,
+        Png
+    };
+
+    /// Loads a score (e.g. by importing a file).
+    typedef std::function<void(Score &)> Loader;
+
+    /// A score to export, and the file to export it to.
+    struct Job
+    {
+        Job(const Score &score, const std::string &filename)
+            : myScore(&score), myFilename(filename)
+        {
+        }
+
+        /// The score is loaded when its batch is exported, rather than
+        /// keeping every score in memory.
+        Job(const Loader &loader, const std::string &filename)
+            : myScore(nullptr), myLoader(loader), myFilename(filename)
+        {
+        }
+
+        const Score *myScore;
+        Loader myLoader;
+        std::string myFilename;
+    };
+
+    /// Uses one thread per core if the thread count is zero.
+    explicit ScoreExporter(Format format, int threadCount = 0);
+
+    /// Returns the format with the given name or file extension (e.g. "pdf").
+    static boost::optional<Format> findFormat(const std::string &name);
+    /// Returns the file extension for the format.
+    static std::string getExtension(Format format);
+
+    /// Sets the resolution of the pages, in dots per inch.
+    void setResolution(int dpi);
+    int getResolution() const { return myResolution; }
+
+    /// Sets the page size and margins.
+    void setPageLayout(const QPageLayout &layout);
+    const QPageLayout &getPageLayout() const { return myPageLayout; }
+
+    /// Exports a single score. See exportScores().
+    std::vector<std::string> exportScore(const Score &score,
+                                         const std::string &filename) const;
+
+    /// Exports each score to its file. SVG and PNG files contain a single
+    /// page, so the page number is appended to the filename.
+    /// Batches of scores are loaded and rendered together to keep the threads
+    /// busy, e.g. when exporting a songbook.
+    /// Returns the names of the files that were written.
+    /// @throw std::runtime_error if a file could not be written. Any errors
+    /// from loading a score are also propagated.
+    std::vector<std::string> exportScores(const std::vector<Job> &jobs) const;
+
+private:
+    Format myFormat;
+    int myThreadCount;
+    int myResolution;
+    QPageLayout myPageLayout;
+};
+
+#endif
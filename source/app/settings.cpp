@@ -33,6 +33,12 @@ const Setting<std::vector<std::string>> RecentFiles("app/recent_files", {});
 const Setting<bool> OpenFilesInNewWindow("app/open_files_in_new_window",
                                          false);
 
+const Setting<bool> SystemRasterCache("app/system_raster_cache", false);
+
+/// Memory budget (in MB) for the images of the rendered systems.
+const Setting<int> SystemRasterCacheBudget("app/system_raster_cache_budget",
+                                           256);
+
 const Setting<std::string> DefaultInstrumentName("app/default_instrument_name",
                                                  "Untitled");
 
@@ -30,6 +30,8 @@ namespace Settings
     extern const Setting<QByteArray> WindowState;
     extern const Setting<std::vector<std::string>> RecentFiles;
     extern const Setting<bool> OpenFilesInNewWindow;
+    extern const Setting<bool> SystemRasterCache;
+    extern const Setting<int> SystemRasterCacheBudget;
 
     extern const Setting<std::string> DefaultInstrumentName;
     extern const Setting<int> DefaultInstrumentPreset;
@@ -0,0 +1,79 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "alsavirtualportbackend.h"
+
+#include <RtMidi.h>
+
+AlsaVirtualPortBackend::AlsaVirtualPortBackend()
+{
+}
+
+AlsaVirtualPortBackend::~AlsaVirtualPortBackend()
+{
+}
+
+bool AlsaVirtualPortBackend::isAvailable()
+{
+#ifdef __LINUX_ALSA__
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool AlsaVirtualPortBackend::initialize(const std::string &portName)
+{
+#ifdef __LINUX_ALSA__
+    try
+    {
+        myMidiOut.reset(new RtMidiOut(RtMidi::LINUX_ALSA, "Power Tab Editor"));
+        myMidiOut->openVirtualPort(portName);
+    }
+    catch (...)
+    {
+        // The ALSA sequencer might not be running (e.g. on a headless
+        // machine).
+        myMidiOut.reset();
+        return false;
+    }
+
+    return true;
+#else
+    (void)portName;
+    return false;
+#endif
+}
+
+bool AlsaVirtualPortBackend::sendMessage(const uint8_t *data, size_t size)
+{
+    if (!myMidiOut)
+        return false;
+
+    myMessage.assign(data, data + size);
+
+    try
+    {
+        myMidiOut->sendMessage(&myMessage);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
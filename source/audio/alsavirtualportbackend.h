@@ -0,0 +1,51 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_ALSAVIRTUALPORTBACKEND_H
+#define AUDIO_ALSAVIRTUALPORTBACKEND_H
+
+#include <audio/midioutputbackend.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class RtMidiOut;
+
+/// Publishes a virtual ALSA sequencer port, which other applications (e.g. a
+/// software synthesizer or aseqdump) can subscribe to. This is only available
+/// on Linux.
+class AlsaVirtualPortBackend : public MidiOutputBackend
+{
+public:
+    AlsaVirtualPortBackend();
+    ~AlsaVirtualPortBackend();
+
+    /// Returns whether ALSA support is available on this platform.
+    static bool isAvailable();
+
+    /// Creates the port. Returns false if the ALSA sequencer is unavailable.
+    bool initialize(const std::string &portName);
+
+    virtual bool sendMessage(const uint8_t *data, size_t size) override;
+
+private:
+    std::unique_ptr<RtMidiOut> myMidiOut;
+    /// Reused buffer for the messages passed to RtMidi.
+    std::vector<uint8_t> myMessage;
+};
+
+#endif
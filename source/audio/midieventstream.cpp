@@ -0,0 +1,154 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "midieventstream.h"
+
+#include <algorithm>
+
+MidiEventStream::MidiEventStream(const Score &score,
+                                 const MidiFile::LoadOptions &options,
+                                 int lookahead_bars)
+    : myScore(score),
+      myGenerator(myScore, options),
+      myMaxBlocks(std::max(lookahead_bars, 1)),
+      myFinished(false),
+      myStopped(false)
+{
+    myThread = std::thread(&MidiEventStream::run, this);
+}
+
+MidiEventStream::~MidiEventStream()
+{
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myStopped = true;
+    }
+
+    myBlockRemoved.notify_all();
+    myThread.join();
+}
+
+bool MidiEventStream::readEvents(MidiEventList &events)
+{
+    std::unique_lock<std::mutex> lock(myMutex);
+    myBlockAdded.wait(lock, [&]() { return !myBlocks.empty() || myFinished; });
+
+    if (myBlocks.empty())
+    {
+        if (myError)
+            std::rethrow_exception(myError);
+
+        return false;
+    }
+
+    events = std::move(myBlocks.front());
+    myBlocks.pop_front();
+
+    lock.unlock();
+    myBlockRemoved.notify_one();
+    return true;
+}
+
+bool MidiEventStream::push(MidiEventList &&events)
+{
+    std::unique_lock<std::mutex> lock(myMutex);
+    myBlockRemoved.wait(
+        lock, [&]() { return myBlocks.size() < myMaxBlocks || myStopped; });
+
+    if (myStopped)
+        return false;
+
+    myBlocks.push_back(std::move(events));
+
+    lock.unlock();
+    myBlockAdded.notify_one();
+    return true;
+}
+
+void MidiEventStream::run()
+{
+    try
+    {
+        MidiEventList master_track;
+        std::vector<MidiEventList> player_tracks(myScore.getPlayers().size());
+        MidiEventList metronome_track;
+
+        // The events of a bar can start slightly before the bar (e.g. grace
+        // notes), so the events are held back until the next bar has been
+        // generated.
+        MidiEventList pending;
+        bool finished = false;
+
+        while (!finished)
+        {
+            const int bar_start = myGenerator.getCurrentTick();
+            finished = !myGenerator.generateNextBar(
+                master_track, player_tracks, metronome_track);
+
+            // Merge the tracks, keeping the same order as the tracks in a
+            // MIDI file for simultaneous events.
+            MidiEventList bar;
+            master_track.sort();
+            bar.merge(master_track);
+            for (MidiEventList &track : player_tracks)
+            {
+                track.sort();
+                bar.merge(track);
+                track.clear();
+            }
+            metronome_track.sort();
+            bar.merge(metronome_track);
+            master_track.clear();
+            metronome_track.clear();
+
+            pending.merge(bar);
+
+            auto end = pending.end();
+            if (!finished)
+            {
+                end = std::lower_bound(pending.begin(), pending.end(),
+                                       bar_start,
+                                       [](const MidiEvent &event, int tick) {
+                                           return event.getTicks() < tick;
+                                       });
+            }
+
+            if (end == pending.begin())
+                continue;
+
+            MidiEventList events;
+            for (auto it = pending.begin(); it != end; ++it)
+                events.append(std::move(*it));
+            pending.erase(pending.begin(), end);
+
+            if (!push(std::move(events)))
+                return;
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myError = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myFinished = true;
+    }
+
+    myBlockAdded.notify_all();
+}
@@ -0,0 +1,72 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_MIDIEVENTSTREAM_H
+#define AUDIO_MIDIEVENTSTREAM_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <midi/midieventlist.h>
+#include <midi/midifile.h>
+#include <mutex>
+#include <score/score.h>
+#include <thread>
+
+/// Generates the MIDI events for playback on a background thread, a few bars
+/// ahead of the player. The events for each bar are merged from all of the
+/// tracks and handed over through a bounded queue, so playback can start as
+/// soon as the first bar is ready and the memory use doesn't depend on the
+/// length of the score.
+class MidiEventStream
+{
+public:
+    MidiEventStream(const Score &score, const MidiFile::LoadOptions &options,
+                    int lookahead_bars);
+    /// Stops generating events, and waits for the background thread.
+    ~MidiEventStream();
+
+    int getTicksPerBeat() const { return myGenerator.getTicksPerBeat(); }
+
+    /// Waits for the next block of events, which are sorted and use absolute
+    /// ticks. Returns false once all of the events have been read.
+    bool readEvents(MidiEventList &events);
+
+private:
+    void run();
+    /// Waits until there is room in the queue, and then adds the events.
+    /// Returns false if the stream is being destroyed.
+    bool push(MidiEventList &&events);
+
+    /// A snapshot of the score, which can be safely read from the background
+    /// thread.
+    const Score myScore;
+    MidiEventGenerator myGenerator;
+    const size_t myMaxBlocks;
+
+    std::mutex myMutex;
+    std::condition_variable myBlockAdded;
+    std::condition_variable myBlockRemoved;
+    std::deque<MidiEventList> myBlocks;
+    bool myFinished;
+    bool myStopped;
+    std::exception_ptr myError;
+
+    std::thread myThread;
+};
+
+#endif
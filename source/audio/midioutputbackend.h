@@ -0,0 +1,38 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_MIDIOUTPUTBACKEND_H
+#define AUDIO_MIDIOUTPUTBACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// Delivers MIDI messages, e.g. to a system MIDI port or to an in-memory
+/// recording.
+class MidiOutputBackend
+{
+public:
+    virtual ~MidiOutputBackend()
+    {
+    }
+
+    /// Sends a complete MIDI message. Returns false if the message could not
+    /// be delivered.
+    virtual bool sendMessage(const uint8_t *data, size_t size) = 0;
+};
+
+#endif
@@ -17,114 +17,38 @@
   
 #include "midioutputdevice.h"
 
-#include <RtMidi.h>
+#include <audio/midioutputbackend.h>
 #include <score/dynamic.h>
 #include <score/generalmidi.h>
 #include <cassert>
 
-MidiOutputDevice::MidiOutputDevice() : myMidiOut(nullptr)
+MidiOutputDevice::MidiOutputDevice(MidiOutputBackend &backend)
+    : myBackend(backend)
 {
     myMaxVolumes.fill(Midi::MAX_MIDI_CHANNEL_VOLUME);
     myActiveVolumes.fill(Dynamic::fff);
-
-    // Create all MIDI APIs supported on this platform.
-    std::vector<RtMidi::Api> apis;
-    RtMidi::getCompiledApi(apis);
-
-    for (const RtMidi::Api &api : apis)
-    {
-        try
-        {
-            myMidiOuts.emplace_back(new RtMidiOut(api));
-        }
-        catch (...)
-        {
-            // continue anyway, another api might work
-            // found on mac that the Core API kept failing after repeated 
-            // creations and the exceptions weren't caught
-            // TODO investigate why.
-        }
-    }
 }
 
-MidiOutputDevice::~MidiOutputDevice()
+bool MidiOutputDevice::sendMessage(const uint8_t *data, size_t size)
 {
-}
-
-void
-MidiOutputDevice::sendMessage(const std::vector<uint8_t> &data)
-{
-    // FIXME - fix const correctness in RtMidi api.
-    myMidiOut->sendMessage(const_cast<std::vector<uint8_t> *>(&data));
+    return myBackend.sendMessage(data, size);
 }
 
 bool MidiOutputDevice::sendMidiMessage(unsigned char a, unsigned char b,
                                        unsigned char c)
 {
-    std::vector<uint8_t> message;
+    uint8_t message[3];
+    size_t size = 0;
 
-    message.push_back(a);
+    message[size++] = a;
 
     if (b <= 127)
-        message.push_back(b);
+        message[size++] = b;
 
     if (c <= 127)
-        message.push_back(c);
-
-    try
-    {
-        myMidiOut->sendMessage(&message);
-    }
-    catch (...)
-    {
-         return false;
-    }
-
-    return true;
-}
-
-bool MidiOutputDevice::initialize(size_t preferredApi,
-                                  unsigned int preferredPort)
-{
-    if (myMidiOut)
-        myMidiOut->closePort(); // Close any open ports.
-
-    if (preferredApi >= myMidiOuts.size())
-        return false;
-
-    myMidiOut = myMidiOuts[preferredApi].get();
-    unsigned int num_ports = myMidiOut->getPortCount();
+        message[size++] = c;
 
-    if (num_ports == 0)
-        return false;
-
-    try
-    {
-        myMidiOut->openPort(preferredPort);
-    }
-    catch (...)
-    {
-         return false;
-    }
-
-    return true;
-}
-
-size_t MidiOutputDevice::getApiCount()
-{
-    return myMidiOuts.size();
-}
-
-unsigned int MidiOutputDevice::getPortCount(size_t api)
-{
-    assert(api < myMidiOuts.size() && "Programming error, api doesn't exist");
-    return myMidiOuts[api]->getPortCount();
-}
-
-std::string MidiOutputDevice::getPortName(size_t api, unsigned int port)
-{
-    assert(api < myMidiOuts.size() && "Programming error, api doesn't exist");
-    return myMidiOuts[api]->getPortName(port);
+    return myBackend.sendMessage(message, size);
 }
 
 bool MidiOutputDevice::setPatch(int channel, uint8_t patch)
@@ -206,6 +130,11 @@ bool MidiOutputDevice::stopNote(int channel, uint8_t pitch)
     return sendMidiMessage(NoteOff + channel, pitch, 127);
 }
 
+bool MidiOutputDevice::stopAllNotes(int channel)
+{
+    return sendMidiMessage(ControlChange + channel, AllNotesOff, 0);
+}
+
 bool MidiOutputDevice::setVibrato(int channel, uint8_t modulation)
 {
     if (modulation > 127)
@@ -26,24 +26,19 @@
 **/
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
-#include <memory>
-#include <vector>
 
-class RtMidiOut;
+class MidiOutputBackend;
 
 class MidiOutputDevice
 {
 public:
     static const int NUM_CHANNELS = 16;
 
-    MidiOutputDevice();
-    ~MidiOutputDevice();
-
-    bool initialize(size_t preferredApi, unsigned int preferredPort);
-    size_t getApiCount();
-    unsigned int getPortCount(size_t api);
-    std::string getPortName(size_t api, unsigned int port);
+    /// Sends messages through the given backend, which must outlive the
+    /// device.
+    explicit MidiOutputDevice(MidiOutputBackend &backend);
 
     /// Sets the pitch bend range to the given number of semitones.
     void setPitchBendRange(int channel, uint8_t semiTones);
@@ -53,6 +48,8 @@ public:
     bool setPitchBend(int channel, uint8_t bend);
     bool playNote(int channel, uint8_t pitch, uint8_t velocity);
     bool stopNote(int channel, uint8_t pitch);
+    /// Stops any notes that are playing on the channel.
+    bool stopAllNotes(int channel);
     bool setVibrato(int channel, uint8_t modulation);
     /// Turns sustain on or off for the specified channel.
     bool setSustain(int channel, bool sustainOn);
@@ -79,16 +76,16 @@ public:
         DataEntryFine = 38,
         HoldPedal = 64,
         RpnLsb = 100,
-        RpnMsb = 101
+        RpnMsb = 101,
+        AllNotesOff = 123
     };
 
-    void sendMessage(const std::vector<uint8_t> &data);
+    bool sendMessage(const uint8_t *data, size_t size);
 
 private:
     bool sendMidiMessage(unsigned char a, unsigned char b, unsigned char c);
 
-    std::vector<std::unique_ptr<RtMidiOut>> myMidiOuts;
-    RtMidiOut *myMidiOut;
+    MidiOutputBackend &myBackend;
     /// Maximum volume for each channel (as set in the mixer).
     std::array<uint8_t, NUM_CHANNELS> myMaxVolumes;
     /// Volume of last active dynamic for each channel.
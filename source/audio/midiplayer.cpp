@@ -17,14 +17,20 @@
   
 #include "midiplayer.h"
 
+#include <algorithm>
 #include <app/settingsmanager.h>
+#include <audio/alsavirtualportbackend.h>
+#include <audio/midieventstream.h>
 #include <audio/midioutputdevice.h>
+#include <audio/rtmidibackend.h>
 #include <audio/settings.h>
-#include <boost/rational.hpp>
-#include <cassert>
+#include <bitset>
+#include <chrono>
+#include <map>
 #include <midi/midifile.h>
 #include <score/generalmidi.h>
 #include <score/score.h>
+#include <thread>
 
 #ifdef _WIN32
 #include <boost/scope_exit.hpp>
@@ -32,15 +38,56 @@
 #endif
 
 static const int METRONOME_CHANNEL = 9;
+/// The number of bars of events to generate ahead of playback.
+static const int LOOKAHEAD_BARS = 4;
+/// The playback speed (percent) that looping can gradually speed up to.
+static const int MAX_RAMP_SPEED = 100;
+/// Marks a mixer value that the playback thread hasn't applied yet.
+static const int MIXER_VALUE_CHANGED = 0x100;
+
+static uint64_t packLocation(const SystemLocation &location)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(location.getSystem()))
+            << 32) |
+           static_cast<uint32_t>(location.getPosition());
+}
+
+static SystemLocation unpackLocation(uint64_t location)
+{
+    return SystemLocation(static_cast<int32_t>(location >> 32),
+                          static_cast<int32_t>(location & 0xffffffff));
+}
 
 MidiPlayer::MidiPlayer(SettingsManager &settings_manager,
-                       const ScoreLocation &start_location, int speed)
+                       const ScoreLocation &start_location, int speed,
+                       std::unique_ptr<MidiOutputBackend> backend)
     : mySettingsManager(settings_manager),
       myScore(start_location.getScore()),
       myStartLocation(start_location),
+      myBackend(std::move(backend)),
       myIsPlaying(false),
-      myPlaybackSpeed(speed)
+      myPlaybackSpeed(speed),
+      myPlaybackLocation(packLocation(
+          SystemLocation(start_location.getSystemIndex(),
+                         start_location.getPositionIndex())))
 {
+    myMutedChannels.fill(false);
+    mySoloChannels.fill(false);
+
+    for (auto &values : myMixerValues)
+    {
+        for (std::atomic<int> &value : values)
+            value = 0;
+    }
+    myMixerChanged = false;
+
+    // Start with the volume and pan from the mixer.
+    for (unsigned int i = 0; i < myScore.getPlayers().size(); ++i)
+    {
+        const Player &player = myScore.getPlayers()[i];
+        setPlayerVolume(i, player.getMaxVolume());
+        setPlayerPan(i, player.getPan());
+    }
 }
 
 MidiPlayer::~MidiPlayer()
@@ -73,14 +120,11 @@ void MidiPlayer::run()
     options.myRecordPositionChanges = true;
 
     // Load MIDI settings.
-    int api;
-    int port;
+    int loop_speed_increment;
     {
         auto settings = mySettingsManager.getReadHandle();
         myMetronomeEnabled = settings->get(Settings::MetronomeEnabled);
-
-        api = settings->get(Settings::MidiApi);
-        port = settings->get(Settings::MidiPort);
+        loop_speed_increment = settings->get(Settings::LoopSpeedIncrement);
 
         options.myMetronomePreset = settings->get(Settings::MetronomePreset) +
                                     Midi::MIDI_PERCUSSION_PRESET_OFFSET;
@@ -90,102 +134,331 @@ void MidiPlayer::run()
         options.myVibratoStrength = settings->get(Settings::MidiVibratoLevel);
         options.myWideVibratoStrength =
             settings->get(Settings::MidiWideVibratoLevel);
+        options.myControllerResolution =
+            settings->get(Settings::MidiControllerResolution);
     }
 
-    MidiFile file;
-    file.load(myScore, options);
-
-    const int ticks_per_beat = file.getTicksPerBeat();
-
-    // Merge the MIDI evvents for each track.
-    MidiEventList events;
-    for (MidiEventList &track : file.getTracks())
-    {
-        track.convertToAbsoluteTicks();
-        events.concat(track);
-    }
+    // Generate the events a few bars ahead of playback, so that playback can
+    // start immediately.
+    MidiEventStream stream(myScore, options, LOOKAHEAD_BARS);
+    const int ticks_per_beat = stream.getTicksPerBeat();
 
-    // TODO - since each track is already sorted, an n-way merge should be faster.
-    std::stable_sort(events.begin(), events.end());
-    events.convertToDeltaTicks();
+    if (!myBackend)
+        myBackend = createBackend();
 
-    // Initialize RtMidi and set the port.
-    MidiOutputDevice device;
-    if (!device.initialize(api, port))
+    if (!myBackend)
     {
         emit error(tr("Error initializing MIDI output device."));
         return;
     }
 
+    MidiOutputDevice device(*myBackend);
+
     bool started = false;
     int beat_duration = Midi::BEAT_DURATION_120_BPM;
     const SystemLocation start_location(myStartLocation.getSystemIndex(),
                                         myStartLocation.getPositionIndex());
     SystemLocation current_location = start_location;
+    int prev_tick = 0;
+    MidiEventList events;
+    // Each event is scheduled relative to the previous event's deadline
+    // rather than to when it was actually sent, so that oversleeping doesn't
+    // accumulate into drift over the course of the song.
+    std::chrono::steady_clock::time_point deadline;
 
-    for (auto event = events.begin(); event != events.end(); ++event)
+    if (myLoopEnd)
     {
-        if (!isPlaying())
-            break;
-
-        if (event->isTempoChange())
-            beat_duration = event->getTempo();
+        Loop loop;
+        if (compileLoop(stream, start_location, *myLoopEnd, loop))
+            playLoop(device, loop, ticks_per_beat, loop_speed_increment);
+        return;
+    }
 
-        // Skip events before the start location, except for events such as
-        // instrument changes. Tempo changes are tracked above.
-        if (!started)
+    while (isPlaying() && stream.readEvents(events))
+    {
+        for (auto event = events.begin(); event != events.end(); ++event)
         {
-            if (event->getLocation() < start_location)
+            if (!isPlaying())
+                break;
+
+            // Events at the start of a bar (e.g. grace notes) may be slightly
+            // earlier than the end of the previous bar.
+            const int delta = std::max(0, event->getTicks() - prev_tick);
+            prev_tick = std::max(prev_tick, event->getTicks());
+
+            if (event->isTempoChange())
+                beat_duration = event->getTempo();
+
+            // Skip events before the start location, except for events such as
+            // instrument changes. Tempo changes are tracked above.
+            if (!started)
             {
-                if (event->isProgramChange())
-                    device.sendMessage(event->getData());
+                if (event->getLocation() < start_location)
+                {
+                    if (event->isProgramChange())
+                    {
+                        device.sendMessage(event->getData(),
+                                           event->getDataSize());
+                    }
 
-                continue;
+                    continue;
+                }
+                else
+                {
+                    performCountIn(device, event->getLocation(), beat_duration);
+
+                    started = true;
+                    deadline = std::chrono::steady_clock::now();
+                }
             }
-            else
+
+            waitForTicks(deadline, delta, beat_duration, ticks_per_beat);
+            applyMixerChanges(device);
+            playEvent(device, *event, current_location);
+        }
+    }
+}
+
+void MidiPlayer::waitForTicks(std::chrono::steady_clock::time_point &deadline,
+                              int ticks, int beat_duration, int ticks_per_beat)
+{
+    const int64_t duration_us =
+        static_cast<int64_t>(ticks) * beat_duration / ticks_per_beat;
+
+    deadline += std::chrono::microseconds(
+        static_cast<int64_t>(duration_us * (100.0 / myPlaybackSpeed)));
+    std::this_thread::sleep_until(deadline);
+}
+
+void MidiPlayer::playEvent(MidiOutputDevice &device, const MidiEvent &event,
+                           SystemLocation &current_location)
+{
+    // Don't play metronome events if the metronome is disabled.
+    if (event.isNoteOnOff() && event.getChannel() == METRONOME_CHANNEL &&
+        !myMetronomeEnabled)
+    {
+        return;
+    }
+
+    // Meta messages (e.g. tempo changes or track names) are only meaningful
+    // in a MIDI file.
+    if (event.isMetaMessage())
+        return;
+
+    if (event.isNoteOn() && event.getChannel() != METRONOME_CHANNEL &&
+        !isChannelAudible(event.getChannel()))
+    {
+        return;
+    }
+
+    // Volume changes from dynamics are scaled by the player's volume.
+    if (event.isVolumeChange())
+        device.setVolume(event.getChannel(), event.getVolume());
+    else
+        device.sendMessage(event.getData(), event.getDataSize());
+
+    // Publish the current playback position.
+    if (event.getLocation() != current_location)
+    {
+        // Don't move backwards unless a repeat occurred.
+        if (event.getLocation() < current_location &&
+            !event.isPositionChange())
+        {
+            return;
+        }
+
+        setPlaybackLocation(event.getLocation(), current_location);
+    }
+}
+
+void MidiPlayer::setPlaybackLocation(const SystemLocation &new_location,
+                                     SystemLocation &current_location)
+{
+    myPlaybackLocation = packLocation(new_location);
+
+    if (new_location.getSystem() != current_location.getSystem())
+        emit playbackSystemChanged(new_location.getSystem());
+
+    current_location = new_location;
+}
+
+bool MidiPlayer::compileLoop(MidiEventStream &stream,
+                             const SystemLocation &start,
+                             const SystemLocation &end, Loop &loop)
+{
+    // The most recent message of each kind (e.g. the volume or pitch wheel
+    // for a channel), in the order that they first occurred so that e.g. the
+    // messages for setting the pitch wheel range stay in order.
+    std::map<std::pair<uint8_t, uint8_t>, size_t> entry_indices;
+    bool started = false;
+    loop.myStartTick = 0;
+    loop.myEndTick = 0;
+    loop.myStartTempo = Midi::BEAT_DURATION_120_BPM;
+    MidiEventList events;
+
+    while (stream.readEvents(events))
+    {
+        for (const MidiEvent &event : events)
+        {
+            if (!started)
             {
-                performCountIn(device, event->getLocation(), beat_duration);
+                if (event.isTempoChange())
+                    loop.myStartTempo = event.getTempo();
+
+                if (event.getLocation() < start)
+                {
+                    if (event.isNoteOnOff() || event.isMetaMessage() ||
+                        event.isPositionChange())
+                    {
+                        continue;
+                    }
+
+                    const uint8_t *data = event.getData();
+                    const std::pair<uint8_t, uint8_t> key(
+                        data[0], event.getDataSize() > 2 ? data[1] : 0);
+
+                    auto it = entry_indices.find(key);
+                    if (it != entry_indices.end())
+                        loop.myEntryEvents[it->second] = event;
+                    else
+                    {
+                        entry_indices[key] = loop.myEntryEvents.size();
+                        loop.myEntryEvents.push_back(event);
+                    }
+
+                    continue;
+                }
 
                 started = true;
+                loop.myStartTick = event.getTicks();
+                loop.myEndTick = event.getTicks();
+            }
+
+            // Stop at the end of the selection, or if a repeat or jump leaves
+            // the selection.
+            const bool has_position =
+                event.isNoteOnOff() || event.isPositionChange();
+            if ((has_position && !(event.getLocation() < end)) ||
+                (event.isPositionChange() && event.getLocation() < start))
+            {
+                loop.myEndTick = event.getTicks();
+                return !loop.myEvents.empty();
             }
+
+            // Skip the note offs for notes from before the selection.
+            if (event.isNoteOnOff() && event.getLocation() < start)
+                continue;
+
+            loop.myEvents.append(event);
+            loop.myEndTick = std::max(loop.myEndTick, event.getTicks());
         }
+    }
+
+    return !loop.myEvents.empty();
+}
 
-        const int delta = event->getTicks();
-        assert(delta >= 0);
+void MidiPlayer::playLoop(MidiOutputDevice &device, const Loop &loop,
+                          int ticks_per_beat, int speed_increment)
+{
+    const SystemLocation start_location(myStartLocation.getSystemIndex(),
+                                        myStartLocation.getPositionIndex());
+    SystemLocation current_location = start_location;
+    std::array<std::bitset<128>, MidiOutputDevice::NUM_CHANNELS> active_notes;
 
-        const int duration_us = boost::rational_cast<int>(
-            boost::rational<int>(delta, ticks_per_beat) * beat_duration);
+    performCountIn(device, start_location, loop.myStartTempo);
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now();
 
-        usleep(duration_us * (100.0 / myPlaybackSpeed));
+    while (isPlaying())
+    {
+        // Restore the state of each channel from the start of the loop.
+        for (const MidiEvent &event : loop.myEntryEvents)
+            playEvent(device, event, current_location);
 
-        // Don't play metronome events if the metronome is disabled.
-        if (event->isNoteOnOff() && event->getChannel() == METRONOME_CHANNEL &&
-            !myMetronomeEnabled)
+        int beat_duration = loop.myStartTempo;
+        int prev_tick = loop.myStartTick;
+
+        for (const MidiEvent &event : loop.myEvents)
         {
-            continue;
+            if (!isPlaying())
+                return;
+
+            const int delta = std::max(0, event.getTicks() - prev_tick);
+            prev_tick = std::max(prev_tick, event.getTicks());
+
+            if (event.isTempoChange())
+                beat_duration = event.getTempo();
+
+            waitForTicks(deadline, delta, beat_duration, ticks_per_beat);
+            applyMixerChanges(device);
+            playEvent(device, event, current_location);
+
+            if (event.isNoteOnOff())
+            {
+                active_notes[event.getChannel()][event.getData()[1]] =
+                    event.isNoteOn();
+            }
         }
 
-        device.sendMessage(event->getData());
+        // Wait for the end of the last bar, and then wrap around to the start
+        // of the loop without any gap. Since the deadlines are absolute, the
+        // loop doesn't drift over many iterations.
+        waitForTicks(deadline, std::max(0, loop.myEndTick - prev_tick),
+                     beat_duration, ticks_per_beat);
 
-        // Notify listeners of the current playback position.
-        if (event->getLocation() != current_location)
+        // Stop any notes whose note off is after the end of the loop.
+        for (int channel = 0; channel < MidiOutputDevice::NUM_CHANNELS;
+             ++channel)
         {
-            const SystemLocation &new_location = event->getLocation();
-
-            // Don't move backwards unless a repeat occurred.
-            if (new_location < current_location && !event->isPositionChange())
-                    continue;
+            for (int pitch = 0; pitch < 128; ++pitch)
+            {
+                if (active_notes[channel][pitch])
+                    device.stopNote(channel, pitch);
+            }
 
-            if (new_location.getSystem() != current_location.getSystem())
-                emit playbackSystemChanged(new_location.getSystem());
+            active_notes[channel].reset();
+        }
 
-            emit playbackPositionChanged(new_location.getPosition());
+        setPlaybackLocation(start_location, current_location);
 
-            current_location = new_location;
+        // Gradually speed up (e.g. to practice a passage slowly at first).
+        if (speed_increment > 0 && myPlaybackSpeed < MAX_RAMP_SPEED)
+        {
+            myPlaybackSpeed =
+                std::min(MAX_RAMP_SPEED, myPlaybackSpeed + speed_increment);
         }
     }
 }
 
+std::unique_ptr<MidiOutputBackend> MidiPlayer::createBackend()
+{
+    int api;
+    int port;
+    bool virtual_port;
+    {
+        auto settings = mySettingsManager.getReadHandle();
+        api = settings->get(Settings::MidiApi);
+        port = settings->get(Settings::MidiPort);
+        virtual_port = settings->get(Settings::MidiVirtualPort);
+    }
+
+    if (virtual_port)
+    {
+        std::unique_ptr<AlsaVirtualPortBackend> backend(
+            new AlsaVirtualPortBackend());
+        if (backend->initialize("Power Tab Editor"))
+            return std::unique_ptr<MidiOutputBackend>(std::move(backend));
+    }
+    else
+    {
+        std::unique_ptr<RtMidiBackend> backend(new RtMidiBackend());
+        if (backend->initialize(api, port))
+            return std::unique_ptr<MidiOutputBackend>(std::move(backend));
+    }
+
+    return nullptr;
+}
+
 void MidiPlayer::performCountIn(MidiOutputDevice &device,
                                 const SystemLocation &location,
                                 int beat_duration)
@@ -212,10 +485,9 @@ void MidiPlayer::performCountIn(MidiOutputDevice &device,
 
     const TimeSignature &time_sig = barline->getTimeSignature();
 
-    const int tick_duration = boost::rational_cast<int>(
-        boost::rational<int>(4, time_sig.getBeatValue()) *
-        boost::rational<int>(time_sig.getBeatsPerMeasure(),
-                             time_sig.getNumPulses()) * beat_duration);
+    const int64_t tick_duration =
+        4LL * time_sig.getBeatsPerMeasure() * beat_duration /
+        (time_sig.getBeatValue() * time_sig.getNumPulses());
 
     // Play the count-in.
     device.setChannelMaxVolume(METRONOME_CHANNEL,
@@ -232,11 +504,124 @@ void MidiPlayer::performCountIn(MidiOutputDevice &device,
     }
 }
 
+void MidiPlayer::setLoop(const SystemLocation &end)
+{
+    myLoopEnd = end;
+}
+
 void MidiPlayer::changePlaybackSpeed(int new_speed)
 {
     myPlaybackSpeed = new_speed;
 }
 
+SystemLocation MidiPlayer::getPlaybackLocation() const
+{
+    return unpackLocation(myPlaybackLocation);
+}
+
+void MidiPlayer::setPlayerVolume(int player, uint8_t volume)
+{
+    setMixerValue(Volume, player, volume);
+}
+
+void MidiPlayer::setPlayerPan(int player, uint8_t pan)
+{
+    setMixerValue(Pan, player, pan);
+}
+
+void MidiPlayer::setPlayerPreset(int player, uint8_t preset)
+{
+    setMixerValue(Preset, player, preset);
+}
+
+void MidiPlayer::setPlayerMuted(int player, bool muted)
+{
+    setMixerValue(Mute, player, muted);
+}
+
+void MidiPlayer::setPlayerSolo(int player, bool solo)
+{
+    setMixerValue(Solo, player, solo);
+}
+
+void MidiPlayer::setMixerValue(MixerSetting setting, int player,
+                               uint8_t value)
+{
+    const int channel = MidiFile::getPlayerChannel(player);
+    if (channel >= MidiOutputDevice::NUM_CHANNELS)
+        return;
+
+    myMixerValues[channel][setting] = value | MIXER_VALUE_CHANGED;
+    myMixerChanged = true;
+}
+
+void MidiPlayer::applyMixerChanges(MidiOutputDevice &device)
+{
+    if (!myMixerChanged.exchange(false))
+        return;
+
+    bool silenced = false;
+
+    for (int channel = 0; channel < MidiOutputDevice::NUM_CHANNELS;
+         ++channel)
+    {
+        for (int setting = 0; setting < NumMixerSettings; ++setting)
+        {
+            // Take the latest value, and clear its flag.
+            const int value =
+                myMixerValues[channel][setting].fetch_and(
+                    ~MIXER_VALUE_CHANGED);
+            if (!(value & MIXER_VALUE_CHANGED))
+                continue;
+
+            const uint8_t level = static_cast<uint8_t>(value);
+            switch (setting)
+            {
+                case Volume:
+                    device.setChannelMaxVolume(channel, level);
+                    break;
+                case Pan:
+                    device.setPan(channel, level);
+                    break;
+                case Preset:
+                    device.setPatch(channel, level);
+                    break;
+                case Mute:
+                    myMutedChannels[channel] = level != 0;
+                    silenced = true;
+                    break;
+                case Solo:
+                    mySoloChannels[channel] = level != 0;
+                    silenced = true;
+                    break;
+            }
+        }
+    }
+
+    // Cut off any notes that are still ringing on channels that were just
+    // muted.
+    if (silenced)
+    {
+        for (int channel = 0; channel < MidiOutputDevice::NUM_CHANNELS;
+             ++channel)
+        {
+            if (channel != METRONOME_CHANNEL && !isChannelAudible(channel))
+                device.stopAllNotes(channel);
+        }
+    }
+}
+
+bool MidiPlayer::isChannelAudible(int channel) const
+{
+    if (myMutedChannels[channel])
+        return false;
+
+    const bool any_solo = std::find(mySoloChannels.begin(),
+                                    mySoloChannels.end(),
+                                    true) != mySoloChannels.end();
+    return !any_solo || mySoloChannels[channel];
+}
+
 void MidiPlayer::setIsPlaying(bool set)
 {
     myIsPlaying = set;
@@ -18,52 +18,162 @@
 #ifndef AUDIO_MIDIPLAYER_H
 #define AUDIO_MIDIPLAYER_H
 
+#include <array>
 #include <atomic>
+#include <audio/midioutputbackend.h>
+#include <audio/midioutputdevice.h>
+#include <boost/optional/optional.hpp>
+#include <chrono>
+#include <memory>
+#include <midi/midieventlist.h>
 #include <QThread>
+#include <score/score.h>
 #include <score/scorelocation.h>
+#include <score/systemlocation.h>
 
+class MidiEventStream;
 class MidiFile;
-class MidiOutputDevice;
-class Score;
 class SettingsManager;
-class SystemLocation;
 
 class MidiPlayer : public QThread
 {
     Q_OBJECT
 
 public:
+    /// By default, the events are sent to the MIDI port from the settings.
+    /// A different backend (e.g. a RecordingMidiBackend) can be provided
+    /// instead.
     MidiPlayer(SettingsManager &settings_manager,
-               const ScoreLocation &start_location, int speed);
+               const ScoreLocation &start_location, int speed,
+               std::unique_ptr<MidiOutputBackend> backend = nullptr);
     ~MidiPlayer();
 
+    /// Repeatedly plays from the start location up to (but not including)
+    /// the end location, rather than playing to the end of the score. The
+    /// events for the loop are only generated once. This must be called
+    /// before playback starts.
+    void setLoop(const SystemLocation &end);
+
     void changePlaybackSpeed(int new_speed);
 
+    /// Changes to the mix, which are heard from the next event onwards
+    /// without restarting playback. These must only be called from the GUI
+    /// thread.
+    void setPlayerVolume(int player, uint8_t volume);
+    void setPlayerPan(int player, uint8_t pan);
+    void setPlayerPreset(int player, uint8_t preset);
+    void setPlayerMuted(int player, bool muted);
+    void setPlayerSolo(int player, bool solo);
+
     const ScoreLocation &getStartLocation() const { return myStartLocation; }
 
+    /// Returns the location that was most recently played. This can be
+    /// polled from the GUI thread without blocking playback.
+    SystemLocation getPlaybackLocation() const;
+
+    /// The events for a loop, which are played repeatedly.
+    struct Loop
+    {
+        /// The state of each channel (e.g. its instrument, volume and pitch
+        /// wheel) at the start of the loop.
+        std::vector<MidiEvent> myEntryEvents;
+        MidiEventList myEvents;
+        int myStartTick;
+        /// The tick where the loop wraps around to the start.
+        int myEndTick;
+        int myStartTempo;
+    };
+
+    /// Reads the events between the start and end locations from the stream.
+    /// Returns false if there are no events to loop.
+    static bool compileLoop(MidiEventStream &stream,
+                            const SystemLocation &start,
+                            const SystemLocation &end, Loop &loop);
+
 signals:
-    // These signals are used to move the caret when a position change is
-    // necessary
+    /// Emitted when playback moves to a different system. Changes within the
+    /// system are only available through getPlaybackLocation(), to avoid
+    /// flooding the GUI with notifications during fast passages.
     void playbackSystemChanged(int system);
-    void playbackPositionChanged(int position);
     void error(const QString &msg);
 
 private:
     virtual void run() override;
 
+    /// Creates the backend for the MIDI port from the settings.
+    std::unique_ptr<MidiOutputBackend> createBackend();
+
     void performCountIn(MidiOutputDevice &device,
                         const SystemLocation &location, int beat_duration);
 
+    /// Advances the deadline by the duration of the ticks, and sleeps until
+    /// then.
+    void waitForTicks(std::chrono::steady_clock::time_point &deadline,
+                      int ticks, int beat_duration, int ticks_per_beat);
+    /// Sends the event to the device (unless e.g. it is muted), and publishes
+    /// the playback location.
+    void playEvent(MidiOutputDevice &device, const MidiEvent &event,
+                   SystemLocation &current_location);
+    void setPlaybackLocation(const SystemLocation &new_location,
+                             SystemLocation &current_location);
+
+    /// Plays the loop until playback is stopped. The speed is increased by
+    /// the given percentage after each repetition, without changing the
+    /// speed that was chosen in the playback widget.
+    void playLoop(MidiOutputDevice &device, const Loop &loop,
+                  int ticks_per_beat, int speed_increment);
+
     void setIsPlaying(bool set);
     bool isPlaying() const;
 
+    /// The settings from the mixer, which are changed from the GUI thread.
+    enum MixerSetting
+    {
+        Volume,
+        Pan,
+        Preset,
+        Mute,
+        Solo,
+        NumMixerSettings
+    };
+
+    void setMixerValue(MixerSetting setting, int player, uint8_t value);
+    /// Applies any changes to the mix since the last call.
+    void applyMixerChanges(MidiOutputDevice &device);
+    /// Returns false if the channel's player is muted, or if other players
+    /// are soloed.
+    bool isChannelAudible(int channel) const;
+
     SettingsManager &mySettingsManager;
-    const Score &myScore;
+    /// A snapshot of the score, which is taken on the GUI thread when the
+    /// player is created. The playback thread only reads from this copy, since
+    /// the original score can be modified during playback (e.g. from the
+    /// mixer).
+    const Score myScore;
     ScoreLocation myStartLocation;
+    std::unique_ptr<MidiOutputBackend> myBackend;
+    boost::optional<SystemLocation> myLoopEnd;
     std::atomic<bool> myIsPlaying;
     std::atomic<bool> myMetronomeEnabled;
     /// The current playback speed (percent).
     std::atomic<int> myPlaybackSpeed;
+    /// The current playback location, with the system and position packed
+    /// together so that they are updated atomically.
+    std::atomic<uint64_t> myPlaybackLocation;
+
+    /// The latest value of each mixer setting for each channel, along with
+    /// a flag (MIXER_VALUE_CHANGED) if the playback thread hasn't applied it
+    /// yet. A setting that is changed again before then only keeps its latest
+    /// value, so no changes are lost if playback is stalled.
+    std::array<std::array<std::atomic<int>, NumMixerSettings>,
+               MidiOutputDevice::NUM_CHANNELS> myMixerValues;
+    /// Whether any of the mixer values have changed since they were last
+    /// applied.
+    std::atomic<bool> myMixerChanged;
+    /// The muted and soloed channels, which are only accessed by the playback
+    /// thread.
+    std::array<bool, MidiOutputDevice::NUM_CHANNELS> myMutedChannels;
+    std::array<bool, MidiOutputDevice::NUM_CHANNELS> mySoloChannels;
 };
 
 #endif
@@ -0,0 +1,29 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "recordingmidibackend.h"
+
+bool RecordingMidiBackend::sendMessage(const uint8_t *data, size_t size)
+{
+    // Take the timestamp first, so that it isn't affected by the allocation.
+    Message message;
+    message.myTime = Clock::now();
+    message.myData.assign(data, data + size);
+
+    myMessages.push_back(std::move(message));
+    return true;
+}
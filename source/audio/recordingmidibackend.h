@@ -0,0 +1,48 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_RECORDINGMIDIBACKEND_H
+#define AUDIO_RECORDINGMIDIBACKEND_H
+
+#include <audio/midioutputbackend.h>
+#include <chrono>
+#include <vector>
+
+/// Records each message along with the time that it was sent. This allows the
+/// timing of playback to be tested without a MIDI device.
+class RecordingMidiBackend : public MidiOutputBackend
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Message
+    {
+        Clock::time_point myTime;
+        std::vector<uint8_t> myData;
+    };
+
+    virtual bool sendMessage(const uint8_t *data, size_t size) override;
+
+    /// Returns the recorded messages. This must not be called while messages
+    /// are still being sent from another thread.
+    const std::vector<Message> &getMessages() const { return myMessages; }
+
+private:
+    std::vector<Message> myMessages;
+};
+
+#endif
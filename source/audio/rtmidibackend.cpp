@@ -0,0 +1,111 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rtmidibackend.h"
+
+#include <cassert>
+#include <RtMidi.h>
+
+RtMidiBackend::RtMidiBackend() : myMidiOut(nullptr)
+{
+    // Create all MIDI APIs supported on this platform.
+    std::vector<RtMidi::Api> apis;
+    RtMidi::getCompiledApi(apis);
+
+    for (const RtMidi::Api &api : apis)
+    {
+        try
+        {
+            myMidiOuts.emplace_back(new RtMidiOut(api));
+        }
+        catch (...)
+        {
+            // continue anyway, another api might work
+            // found on mac that the Core API kept failing after repeated 
+            // creations and the exceptions weren't caught
+            // TODO investigate why.
+        }
+    }
+}
+
+RtMidiBackend::~RtMidiBackend()
+{
+}
+
+bool RtMidiBackend::initialize(size_t preferredApi, unsigned int preferredPort)
+{
+    if (myMidiOut)
+        myMidiOut->closePort(); // Close any open ports.
+
+    if (preferredApi >= myMidiOuts.size())
+        return false;
+
+    myMidiOut = myMidiOuts[preferredApi].get();
+    unsigned int num_ports = myMidiOut->getPortCount();
+
+    if (num_ports == 0)
+        return false;
+
+    try
+    {
+        myMidiOut->openPort(preferredPort);
+    }
+    catch (...)
+    {
+         return false;
+    }
+
+    return true;
+}
+
+size_t RtMidiBackend::getApiCount()
+{
+    return myMidiOuts.size();
+}
+
+unsigned int RtMidiBackend::getPortCount(size_t api)
+{
+    assert(api < myMidiOuts.size() && "Programming error, api doesn't exist");
+    return myMidiOuts[api]->getPortCount();
+}
+
+std::string RtMidiBackend::getPortName(size_t api, unsigned int port)
+{
+    assert(api < myMidiOuts.size() && "Programming error, api doesn't exist");
+    return myMidiOuts[api]->getPortName(port);
+}
+
+bool RtMidiBackend::sendMessage(const uint8_t *data, size_t size)
+{
+    if (!myMidiOut)
+        return false;
+
+    // RtMidi requires a vector, so copy the message into a buffer that keeps
+    // its capacity between messages.
+    myMessage.assign(data, data + size);
+
+    try
+    {
+        myMidiOut->sendMessage(&myMessage);
+    }
+    catch (...)
+    {
+         return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUDIO_RTMIDIBACKEND_H
+#define AUDIO_RTMIDIBACKEND_H
+
+#include <audio/midioutputbackend.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class RtMidiOut;
+
+/// Sends MIDI messages to one of the system's MIDI ports, using RtMidi.
+class RtMidiBackend : public MidiOutputBackend
+{
+public:
+    RtMidiBackend();
+    ~RtMidiBackend();
+
+    /// Opens the given port. Returns false if the port could not be opened.
+    bool initialize(size_t preferredApi, unsigned int preferredPort);
+    size_t getApiCount();
+    unsigned int getPortCount(size_t api);
+    std::string getPortName(size_t api, unsigned int port);
+
+    virtual bool sendMessage(const uint8_t *data, size_t size) override;
+
+private:
+    std::vector<std::unique_ptr<RtMidiOut>> myMidiOuts;
+    RtMidiOut *myMidiOut;
+    /// Reused buffer for the messages passed to RtMidi.
+    std::vector<uint8_t> myMessage;
+};
+
+#endif
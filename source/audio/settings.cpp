@@ -25,10 +25,15 @@ const Setting<int> MidiApi("midi/api", 0);
 
 const Setting<int> MidiPort("midi/port", 0);
 
+const Setting<bool> MidiVirtualPort("midi/virtual_port", false);
+
 const Setting<int> MidiVibratoLevel("midi/vibrato_level", 85);
 
 const Setting<int> MidiWideVibratoLevel("midi/wide_vibrato_level", 127);
 
+const Setting<int> MidiControllerResolution("midi/controller_resolution",
+                                            100);
+
 const Setting<bool> MetronomeEnabled("midi/metronome_enabled", true);
 
 const Setting<int> MetronomePreset("midi/metronome_preset",
@@ -44,4 +49,6 @@ const Setting<int> CountInPreset("midi/count_in_preset",
                                  Midi::MIDI_PERCUSSION_PRESET_RIDE_CYMBAL2);
 
 const Setting<int> CountInVolume("midi/count_in_volume", 127);
+
+const Setting<int> LoopSpeedIncrement("midi/loop_speed_increment", 0);
 }
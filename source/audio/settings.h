@@ -25,9 +25,15 @@ namespace Settings
 {
     extern const Setting<int> MidiApi;
     extern const Setting<int> MidiPort;
+    /// Whether to play through a virtual port rather than the selected
+    /// system port.
+    extern const Setting<bool> MidiVirtualPort;
 
     extern const Setting<int> MidiVibratoLevel;
     extern const Setting<int> MidiWideVibratoLevel;
+    /// The maximum number of events per second for bends and slides, or 0
+    /// for no limit.
+    extern const Setting<int> MidiControllerResolution;
 
     extern const Setting<bool> MetronomeEnabled;
     extern const Setting<int> MetronomePreset;
@@ -37,6 +43,10 @@ namespace Settings
     extern const Setting<bool> CountInEnabled;
     extern const Setting<int> CountInPreset;
     extern const Setting<int> CountInVolume;
+
+    /// The percentage that the playback speed increases by after each
+    /// repetition of a loop.
+    extern const Setting<int> LoopSpeedIncrement;
 }
 
 #endif
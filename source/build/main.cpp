@@ -18,17 +18,26 @@
 #include <app/appinfo.h>
 #include <app/paths.h>
 #include <app/powertabeditor.h>
+#include <app/scoreexporter.h>
 #include <app/settings.h>
 #include <app/settingsmanager.h>
 #include <boost/program_options.hpp>
 #include <csignal>
 #include <dialogs/crashdialog.h>
 #include <exception>
+#include <formats/fileformatmanager.h>
 #include <iostream>
+#include <map>
+#include <painters/musicfont.h>
 #include <QApplication>
+#include <QDir>
+#include <QFileInfo>
 #include <QFileOpenEvent>
 #include <QLocalServer>
 #include <QLocalSocket>
+#include <score/score.h>
+#include <score/utils/scorediff.h>
+#include <stdexcept>
 #include <string>
 #include <withershins.hpp>
 
@@ -108,6 +117,144 @@ static void signalHandler(int /*signal*/)
     displayError("Segmentation fault");
 }
 
+static void importScore(FileFormatManager &manager,
+                        const std::string &filename, Score &score)
+{
+    QFileInfo fileInfo(QString::fromStdString(filename));
+    boost::optional<FileFormat> format =
+        manager.findFormat(fileInfo.suffix().toStdString());
+    if (!format)
+        throw std::runtime_error("Unsupported file type: " + filename);
+
+    manager.importFile(score, filename, *format);
+}
+
+/// Prints the systems that were changed, inserted, or removed between the
+/// two files.
+static int printScoreDiff(const SettingsManager &settings_manager,
+                          const std::string &oldFile,
+                          const std::string &newFile)
+{
+    FileFormatManager manager(settings_manager);
+    Score oldScore;
+    Score newScore;
+
+    try
+    {
+        importScore(manager, oldFile, oldScore);
+        importScore(manager, newFile, newScore);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (const ScoreUtils::SystemDifference &diff :
+         ScoreUtils::diffScores(oldScore, newScore))
+    {
+        switch (diff.myType)
+        {
+            case ScoreUtils::SystemDifference::Changed:
+                std::cout << "changed: system " << diff.myOldIndex + 1
+                          << " -> " << diff.myNewIndex + 1 << std::endl;
+                break;
+            case ScoreUtils::SystemDifference::Inserted:
+                std::cout << "inserted: system " << diff.myNewIndex + 1
+                          << std::endl;
+                break;
+            case ScoreUtils::SystemDifference::Removed:
+                std::cout << "removed: system " << diff.myOldIndex + 1
+                          << std::endl;
+                break;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/// Exports each file to the output directory, or to the same directory as the
+/// file if no output directory is specified. The scores are imported in
+/// batches while exporting, so that they aren't all held in memory.
+static int exportFiles(const SettingsManager &settings_manager,
+                       const std::vector<std::string> &files,
+                       ScoreExporter::Format format,
+                       const std::string &outputDir, int resolution,
+                       int threadCount)
+{
+    MusicFont::loadFonts();
+
+    FileFormatManager manager(settings_manager);
+    std::vector<ScoreExporter::Job> jobs;
+    // The input file that is exported to each output file.
+    std::map<QString, std::string> outputs;
+
+    try
+    {
+        for (const std::string &file : files)
+        {
+            const QFileInfo fileInfo(QString::fromStdString(file));
+            const QDir dir(outputDir.empty()
+                               ? fileInfo.path()
+                               : QString::fromStdString(outputDir));
+            const QString name =
+                fileInfo.completeBaseName() + "." +
+                QString::fromStdString(ScoreExporter::getExtension(format));
+            const QString output = dir.filePath(name);
+
+            // Files with the same name from different directories would
+            // otherwise overwrite each other (from different threads).
+            const QString key =
+                QDir::cleanPath(QFileInfo(output).absoluteFilePath());
+            auto existing = outputs.find(key);
+            if (existing != outputs.end())
+            {
+                throw std::runtime_error(
+                    existing->second + " and " + file +
+                    " would both be exported to " + output.toStdString());
+            }
+            outputs.emplace(key, file);
+
+            jobs.emplace_back(
+                [&manager, file](Score &score) {
+                    importScore(manager, file, score);
+                },
+                output.toStdString());
+        }
+
+        ScoreExporter exporter(format, threadCount);
+        if (resolution > 0)
+            exporter.setResolution(resolution);
+
+        for (const std::string &file : exporter.exportScores(jobs))
+            std::cout << file << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/// Returns whether the command line requests an export or a diff, which
+/// don't open any windows. This is checked before the application is created.
+static bool isHeadless(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--export" || arg.compare(0, 9, "--export=") == 0 ||
+            arg == "--diff" || arg.compare(0, 7, "--diff=") == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 class Application : public QApplication
 {
 public:
@@ -144,6 +291,14 @@ int main(int argc, char *argv[])
     std::set_terminate(terminateHandler);
     std::signal(SIGSEGV, signalHandler);
 
+    // Exporting and diffing don't open any windows, so they can run without
+    // a display.
+    if (isHeadless(argc, argv) &&
+        !qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     Application a(argc, argv);
 
     // Set the app information (used by e.g. QSettings).
@@ -158,6 +313,12 @@ int main(int argc, char *argv[])
 #endif
 
     QStringList filesToOpen;
+    std::vector<std::string> filesToDiff;
+    std::vector<std::string> filesToExport;
+    boost::optional<ScoreExporter::Format> exportFormat;
+    std::string exportDir;
+    int exportResolution = 0;
+    int exportThreads = 0;
 
     namespace po = boost::program_options;
     po::options_description desc("Usage: powertabeditor [options] [files...] "
@@ -167,6 +328,18 @@ int main(int argc, char *argv[])
         desc.add_options()
             ("help,h", "Displays this help.")
             ("version,v", "Displays version information.")
+            ("diff", po::value<std::vector<std::string>>()->multitoken(),
+             "Lists the systems that differ between two files.")
+            ("export", po::value<std::string>(),
+             "Exports the files to pdf, svg, or png without opening a "
+             "window.")
+            ("output-dir", po::value<std::string>(&exportDir),
+             "The directory for exported files (by default, the directory "
+             "of each file).")
+            ("resolution", po::value<int>(&exportResolution),
+             "The resolution of exported pages, in dots per inch.")
+            ("jobs,j", po::value<int>(&exportThreads),
+             "The number of threads to use when exporting.")
             ("files", po::value<std::vector<std::string>>(),
              "The files to be opened, optionally.");
         po::positional_options_description p;
@@ -194,11 +367,30 @@ int main(int argc, char *argv[])
             return EXIT_SUCCESS;
         }
 
+        if (vm.count("diff"))
+        {
+            filesToDiff = vm["diff"].as<std::vector<std::string>>();
+            if (filesToDiff.size() != 2)
+                throw po::error("--diff requires exactly two files");
+        }
+
         if (vm.count("files"))
         {
             auto files = vm["files"].as<std::vector<std::string>>();
             for (auto &file : files)
                 filesToOpen.push_back(QString::fromStdString(file));
+
+            filesToExport = files;
+        }
+
+        if (vm.count("export"))
+        {
+            exportFormat =
+                ScoreExporter::findFormat(vm["export"].as<std::string>());
+            if (!exportFormat)
+                throw po::error("--export requires pdf, svg, or png");
+            if (filesToExport.empty())
+                throw po::error("--export requires at least one file");
         }
     }
     catch(po::error &e)
@@ -212,6 +404,18 @@ int main(int argc, char *argv[])
         SettingsManager settings_manager;
         settings_manager.load(Paths::getConfigDir());
 
+        if (!filesToDiff.empty())
+        {
+            return printScoreDiff(settings_manager, filesToDiff[0],
+                                  filesToDiff[1]);
+        }
+
+        if (exportFormat)
+        {
+            return exportFiles(settings_manager, filesToExport, *exportFormat,
+                               exportDir, exportResolution, exportThreads);
+        }
+
         auto settings = settings_manager.getReadHandle();
         bool single_window_mode = !settings->get(Settings::OpenFilesInNewWindow);
 
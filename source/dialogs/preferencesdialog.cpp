@@ -20,7 +20,8 @@
 
 #include <app/settings.h>
 #include <app/settingsmanager.h>
-#include <audio/midioutputdevice.h>
+#include <audio/alsavirtualportbackend.h>
+#include <audio/rtmidibackend.h>
 #include <audio/settings.h>
 #include <boost/lexical_cast.hpp>
 #include <dialogs/tuningdialog.h>
@@ -29,6 +30,9 @@
 typedef std::pair<int, int> MidiApiAndPort;
 Q_DECLARE_METATYPE(MidiApiAndPort)
 
+/// Combo box data for the virtual port, which isn't owned by any MIDI API.
+static const MidiApiAndPort theVirtualPort(-1, -1);
+
 PreferencesDialog::PreferencesDialog(QWidget *parent,
                                      SettingsManager &settings_manager,
                                      const TuningDictionary &dictionary)
@@ -40,7 +44,7 @@ PreferencesDialog::PreferencesDialog(QWidget *parent,
     ui->setupUi(this);
 
     // Add available MIDI ports.
-    MidiOutputDevice device;
+    RtMidiBackend device;
     for (size_t i = 0; i < device.getApiCount(); ++i)
     {
         for(unsigned int j = 0; j < device.getPortCount(i); ++j)
@@ -53,6 +57,12 @@ PreferencesDialog::PreferencesDialog(QWidget *parent,
         }
     }
 
+    if (AlsaVirtualPortBackend::isAvailable())
+    {
+        ui->midiPortComboBox->addItem(tr("Virtual Port (ALSA)"),
+                                      QVariant::fromValue(theVirtualPort));
+    }
+
     for (const std::string &name : Midi::getPresetNames())
         ui->defaultPresetComboBox->addItem(QString::fromStdString(name));
 
@@ -65,6 +75,10 @@ PreferencesDialog::PreferencesDialog(QWidget *parent,
     ui->vibratoStrengthSpinBox->setRange(1, 127);
     ui->wideVibratoStrengthSpinBox->setRange(1, 127);
 
+    ui->controllerResolutionSpinBox->setRange(0, 1000);
+    ui->controllerResolutionSpinBox->setSuffix(tr(" events/s"));
+    ui->controllerResolutionSpinBox->setSpecialValueText(tr("Unlimited"));
+
     ui->strongAccentVolumeSpinBox->setRange(0, 127);
     ui->weakAccentVolumeSpinBox->setRange(0, 127);
 
@@ -86,8 +100,17 @@ void PreferencesDialog::loadCurrentSettings()
     const unsigned int port = settings->get(Settings::MidiPort);
 
     // Find the preferred midi port in the combo box.
-    MidiOutputDevice device;
-    if (api < device.getApiCount() && port < device.getPortCount(api))
+    RtMidiBackend device;
+    if (settings->get(Settings::MidiVirtualPort))
+    {
+        for (int i = 0; i < ui->midiPortComboBox->count(); ++i)
+        {
+            const QVariant data = ui->midiPortComboBox->itemData(i);
+            if (data.value<MidiApiAndPort>() == theVirtualPort)
+                ui->midiPortComboBox->setCurrentIndex(i);
+        }
+    }
+    else if (api < device.getApiCount() && port < device.getPortCount(api))
     {
         ui->midiPortComboBox->setCurrentIndex(ui->midiPortComboBox->findText(
             QString::fromStdString(device.getPortName(api, port))));
@@ -99,6 +122,9 @@ void PreferencesDialog::loadCurrentSettings()
     ui->wideVibratoStrengthSpinBox->setValue(
         settings->get(Settings::MidiWideVibratoLevel));
 
+    ui->controllerResolutionSpinBox->setValue(
+        settings->get(Settings::MidiControllerResolution));
+
     ui->metronomeEnabledCheckBox->setChecked(
         settings->get(Settings::MetronomeEnabled));
 
@@ -141,8 +167,16 @@ void PreferencesDialog::accept()
 
     MidiApiAndPort apiAndPort = ui->midiPortComboBox->itemData(
                 ui->midiPortComboBox->currentIndex()).value<MidiApiAndPort>();
-    settings->set(Settings::MidiApi, apiAndPort.first);
-    settings->set(Settings::MidiPort, apiAndPort.second);
+    if (apiAndPort == theVirtualPort)
+    {
+        settings->set(Settings::MidiVirtualPort, true);
+    }
+    else
+    {
+        settings->set(Settings::MidiVirtualPort, false);
+        settings->set(Settings::MidiApi, apiAndPort.first);
+        settings->set(Settings::MidiPort, apiAndPort.second);
+    }
 
     settings->set(Settings::MidiVibratoLevel,
                   ui->vibratoStrengthSpinBox->value());
@@ -150,6 +184,9 @@ void PreferencesDialog::accept()
     settings->set(Settings::MidiWideVibratoLevel,
                   ui->wideVibratoStrengthSpinBox->value());
 
+    settings->set(Settings::MidiControllerResolution,
+                  ui->controllerResolutionSpinBox->value());
+
     settings->set(Settings::MetronomeEnabled,
                   ui->metronomeEnabledCheckBox->isChecked());
 
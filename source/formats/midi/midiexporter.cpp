@@ -100,6 +100,8 @@ void MidiExporter::save(const std::string &filename, const Score &score)
         options.myVibratoStrength = settings->get(Settings::MidiVibratoLevel);
         options.myWideVibratoStrength =
             settings->get(Settings::MidiWideVibratoLevel);
+        options.myControllerResolution =
+            settings->get(Settings::MidiControllerResolution);
     }
 
     MidiFile file;
@@ -140,8 +142,8 @@ void MidiExporter::writeTrack(std::ostream & os, const MidiEventList & events)
     for (const MidiEvent &event : events)
     {
         writeVariableLength(os, event.getTicks());
-        os.write(reinterpret_cast<const char *>(event.getData().data()),
-                 event.getData().size());
+        os.write(reinterpret_cast<const char *>(event.getData()),
+                 event.getDataSize());
     }
 
     const std::iostream::pos_type chunk_end_pos = os.tellp();
@@ -0,0 +1,120 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "wavexporter.h"
+
+#include <app/settingsmanager.h>
+#include <audio/settings.h>
+#include <midi/midifile.h>
+#include <midi/synthesizer.h>
+#include <score/generalmidi.h>
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+static const int SAMPLE_RATE = 44100;
+static const int BITS_PER_SAMPLE = 16;
+
+/// WAV files are little-endian.
+static void write(std::ostream &os, uint32_t val, int num_bytes)
+{
+    for (int i = 0; i < num_bytes; ++i)
+        os.put(static_cast<char>((val >> (8 * i)) & 0xff));
+}
+
+/// Writes the RIFF header and the format chunk, followed by the header of the
+/// data chunk.
+static void writeHeader(std::ostream &os, uint32_t data_size)
+{
+    const int num_channels = Synthesizer::NUM_OUTPUT_CHANNELS;
+    const int block_align = num_channels * BITS_PER_SAMPLE / 8;
+
+    os << "RIFF";
+    write(os, 36 + data_size, 4);
+    os << "WAVE";
+
+    os << "fmt ";
+    write(os, 16, 4);
+    // PCM format.
+    write(os, 1, 2);
+    write(os, num_channels, 2);
+    write(os, SAMPLE_RATE, 4);
+    write(os, SAMPLE_RATE * block_align, 4);
+    write(os, block_align, 2);
+    write(os, BITS_PER_SAMPLE, 2);
+
+    os << "data";
+    write(os, data_size, 4);
+}
+
+WavExporter::WavExporter(const SettingsManager &settings_manager)
+    : FileFormatExporter(FileFormat("WAV Audio", { "wav" })),
+      mySettingsManager(settings_manager)
+{
+}
+
+void WavExporter::save(const std::string &filename, const Score &score)
+{
+    std::ofstream os(filename, std::ios::out | std::ios::binary);
+    os.exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
+
+    MidiFile::LoadOptions options;
+    options.myRecordPositionChanges = false;
+    {
+        // Include the metronome clicks if they are enabled for playback.
+        auto settings = mySettingsManager.getReadHandle();
+        options.myEnableMetronome = settings->get(Settings::MetronomeEnabled);
+        options.myMetronomePreset = settings->get(Settings::MetronomePreset) +
+                                    Midi::MIDI_PERCUSSION_PRESET_OFFSET;
+        options.myStrongAccentVel =
+            settings->get(Settings::MetronomeStrongAccent);
+        options.myWeakAccentVel = settings->get(Settings::MetronomeWeakAccent);
+        options.myVibratoStrength = settings->get(Settings::MidiVibratoLevel);
+        options.myWideVibratoStrength =
+            settings->get(Settings::MidiWideVibratoLevel);
+        options.myControllerResolution =
+            settings->get(Settings::MidiControllerResolution);
+    }
+
+    MidiFile file;
+    file.load(score, options);
+
+    // The sizes are filled in once all of the samples have been written.
+    writeHeader(os, 0);
+
+    uint32_t data_size = 0;
+    std::vector<char> bytes;
+    Synthesizer synth(SAMPLE_RATE);
+    synth.render(file, [&](const float *samples, size_t frames) {
+        const size_t count = frames * Synthesizer::NUM_OUTPUT_CHANNELS;
+        bytes.resize(count * 2);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const int16_t sample = static_cast<int16_t>(samples[i] * 32767);
+            bytes[2 * i] = static_cast<char>(sample & 0xff);
+            bytes[2 * i + 1] = static_cast<char>((sample >> 8) & 0xff);
+        }
+
+        os.write(bytes.data(), bytes.size());
+        data_size += static_cast<uint32_t>(bytes.size());
+    });
+
+    os.seekp(0);
+    writeHeader(os, data_size);
+}
@@ -1,5 +1,5 @@
 /*
-  * Copyright (C) 2014 Cameron White
+  * Copyright (C) 2016 Cameron White
   *
   * This program is free software: you can redistribute it and/or modify
   * it under the terms of the GNU General Public License as published by
@@ -14,26 +14,24 @@
   * You should have received a copy of the GNU General Public License
   * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
-  
-#ifndef PAINTERS_CLICKABLEGROUP_H
-#define PAINTERS_CLICKABLEGROUP_H
 
-#include <functional>
-#include <QGraphicsItemGroup>
+#ifndef FORMATS_WAVEXPORTER_H
+#define FORMATS_WAVEXPORTER_H
 
-class ClickableGroup : public QGraphicsItemGroup
+#include <formats/fileformatmanager.h>
+
+/// Renders the score to audio with the built-in synthesizer, and writes a
+/// 16-bit stereo WAV file. This is faster than real time and doesn't need any
+/// audio hardware.
+class WavExporter : public FileFormatExporter
 {
 public:
-    typedef std::function<void()> Callback;
-    ClickableGroup(const QString &tooltip, const Callback &callback);
+    WavExporter(const SettingsManager &settings_manager);
 
-    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
-    virtual void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
+    virtual void save(const std::string &filename, const Score &score) override;
 
 private:
-    Callback myCallback;
+    const SettingsManager &mySettingsManager;
 };
 
 #endif
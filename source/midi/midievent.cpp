@@ -17,7 +17,9 @@
   
 #include "midievent.h"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 enum Controller : uint8_t
 {
@@ -32,6 +34,7 @@ enum Controller : uint8_t
 
 enum MetaType : uint8_t
 {
+    TrackName = 0x03,
     TrackEnd = 0x2f,
     SetTempo = 0x51
 };
@@ -41,14 +44,73 @@ static const uint8_t theSysExManufacturerId = 0x7d;
 static const uint8_t theChannelMask = 0x0f;
 static const uint8_t theStatusByteMask = ~theChannelMask;
 
-MidiEvent::MidiEvent(int ticks, std::vector<uint8_t> data,
+MidiEvent::MidiEvent(int ticks, std::initializer_list<uint8_t> data,
+                     const SystemLocation &location, int player, int instrument)
+    : MidiEvent(ticks, data.begin(), data.size(), location, player, instrument)
+{
+}
+
+MidiEvent::MidiEvent(int ticks, const uint8_t *data, size_t size,
                      const SystemLocation &location, int player, int instrument)
     : myTicks(ticks),
-      myData(std::move(data)),
       myLocation(location),
       myPlayer(player),
-      myInstrument(instrument)
+      myInstrument(instrument),
+      mySize(static_cast<uint32_t>(size))
+{
+    assert(size > 0);
+
+    if (size <= MAX_INLINE_SIZE)
+    {
+        myInlineData.fill(0);
+        std::copy(data, data + size, myInlineData.begin());
+    }
+    else
+    {
+        myExtendedData = new uint8_t[size];
+        std::copy(data, data + size, myExtendedData);
+    }
+}
+
+MidiEvent::MidiEvent(const MidiEvent &other)
+    : MidiEvent(other.myTicks, other.getData(), other.mySize,
+                other.myLocation, other.myPlayer, other.myInstrument)
+{
+}
+
+MidiEvent::MidiEvent(MidiEvent &&other) BOOST_NOEXCEPT
+    : myTicks(other.myTicks),
+      myLocation(other.myLocation),
+      myPlayer(other.myPlayer),
+      myInstrument(other.myInstrument),
+      mySize(other.mySize),
+      myInlineData(other.myInlineData)
 {
+    // Take ownership of any heap storage, and leave the other event with an
+    // empty inline message.
+    other.mySize = 0;
+}
+
+MidiEvent &MidiEvent::operator=(MidiEvent other)
+{
+    swap(other);
+    return *this;
+}
+
+MidiEvent::~MidiEvent()
+{
+    if (mySize > MAX_INLINE_SIZE)
+        delete[] myExtendedData;
+}
+
+void MidiEvent::swap(MidiEvent &other) BOOST_NOEXCEPT
+{
+    std::swap(myTicks, other.myTicks);
+    std::swap(myLocation, other.myLocation);
+    std::swap(myPlayer, other.myPlayer);
+    std::swap(myInstrument, other.myInstrument);
+    std::swap(mySize, other.mySize);
+    std::swap(myInlineData, other.myInlineData);
 }
 
 MidiEvent MidiEvent::endOfTrack(int ticks)
@@ -57,17 +119,22 @@ MidiEvent MidiEvent::endOfTrack(int ticks)
                      SystemLocation(), -1, -1);
 }
 
+bool MidiEvent::isMetaMessage() const
+{
+    return getStatusByte() == StatusByte::MetaMessage;
+}
+
 bool MidiEvent::isTempoChange() const
 {
-    return getStatusByte() == StatusByte::MetaMessage &&
-           myData[1] == MetaType::SetTempo;
+    return isMetaMessage() && getData()[1] == MetaType::SetTempo;
 }
 
 int MidiEvent::getTempo() const
 {
     assert(isTempoChange());
-    assert(myData[2] == 3);
-    return myData[5] + (myData[4] << 8) + (myData[3] << 16);
+    const uint8_t *data = getData();
+    assert(data[2] == 3);
+    return data[5] + (data[4] << 8) + (data[3] << 16);
 }
 
 bool MidiEvent::isProgramChange() const
@@ -75,6 +142,19 @@ bool MidiEvent::isProgramChange() const
     return (getStatusByte() & theStatusByteMask) == StatusByte::ProgramChange;
 }
 
+bool MidiEvent::isVolumeChange() const
+{
+    return (getStatusByte() & theStatusByteMask) ==
+               StatusByte::ControlChange &&
+           getData()[1] == Controller::ChannelVolume;
+}
+
+uint8_t MidiEvent::getVolume() const
+{
+    assert(isVolumeChange());
+    return getData()[2];
+}
+
 MidiEvent MidiEvent::setTempo(int ticks, int microseconds)
 {
     const uint32_t val = microseconds;
@@ -155,7 +235,7 @@ MidiEvent MidiEvent::positionChange(int ticks, const SystemLocation &location)
 bool MidiEvent::isPositionChange() const
 {
     return getStatusByte() == StatusByte::SysEx &&
-           myData[1] == theSysExManufacturerId;
+           getData()[1] == theSysExManufacturerId;
 }
 
 bool MidiEvent::isNoteOnOff() const
@@ -164,15 +244,43 @@ bool MidiEvent::isNoteOnOff() const
            (getStatusByte() & theStatusByteMask) == StatusByte::NoteOff;
 }
 
+bool MidiEvent::isNoteOn() const
+{
+    return (getStatusByte() & theStatusByteMask) == StatusByte::NoteOn;
+}
+
+bool MidiEvent::isControllerValue() const
+{
+    switch (getStatusByte() & theStatusByteMask)
+    {
+        case StatusByte::PitchWheel:
+            return true;
+        case StatusByte::ControlChange:
+            switch (getData()[1])
+            {
+                case Controller::DataEntryCoarse:
+                case Controller::DataEntryFine:
+                case Controller::RpnLsb:
+                case Controller::RpnMsb:
+                    return false;
+                default:
+                    return true;
+            }
+        default:
+            return false;
+    }
+}
+
 uint8_t MidiEvent::getChannel() const
 {
     return getStatusByte() & theChannelMask;
 }
 
-std::vector<MidiEvent> MidiEvent::pitchWheelRange(int ticks, uint8_t channel,
-                                                  uint8_t semitones)
+std::array<MidiEvent, 4> MidiEvent::pitchWheelRange(int ticks,
+                                                    uint8_t channel,
+                                                    uint8_t semitones)
 {
-    return {
+    return {{
         MidiEvent(ticks,
                   { static_cast<uint8_t>(StatusByte::ControlChange + channel),
                     Controller::RpnMsb, 0 },
@@ -189,5 +297,26 @@ std::vector<MidiEvent> MidiEvent::pitchWheelRange(int ticks, uint8_t channel,
                   { static_cast<uint8_t>(StatusByte::ControlChange + channel),
                     Controller::DataEntryFine, 0 },
                   SystemLocation(), -1, -1),
-    };
+    }};
+}
+
+MidiEvent MidiEvent::trackName(int ticks, const std::string &name)
+{
+    std::vector<uint8_t> data = { StatusByte::MetaMessage,
+                                  MetaType::TrackName };
+
+    // The length is stored as a variable-length quantity, with the most
+    // significant bits first.
+    const uint32_t length = static_cast<uint32_t>(name.size());
+    for (int shift = 21; shift > 0; shift -= 7)
+    {
+        if (length >> shift)
+            data.push_back(((length >> shift) & 0x7f) | 0x80);
+    }
+    data.push_back(length & 0x7f);
+
+    data.insert(data.end(), name.begin(), name.end());
+
+    return MidiEvent(ticks, data.data(), data.size(), SystemLocation(), -1,
+                     -1);
 }
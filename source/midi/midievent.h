@@ -20,9 +20,16 @@
 
 #include <score/systemlocation.h>
 
+#include <array>
+#include <boost/config.hpp>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <initializer_list>
+#include <string>
 
+/// A MIDI message and its timestamp. The bytes of short messages are stored
+/// inline, so that creating or copying an event doesn't allocate. Only long
+/// SysEx or meta messages are stored on the heap.
 class MidiEvent
 {
 public:
@@ -37,6 +44,16 @@ public:
         MetaMessage = 0xff
     };
 
+    /// The largest message that is stored inline (e.g. a tempo change).
+    static const size_t MAX_INLINE_SIZE = 8;
+
+    MidiEvent(const MidiEvent &other);
+    /// Doesn't throw, so that std::vector moves the events rather than
+    /// copying them when it grows.
+    MidiEvent(MidiEvent &&other) BOOST_NOEXCEPT;
+    MidiEvent &operator=(MidiEvent other);
+    ~MidiEvent();
+
     inline bool operator<(const MidiEvent &other) const
     {
         return myTicks < other.myTicks;
@@ -44,15 +61,31 @@ public:
 
     int getTicks() const { return myTicks; }
     void setTicks(int ticks) { myTicks = ticks; }
-    uint8_t getStatusByte() const { return myData[0]; }
-    const std::vector<uint8_t> &getData() const { return myData; }
+    uint8_t getStatusByte() const { return getData()[0]; }
+    /// Returns the bytes of the message.
+    const uint8_t *getData() const
+    {
+        return mySize <= MAX_INLINE_SIZE ? myInlineData.data()
+                                         : myExtendedData;
+    }
+    size_t getDataSize() const { return mySize; }
     const SystemLocation &getLocation() const { return myLocation; }
 
+    bool isMetaMessage() const;
     bool isTempoChange() const;
     int getTempo() const;
     bool isProgramChange() const;
+    bool isVolumeChange() const;
+    /// Returns the level of a channel volume change.
+    uint8_t getVolume() const;
     bool isPositionChange() const;
     bool isNoteOnOff() const;
+    /// Returns whether the event sets a controller value (e.g. the pitch
+    /// wheel or mod wheel) that only depends on the most recent event for
+    /// that controller. This excludes the parameter number and data entry
+    /// controllers, which depend on the events around them.
+    bool isControllerValue() const;
+    bool isNoteOn() const;
     uint8_t getChannel() const;
 
     static MidiEvent endOfTrack(int ticks);
@@ -67,19 +100,31 @@ public:
     static MidiEvent holdPedal(int ticks, uint8_t channel, bool enabled);
     static MidiEvent pitchWheel(int ticks, uint8_t channel, uint8_t amount);
     static MidiEvent positionChange(int ticks, const SystemLocation &location);
-    static std::vector<MidiEvent> pitchWheelRange(int ticks, uint8_t channel,
-                                                  uint8_t semitones);
+    static std::array<MidiEvent, 4> pitchWheelRange(int ticks, uint8_t channel,
+                                                    uint8_t semitones);
+    /// The name may be longer than the inline storage.
+    static MidiEvent trackName(int ticks, const std::string &name);
 
 private:
-    MidiEvent(int ticks, std::vector<uint8_t> data,
+    MidiEvent(int ticks, std::initializer_list<uint8_t> data,
+              const SystemLocation &location, int player, int instrument);
+    MidiEvent(int ticks, const uint8_t *data, size_t size,
               const SystemLocation &location, int player, int instrument);
 
-    int myTicks; // TODO - does this need to be 64-bit for absolute times?
-    std::vector<uint8_t> myData;
+    void swap(MidiEvent &other) BOOST_NOEXCEPT;
 
+    int myTicks; // TODO - does this need to be 64-bit for absolute times?
     SystemLocation myLocation;
     int myPlayer;
     int myInstrument;
+
+    uint32_t mySize;
+    union
+    {
+        std::array<uint8_t, MAX_INLINE_SIZE> myInlineData;
+        /// Owned copy of a message that doesn't fit in the inline storage.
+        uint8_t *myExtendedData;
+    };
 };
 
 #endif
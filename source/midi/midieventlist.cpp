@@ -34,12 +34,8 @@ void MidiEventList::convertToDeltaTicks()
         return;
 
     // First, sort by timestamp. Events for different voices may have been added
-    // out of order.
-    std::stable_sort(myEvents.begin(), myEvents.end(),
-                     [](const MidiEvent &a, const MidiEvent &b)
-                     {
-                         return a.getTicks() < b.getTicks();
-                     });
+    // out of order, but the events are usually sorted already.
+    sort();
 
     for (size_t i = myEvents.size() - 1; i >= 1; --i)
     {
@@ -67,3 +63,19 @@ void MidiEventList::concat(const MidiEventList &other)
     myEvents.insert(myEvents.end(), other.myEvents.begin(),
                     other.myEvents.end());
 }
+
+void MidiEventList::sort()
+{
+    if (!std::is_sorted(myEvents.begin(), myEvents.end()))
+        std::stable_sort(myEvents.begin(), myEvents.end());
+}
+
+void MidiEventList::merge(const MidiEventList &other)
+{
+    assert(myAbsoluteTicks && other.myAbsoluteTicks);
+
+    const size_t middle = myEvents.size();
+    concat(other);
+    std::inplace_merge(myEvents.begin(), myEvents.begin() + middle,
+                       myEvents.end());
+}
@@ -19,6 +19,7 @@
 #define MIDI_MIDIEVENTLIST_H
 
 #include <midi/midievent.h>
+#include <utility>
 #include <vector>
 
 class MidiEventList
@@ -34,10 +35,21 @@ public:
     void append(const MidiEvent &event) { myEvents.push_back(event); }
     void append(MidiEvent &&event)
     {
-        myEvents.push_back(std::forward<MidiEvent>(event));
+        myEvents.push_back(std::move(event));
     }
 
     void concat(const MidiEventList &other);
+    /// Sorts the events by their ticks. Simultaneous events keep their order.
+    void sort();
+    /// Merges the events from another list, where both lists are sorted and
+    /// use absolute ticks. Events with the same timestamp keep their order,
+    /// with the events from this list first.
+    void merge(const MidiEventList &other);
+
+    size_t size() const { return myEvents.size(); }
+    void reserve(size_t size) { myEvents.reserve(size); }
+    bool empty() const { return myEvents.empty(); }
+    void clear() { myEvents.clear(); }
 
     typedef std::vector<MidiEvent>::iterator iterator;
     typedef std::vector<MidiEvent>::const_iterator const_iterator;
@@ -47,6 +59,11 @@ public:
     const_iterator begin() const { return myEvents.begin(); }
     const_iterator end() const { return myEvents.end(); }
 
+    iterator erase(iterator first, iterator last)
+    {
+        return myEvents.erase(first, last);
+    }
+
 private:
     std::vector<MidiEvent> myEvents;
     bool myAbsoluteTicks;
@@ -19,31 +19,39 @@
 
 #include "repeatcontroller.h"
 
-#include <boost/rational.hpp>
-
+#include <algorithm>
+#include <boost/config.hpp>
+#include <map>
 #include <score/generalmidi.h>
 #include <score/score.h>
 #include <score/scorelocation.h>
 #include <score/systemlocation.h>
+#include <score/ticks.h>
 #include <score/utils.h>
+#include <score/voicetimeline.h>
 #include <score/voiceutils.h>
+#include <set>
+#include <util/parallelfor.h>
 
 static const int PERCUSSION_CHANNEL = 9;
 static const int METRONOME_CHANNEL = PERCUSSION_CHANNEL;
-static const int DEFAULT_PPQ = 480;
 
 static const int PITCH_BEND_RANGE = 24;
 static const int DEFAULT_BEND = 64;
 static const int SLIDE_OUT_STEPS = 5;
 
-/// Pitch bend amount to bend a note by a quarter tone.
-static const boost::rational<int> BEND_QUARTER_TONE(
-    (Midi::MAX_MIDI_CHANNEL_EFFECT_LEVEL - DEFAULT_BEND), 2 * PITCH_BEND_RANGE);
+/// Returns the pitch bend amount to bend a note by the given number of
+/// quarter tones.
+static BOOST_CONSTEXPR int getBendAmount(int quarter_tones)
+{
+    return (DEFAULT_BEND * 2 * PITCH_BEND_RANGE +
+            quarter_tones *
+                (Midi::MAX_MIDI_CHANNEL_EFFECT_LEVEL - DEFAULT_BEND)) /
+           (2 * PITCH_BEND_RANGE);
+}
 
-static const int SLIDE_BELOW_BEND = boost::rational_cast<int>(
-    DEFAULT_BEND - SLIDE_OUT_STEPS * 2 * BEND_QUARTER_TONE);
-static const int SLIDE_ABOVE_BEND = boost::rational_cast<int>(
-    DEFAULT_BEND + SLIDE_OUT_STEPS * 2 * BEND_QUARTER_TONE);
+static const int SLIDE_BELOW_BEND = getBendAmount(-SLIDE_OUT_STEPS * 2);
+static const int SLIDE_ABOVE_BEND = getBendAmount(SLIDE_OUT_STEPS * 2);
 
 enum Velocity : uint8_t
 {
@@ -53,16 +61,20 @@ enum Velocity : uint8_t
     PalmMutedVelocity = 112
 };
 
-/// Returns the MIDI channel that should be used for the player.
-/// Since channel 10 is reserved for percussion, we can't use that
-/// channel for regular instruments.
-static int getChannel(int player)
+int MidiFile::getPlayerChannel(int player)
 {
+    // Since channel 10 is reserved for percussion, we can't use that channel
+    // for regular instruments.
     if (player >= PERCUSSION_CHANNEL)
         player++;
     return player;
 }
 
+static int getChannel(int player)
+{
+    return MidiFile::getPlayerChannel(player);
+}
+
 static int getChannel(const ActivePlayer &player)
 {
     return getChannel(player.getPlayerNumber());
@@ -125,106 +137,422 @@ static SystemLocation moveToNextBar(MidiEventList &event_list, int ticks,
     return location;
 }
 
+/// Returns the repeated section that contains the bar starting at the given
+/// location, if there is one.
+static const RepeatedSection *
+findRepeatedSection(const RepeatController &repeat_controller,
+                    const SystemLocation &bar_start)
+{
+    const RepeatedSection *section = repeat_controller.findRepeat(bar_start);
+
+    // The bar that starts at the section's last end bar follows the section.
+    if (section && section->getLastEndBarLocation() == bar_start)
+        return nullptr;
+
+    return section;
+}
+
 MidiFile::MidiFile() : myTicksPerBeat(0)
 {
 }
 
 void MidiFile::load(const Score &score, const LoadOptions &options)
 {
-    myTicksPerBeat = DEFAULT_PPQ;
-
-    RepeatController repeat_controller(score);
+    MidiEventGenerator generator(score, options);
+    myTicksPerBeat = generator.getTicksPerBeat();
 
     MidiEventList master_track;
     MidiEventList metronome_track;
-
-    // Set the initial channel volume and pitch bend range..
     std::vector<MidiEventList> regular_tracks(score.getPlayers().size());
-    for (unsigned int i = 0; i < score.getPlayers().size(); ++i)
+
+    generator.generateRemainingBars(master_track, regular_tracks,
+                                    metronome_track);
+
+    myTracks.push_back(std::move(master_track));
+    for (MidiEventList &track : regular_tracks)
+        myTracks.push_back(std::move(track));
+    if (options.myEnableMetronome)
+        myTracks.push_back(std::move(metronome_track));
+
+    for (MidiEventList &track : myTracks)
     {
-        regular_tracks[i].append(
+        track.append(MidiEvent::endOfTrack(generator.getCurrentTick()));
+        track.convertToDeltaTicks();
+    }
+}
+
+MidiEventGenerator::MidiEventGenerator(const Score &score,
+                                       const MidiFile::LoadOptions &options,
+                                       bool cache_bars)
+    : myScore(score),
+      myOptions(options),
+      myTicksPerBeat(Ticks::MIDI_PER_QUARTER),
+      myCacheBars(cache_bars),
+      myRepeatController(score),
+      myStarted(false),
+      myLocation(0, 0),
+      mySystemIndex(-1),
+      myCurrentTick(0),
+      myCurrentTempo(Midi::BEAT_DURATION_120_BPM)
+{
+}
+
+bool MidiEventGenerator::isFinished() const
+{
+    return myLocation.getSystem() >=
+           static_cast<int>(myScore.getSystems().size());
+}
+
+void MidiEventGenerator::start(std::vector<MidiEventList> &player_tracks)
+{
+    if (myStarted)
+        return;
+
+    // Set the initial channel volume and pitch bend range for each player.
+    for (unsigned int i = 0; i < myScore.getPlayers().size(); ++i)
+    {
+        player_tracks[i].append(
             MidiEvent::volumeChange(0, getChannel(i), Dynamic::fff));
 
         for (const MidiEvent &event :
              MidiEvent::pitchWheelRange(0, getChannel(i), PITCH_BEND_RANGE))
         {
-            regular_tracks[i].append(event);
+            player_tracks[i].append(event);
         }
+    }
+
+    myStarted = true;
+}
+
+bool MidiEventGenerator::generateNextBar(
+    MidiEventList &master_track, std::vector<MidiEventList> &player_tracks,
+    MidiEventList &metronome_track)
+{
+    start(player_tracks);
 
+    if (isFinished())
+        return false;
+
+    if (myLocation.getSystem() != mySystemIndex)
+    {
+        const System &system = myScore.getSystems()[myLocation.getSystem()];
+        myActiveBends.resize(system.getStaves().size(), DEFAULT_BEND);
+        mySystemIndex = myLocation.getSystem();
     }
 
-    SystemLocation location(0, 0);
-    std::vector<uint8_t> active_bends;
-    int system_index = -1;
-    int current_tick = 0;
-    int current_tempo = Midi::BEAT_DURATION_120_BPM;
+    const BarInfo bar = resolveNextBar(master_track, metronome_track);
 
-    while (location.getSystem() < score.getSystems().size())
+    // Only the bars in a repeated section are worth caching, since they are
+    // played more than once.
+    const RepeatedSection *section = findRepeatedSection(
+        myRepeatController, SystemLocation(bar.mySystemIndex, bar.myStart));
+    BarEventCache *cache = (myCacheBars && section) ? &myBarCache : nullptr;
+
+    for (unsigned int staff_index = 0; staff_index < myActiveBends.size();
+         ++staff_index)
+    {
+        addEventsForStaff(player_tracks, myActiveBends[staff_index], bar,
+                          staff_index, cache);
+    }
+
+    // The repeats can't return to the cached bars once playback leaves their
+    // section.
+    if (!myBarCache.empty() &&
+        findRepeatedSection(myRepeatController, myLocation) != section)
+    {
+        myBarCache.clear();
+    }
+
+    return true;
+}
+
+void MidiEventGenerator::generateRemainingBars(
+    MidiEventList &master_track, std::vector<MidiEventList> &player_tracks,
+    MidiEventList &metronome_track)
+{
+    start(player_tracks);
+
+    // Resolving the bar sequence is cheap compared to generating the notes,
+    // and gives the start tick and tempo for each bar.
+    std::vector<BarInfo> bars;
+    while (!isFinished())
+        bars.push_back(resolveNextBar(master_track, metronome_track));
+
+    size_t num_staves = 0;
+    for (const BarInfo &bar : bars)
+    {
+        num_staves = std::max(
+            num_staves,
+            myScore.getSystems()[bar.mySystemIndex].getStaves().size());
+    }
+
+    // Only the bars that are played more than once (e.g. due to repeats) are
+    // worth caching.
+    std::map<std::pair<int, int>, int> play_counts;
+    for (const BarInfo &bar : bars)
+        ++play_counts[std::make_pair(bar.mySystemIndex, bar.myStart)];
+
+    // Look up the play counts up front, since the map isn't safe to index
+    // from the worker threads.
+    std::vector<bool> repeated(bars.size());
+    for (size_t i = 0; i < bars.size(); ++i)
     {
-        const System &system = score.getSystems()[location.getSystem()];
-        const Barline *current_bar = ScoreUtils::findByPosition(
-            system.getBarlines(), location.getPosition());
-        const Barline *next_bar = system.getNextBarline(location.getPosition());
+        repeated[i] = myCacheBars &&
+                      play_counts[std::make_pair(bars[i].mySystemIndex,
+                                                 bars[i].myStart)] > 1;
+    }
+
+    // Generate each staff separately. The pitch bend state only carries over
+    // between bars of the same staff, so the staves are independent.
+    const size_t num_players = player_tracks.size();
+    std::vector<std::vector<MidiEventList>> staff_tracks(num_staves);
+    // The number of events in each player's track at the end of each bar.
+    std::vector<std::vector<size_t>> staff_bar_ends(num_staves);
+
+    parallelFor(static_cast<int>(num_staves), [&](int staff_index) {
+        std::vector<MidiEventList> &tracks = staff_tracks[staff_index];
+        std::vector<size_t> &bar_ends = staff_bar_ends[staff_index];
+        tracks.resize(num_players);
+        bar_ends.reserve(bars.size() * num_players);
+
+        uint8_t active_bend =
+            (staff_index < static_cast<int>(myActiveBends.size()))
+                ? myActiveBends[staff_index]
+                : DEFAULT_BEND;
 
-        if (location.getSystem() != system_index)
+        BarEventCache cache;
+
+        for (size_t i = 0; i < bars.size(); ++i)
         {
-            active_bends.resize(system.getStaves().size(), DEFAULT_BEND);
-            system_index = location.getSystem();
+            const BarInfo &bar = bars[i];
+            const System &system = myScore.getSystems()[bar.mySystemIndex];
+            if (staff_index < static_cast<int>(system.getStaves().size()))
+            {
+                addEventsForStaff(tracks, active_bend, bar, staff_index,
+                                  repeated[i] ? &cache : nullptr);
+            }
+            else
+                active_bend = DEFAULT_BEND;
+
+            for (const MidiEventList &track : tracks)
+                bar_ends.push_back(track.size());
         }
+    });
 
-        const int start_tick = current_tick;
-        current_tempo =
-            addTempoEvent(master_track, start_tick, current_tempo, system,
-                          current_bar->getPosition(), next_bar->getPosition());
+    // Merge the staves in the same order that the events would have been
+    // generated one bar at a time, so that simultaneous events for a player
+    // keep their order.
+    for (size_t player = 0; player < num_players; ++player)
+    {
+        size_t num_events = player_tracks[player].size();
+        for (const std::vector<MidiEventList> &tracks : staff_tracks)
+            num_events += tracks[player].size();
+        player_tracks[player].reserve(num_events);
 
-        for (unsigned int staff_index = 0; staff_index < system.getStaves().size();
-             ++staff_index)
+        for (size_t bar = 0; bar < bars.size(); ++bar)
         {
-            const Staff &staff = system.getStaves()[staff_index];
-
-            for (unsigned int voice_index = 0; voice_index < staff.getVoices().size();
-                 ++voice_index)
+            for (size_t staff = 0; staff < num_staves; ++staff)
             {
-                const int end_tick = addEventsForBar(
-                    regular_tracks, active_bends[staff_index], start_tick,
-                    current_tempo, score, system, location.getSystem(), staff,
-                    staff_index, staff.getVoices()[voice_index], voice_index,
-                    current_bar->getPosition(), next_bar->getPosition(),
-                    options);
-
-                current_tick = std::max(current_tick, end_tick);
+                MidiEventList &track = staff_tracks[staff][player];
+                const std::vector<size_t> &bar_ends = staff_bar_ends[staff];
+                const size_t end = bar_ends[bar * num_players + player];
+                const size_t begin =
+                    bar ? bar_ends[(bar - 1) * num_players + player] : 0;
+
+                for (auto it = track.begin() + begin;
+                     it != track.begin() + end; ++it)
+                {
+                    player_tracks[player].append(std::move(*it));
+                }
             }
         }
+    }
+}
+
+MidiEventGenerator::BarInfo MidiEventGenerator::resolveNextBar(
+    MidiEventList &master_track, MidiEventList &metronome_track)
+{
+    const System &system = myScore.getSystems()[myLocation.getSystem()];
+    const Barline *current_bar = ScoreUtils::findByPosition(
+        system.getBarlines(), myLocation.getPosition());
+    const Barline *next_bar = system.getNextBarline(myLocation.getPosition());
+
+    BarInfo bar;
+    bar.mySystemIndex = myLocation.getSystem();
+    bar.myStart = current_bar->getPosition();
+    bar.myEnd = next_bar->getPosition();
+    bar.myStartTick = myCurrentTick;
+
+    myCurrentTempo = addTempoEvent(master_track, bar.myStartTick,
+                                   myCurrentTempo, system, bar.myStart,
+                                   bar.myEnd);
+    bar.myTempo = myCurrentTempo;
+
+    // Generate metronome events.
+    myCurrentTick = std::max(
+        getBarEndTick(system, bar.myStartTick, bar.myStart, bar.myEnd),
+        generateMetronome(metronome_track, bar.myStartTick, system,
+                          *current_bar, *next_bar, myLocation, myOptions));
+
+    myLocation = moveToNextBar(
+        metronome_track, myCurrentTick, myOptions.myRecordPositionChanges,
+        system, myLocation, bar.myEnd, myRepeatController);
+
+    return bar;
+}
+
+/// Returns a key for the channel and controller of a controller event, along
+/// with its value.
+static std::pair<int, int> getControllerValue(const MidiEvent &event)
+{
+    const uint8_t status = event.getStatusByte();
+    const uint8_t *data = event.getData();
 
-        // Generate metronome events.
-        current_tick = std::max(
-            current_tick,
-            generateMetronome(metronome_track, start_tick, system, *current_bar,
-                              *next_bar, location, options));
+    if ((status & 0xf0) == MidiEvent::PitchWheel)
+        return std::make_pair(status << 8, data[1] | data[2] << 7);
+    else
+        return std::make_pair(status << 8 | data[1], data[2]);
+}
 
-        location = moveToNextBar(
-            metronome_track, current_tick, options.myRecordPositionChanges,
-            system, location, next_bar->getPosition(), repeat_controller);
+/// Removes controller events from the end of the track (starting at the given
+/// index) that don't change the controller's value, or that are replaced by
+/// another event for the same controller at the same tick. This avoids
+/// sending many identical pitch wheel events for chords with slides or bends,
+/// for example.
+static void removeRedundantControllers(MidiEventList &track, size_t begin)
+{
+    // The events aren't necessarily sorted yet, so visit the controller
+    // events in the order that they will be played.
+    std::vector<size_t> indices;
+    for (size_t i = begin; i < track.size(); ++i)
+    {
+        if ((track.begin() + i)->isControllerValue())
+            indices.push_back(i);
     }
 
-    myTracks.push_back(master_track);
-    myTracks.insert(myTracks.end(), regular_tracks.begin(), regular_tracks.end());
-    if (options.myEnableMetronome)
-        myTracks.push_back(metronome_track);
+    if (indices.size() <= 1)
+        return;
 
-    for (MidiEventList &track : myTracks)
+    auto getEvent = [&](size_t i) -> const MidiEvent & {
+        return *(track.begin() + i);
+    };
+    std::stable_sort(indices.begin(), indices.end(), [&](size_t i, size_t j) {
+        return getEvent(i).getTicks() < getEvent(j).getTicks();
+    });
+
+    std::vector<bool> redundant(track.size() - begin, false);
+
+    // Only the last event for a controller at each tick has an effect.
+    std::set<int> replaced;
+    for (size_t i = indices.size(); i-- > 0;)
     {
-        track.append(MidiEvent::endOfTrack(current_tick));
-        track.convertToDeltaTicks();
+        if (i + 1 < indices.size() && getEvent(indices[i]).getTicks() !=
+                                          getEvent(indices[i + 1]).getTicks())
+        {
+            replaced.clear();
+        }
+
+        const int key = getControllerValue(getEvent(indices[i])).first;
+        if (!replaced.insert(key).second)
+            redundant[indices[i] - begin] = true;
+    }
+
+    std::map<int, int> values;
+    for (size_t i : indices)
+    {
+        if (redundant[i - begin])
+            continue;
+
+        const std::pair<int, int> value = getControllerValue(getEvent(i));
+        auto it = values.find(value.first);
+        if (it != values.end() && it->second == value.second)
+            redundant[i - begin] = true;
+        else
+            values[value.first] = value.second;
+    }
+
+    size_t index = 0;
+    track.erase(std::remove_if(track.begin() + begin, track.end(),
+                               [&](const MidiEvent &) {
+                                   return redundant[index++];
+                               }),
+                track.end());
+}
+
+void MidiEventGenerator::addEventsForStaff(std::vector<MidiEventList> &tracks,
+                                           uint8_t &active_bend,
+                                           const BarInfo &bar, int staff_index,
+                                           BarEventCache *cache) const
+{
+    const System &system = myScore.getSystems()[bar.mySystemIndex];
+    const Staff &staff = system.getStaves()[staff_index];
+
+    if (!cache)
+    {
+        std::vector<size_t> begin;
+        for (const MidiEventList &track : tracks)
+            begin.push_back(track.size());
+
+        for (unsigned int voice_index = 0;
+             voice_index < staff.getVoices().size(); ++voice_index)
+        {
+            addEventsForBar(tracks, active_bend, bar.myStartTick, bar.myTempo,
+                            myScore, system, bar.mySystemIndex, staff,
+                            staff_index, staff.getVoices()[voice_index],
+                            voice_index, bar.myStart, bar.myEnd, myOptions);
+        }
+
+        for (size_t i = 0; i < tracks.size(); ++i)
+            removeRedundantControllers(tracks[i], begin[i]);
+
+        return;
+    }
+
+    // The events only depend on the absolute tick through an offset, so
+    // generate them relative to the start of the bar and then shift them into
+    // place for each pass through the bar.
+    const auto key = std::make_tuple(bar.mySystemIndex, staff_index,
+                                     bar.myStart, bar.myTempo, active_bend);
+    auto it = cache->find(key);
+    if (it == cache->end())
+    {
+        BarEvents events;
+        events.myTracks.resize(tracks.size());
+        events.myFinalBend = active_bend;
+
+        for (unsigned int voice_index = 0;
+             voice_index < staff.getVoices().size(); ++voice_index)
+        {
+            addEventsForBar(events.myTracks, events.myFinalBend, 0,
+                            bar.myTempo, myScore, system, bar.mySystemIndex,
+                            staff, staff_index, staff.getVoices()[voice_index],
+                            voice_index, bar.myStart, bar.myEnd, myOptions);
+        }
+
+        for (MidiEventList &track : events.myTracks)
+            removeRedundantControllers(track, 0);
+
+        it = cache->emplace(key, std::move(events)).first;
+    }
+
+    const BarEvents &events = it->second;
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        for (const MidiEvent &event : events.myTracks[i])
+        {
+            MidiEvent copy(event);
+            copy.setTicks(bar.myStartTick + event.getTicks());
+            tracks[i].append(std::move(copy));
+        }
     }
+
+    active_bend = events.myFinalBend;
 }
 
-int MidiFile::generateMetronome(MidiEventList &event_list, int current_tick,
-                                const System &system,
-                                const Barline &current_bar,
-                                const Barline &next_bar,
-                                const SystemLocation &location,
-                                const LoadOptions &options)
+int MidiEventGenerator::generateMetronome(
+    MidiEventList &event_list, int current_tick, const System &system,
+    const Barline &current_bar, const Barline &next_bar,
+    const SystemLocation &location, const MidiFile::LoadOptions &options)
 {
     const TimeSignature &time_sig = current_bar.getTimeSignature();
 
@@ -233,9 +561,8 @@ int MidiFile::generateMetronome(MidiEventList &event_list, int current_tick,
     const int beat_value = time_sig.getBeatValue();
 
     // Figure out the duration of a pulse.
-    const int duration = boost::rational_cast<int>(
-        boost::rational<int>(4, beat_value) *
-        boost::rational<int>(beats_per_measure, num_pulses) * myTicksPerBeat);
+    const int duration = 4 * beats_per_measure * myTicksPerBeat /
+                         (beat_value * num_pulses);
 
     // Check for multi-bar rests, as we need to generate more metronome events
     // to fill the extra bars.
@@ -279,9 +606,10 @@ int MidiFile::generateMetronome(MidiEventList &event_list, int current_tick,
     return current_tick;
 }
 
-int MidiFile::addTempoEvent(MidiEventList &event_list, int current_tick,
-                            int current_tempo, const System &system,
-                            int bar_start, int bar_end)
+int MidiEventGenerator::addTempoEvent(MidiEventList &event_list,
+                                      int current_tick, int current_tempo,
+                                      const System &system, int bar_start,
+                                      int bar_end)
 {
     auto markers = ScoreUtils::findInRange(system.getTempoMarkers(), bar_start,
                                            bar_end - 1);
@@ -290,15 +618,18 @@ int MidiFile::addTempoEvent(MidiEventList &event_list, int current_tick,
     {
         const TempoMarker &marker = markers.back();
 
-        // Convert the values in the TempoMarker::BeatType enum to a factor that
-        // will scale the bpm value to be in terms of quarter notes.
-        boost::rational<int> scale(2, 1 << (marker.getBeatType() / 2));
+        // The values in the TempoMarker::BeatType enum give the length of a
+        // beat, which is 2 / 2^(type / 2) quarter notes (dotted if the type is
+        // odd). Compute the number of microseconds per quarter note.
+        int64_t numerator = 60000000LL << (marker.getBeatType() / 2);
+        int64_t denominator = 2 * marker.getBeatsPerMinute();
         if (marker.getBeatType() % 2 != 0)
-            scale *= boost::rational<int>(3, 2);
+        {
+            numerator *= 2;
+            denominator *= 3;
+        }
 
-        // Compute the number of microseconds per quarter note.
-        current_tempo = boost::rational_cast<int>(
-            60000000 / (scale * marker.getBeatsPerMinute()));
+        current_tempo = static_cast<int>(numerator / denominator);
 
         event_list.append(MidiEvent::setTempo(current_tick, current_tempo));
     }
@@ -308,7 +639,7 @@ int MidiFile::addTempoEvent(MidiEventList &event_list, int current_tick,
 
 static int getWholeRestDuration(const System &system, const Voice &voice,
                                 const Position &pos, int bar_start, int bar_end,
-                                int original_duration)
+                                int original_duration, int ppq)
 {
     // If the whole rest is not the only item in the bar, treat it like a
     // regular rest.
@@ -326,9 +657,69 @@ static int getWholeRestDuration(const System &system, const Voice &voice,
         ScoreUtils::findByPosition(system.getBarlines(), bar_start);
     const TimeSignature& time_sig = barline->getTimeSignature();
 
-    return boost::rational_cast<int>(
-        time_sig.getBeatsPerMeasure() *
-        boost::rational<int>(4, time_sig.getBeatValue()));
+    return 4 * time_sig.getBeatsPerMeasure() * ppq / time_sig.getBeatValue();
+}
+
+/// Returns the duration of the position in MIDI ticks, and advances the
+/// offset from the start of the bar.
+static int getPositionDuration(const System &system, const Voice &voice,
+                               const Position &pos, int bar_start, int bar_end,
+                               int ppq, int64_t &bar_offset)
+{
+    // Positions are placed at the score's tick resolution, and only the
+    // offsets from the start of the bar are rounded to MIDI ticks, so that
+    // rounding errors don't accumulate through the bar.
+    const VoiceTimeline &timeline = voice.getTimeline();
+    const int64_t start_offset = bar_offset;
+    bar_offset += timeline.getDuration(timeline.findIndex(pos.getPosition()));
+    int duration =
+        Ticks::toMidiTicks(bar_offset) - Ticks::toMidiTicks(start_offset);
+
+    // For whole rests, they must last for the entire bar, regardless of time
+    // signature.
+    if (pos.isRest() && pos.getDurationType() == Position::WholeNote)
+    {
+        duration = getWholeRestDuration(system, voice, pos, bar_start, bar_end,
+                                        duration, ppq);
+
+        // Extend for multi-bar rests.
+        if (pos.hasMultiBarRest())
+            duration *= pos.getMultiBarRestCount();
+    }
+
+    return duration;
+}
+
+int MidiEventGenerator::getBarEndTick(const System &system, int start_tick,
+                                      int bar_start, int bar_end) const
+{
+    int end_tick = start_tick;
+
+    for (const Staff &staff : system.getStaves())
+    {
+        for (const Voice &voice : staff.getVoices())
+        {
+            int current_tick = start_tick;
+            int64_t bar_offset = 0;
+
+            for (const Position &pos : ScoreUtils::findInRange(
+                     voice.getPositions(), bar_start, bar_end - 1))
+            {
+                const int duration =
+                    getPositionDuration(system, voice, pos, bar_start,
+                                        bar_end, myTicksPerBeat, bar_offset);
+
+                // Grace notes are played before the beat and don't take up
+                // any time in the bar.
+                if (pos.isRest() || !pos.hasProperty(Position::Acciaccatura))
+                    current_tick += duration;
+            }
+
+            end_tick = std::max(end_tick, current_tick);
+        }
+    }
+
+    return end_tick;
 }
 
 static int getActualNotePitch(const Note &note, const Tuning &tuning)
@@ -379,16 +770,14 @@ static Velocity getNoteVelocity(const Position &pos, const Note &note)
 /// a 32nd note at 120bpm.
 static int getGraceNoteTicks(int ppq, int current_tempo)
 {
-    return boost::rational_cast<int>(
-        boost::rational<int>(Midi::BEAT_DURATION_120_BPM, 8) /
-        boost::rational<int>(current_tempo, ppq));
+    return static_cast<int>(static_cast<int64_t>(Midi::BEAT_DURATION_120_BPM) *
+                            ppq / (8LL * current_tempo));
 }
 
 static int getArpeggioOffset(int ppq, int current_tempo)
 {
-    return boost::rational_cast<int>(
-        boost::rational<int>(Midi::BEAT_DURATION_120_BPM, 16) /
-        boost::rational<int>(current_tempo, ppq));
+    return static_cast<int>(static_cast<int64_t>(Midi::BEAT_DURATION_120_BPM) *
+                            ppq / (16LL * current_tempo));
 }
 
 /// Holds basic information about a bend - used to simplify the generateBends
@@ -404,35 +793,48 @@ struct BendEventInfo
     uint8_t myBendAmount;
 };
 
+/// Returns the minimum number of ticks between the events of a gradual bend,
+/// so that there are at most the given number of events per second.
+static int getControllerSpacing(int ppq, int current_tempo, int resolution)
+{
+    if (resolution <= 0)
+        return 0;
+
+    return static_cast<int>(static_cast<int64_t>(ppq) * 1000000 /
+                            (static_cast<int64_t>(resolution) * current_tempo));
+}
+
 static void generateGradualBend(std::vector<BendEventInfo> &bends,
                                 int start_tick, int duration, int start_bend,
-                                int release_bend)
+                                int release_bend, int min_spacing)
 {
-    const int num_events = std::abs(start_bend - release_bend);
+    int num_events = std::abs(start_bend - release_bend);
     if (!num_events)
         return;
 
+    // Resample the bend with fewer steps if the events would be too close
+    // together, but always finish at the release amount.
+    if (min_spacing > 0)
+        num_events = std::max(1, std::min(num_events, duration / min_spacing));
+
     const int event_duration = duration / num_events;
     for (int i = 1; i <= num_events; ++i)
     {
         const int tick = start_tick + i * event_duration;
-        if (start_bend < release_bend)
-            bends.push_back(BendEventInfo(tick, start_bend + i));
-        else
-            bends.push_back(BendEventInfo(tick, start_bend - i));
+        bends.push_back(BendEventInfo(
+            tick,
+            start_bend + (release_bend - start_bend) * i / num_events));
     }
 }
 
 static void generateBends(std::vector<BendEventInfo> &bends,
                           uint8_t &active_bend, int start_tick, int duration,
-                          int ppq, const Note &note)
+                          int ppq, int min_spacing, const Note &note)
 {
     const Bend &bend = note.getBend();
 
-    const int bend_amount = boost::rational_cast<int>(
-        DEFAULT_BEND + bend.getBentPitch() * BEND_QUARTER_TONE);
-    const int release_amount = boost::rational_cast<int>(
-        DEFAULT_BEND + bend.getReleasePitch() * BEND_QUARTER_TONE);
+    const int bend_amount = getBendAmount(bend.getBentPitch());
+    const int release_amount = getBendAmount(bend.getReleasePitch());
 
     switch (bend.getType())
     {
@@ -449,13 +851,13 @@ static void generateBends(std::vector<BendEventInfo> &bends,
             {
                 // Bend over a 32nd note.
                 generateGradualBend(bends, start_tick, ppq / 8, DEFAULT_BEND,
-                                    bend_amount);
+                                    bend_amount, min_spacing);
             }
             else if (bend.getDuration() == 1)
             {
                 // Bend over the current note duration.
                 generateGradualBend(bends, start_tick, duration, DEFAULT_BEND,
-                                    bend_amount);
+                                    bend_amount, min_spacing);
             }
             // TODO - implement bends that stretch over multiple notes.
             break;
@@ -463,7 +865,7 @@ static void generateBends(std::vector<BendEventInfo> &bends,
         case Bend::BendAndRelease:
             // Bend up to the bent pitch for half of the note duration.
             generateGradualBend(bends, start_tick, duration / 2, DEFAULT_BEND,
-                                bend_amount);
+                                bend_amount, min_spacing);
             break;
         default:
             break;
@@ -481,17 +883,17 @@ static void generateBends(std::vector<BendEventInfo> &bends,
 
         case Bend::PreBendAndRelease:
             generateGradualBend(bends, start_tick, duration, bend_amount,
-                                release_amount);
+                                release_amount, min_spacing);
             break;
 
         case Bend::BendAndRelease:
             generateGradualBend(bends, start_tick + duration / 2, duration / 2,
-                                bend_amount, release_amount);
+                                bend_amount, release_amount, min_spacing);
             break;
 
         case Bend::GradualRelease:
             generateGradualBend(bends, start_tick, duration, active_bend,
-                                release_amount);
+                                release_amount, min_spacing);
             break;
         default:
             break;
@@ -512,8 +914,8 @@ static void generateBends(std::vector<BendEventInfo> &bends,
 }
 
 static void generateSlides(std::vector<BendEventInfo> &bends, int start_tick,
-                           int note_duration, int ppq, const Note &note,
-                           const Note *next_note)
+                           int note_duration, int ppq, int min_spacing,
+                           const Note &note, const Note *next_note)
 {
     if (note.hasProperty(Note::ShiftSlide) ||
         note.hasProperty(Note::LegatoSlide) ||
@@ -527,10 +929,8 @@ static void generateSlides(std::vector<BendEventInfo> &bends, int start_tick,
         {
             if (next_note)
             {
-                bend_amount = boost::rational_cast<int>(
-                    DEFAULT_BEND +
-                    (next_note->getFretNumber() - note.getFretNumber()) * 2 *
-                        BEND_QUARTER_TONE);
+                bend_amount = getBendAmount(
+                    (next_note->getFretNumber() - note.getFretNumber()) * 2);
             }
             else
             {
@@ -547,7 +947,8 @@ static void generateSlides(std::vector<BendEventInfo> &bends, int start_tick,
         // somewhat more realistic-sounding.
         const int slide_duration = note_duration / 3;
         generateGradualBend(bends, start_tick + note_duration - slide_duration,
-                            slide_duration, DEFAULT_BEND, bend_amount);
+                            slide_duration, DEFAULT_BEND, bend_amount,
+                            min_spacing);
 
         // Reset pitch wheel after note is played.
         bends.push_back(
@@ -564,21 +965,24 @@ static void generateSlides(std::vector<BendEventInfo> &bends, int start_tick,
         // Slide over a 16th note.
         const int slide_duration = ppq / 4;
         generateGradualBend(bends, start_tick, slide_duration, bend_amount,
-                            DEFAULT_BEND);
+                            DEFAULT_BEND, min_spacing);
     }
 }
 
-int MidiFile::addEventsForBar(
+int MidiEventGenerator::addEventsForBar(
     std::vector<MidiEventList> &tracks, uint8_t &active_bend, int current_tick,
     int current_tempo, const Score &score, const System &system,
     int system_index, const Staff &staff, int staff_index, const Voice &voice,
-    int voice_index, int bar_start, int bar_end, const LoadOptions &options)
+    int voice_index, int bar_start, int bar_end,
+    const MidiFile::LoadOptions &options) const
 {
     ScoreLocation location(score, system_index, staff_index, voice_index);
     const Voice *prev_voice = VoiceUtils::getAdjacentVoice(location, -1);
     const Voice *next_voice = VoiceUtils::getAdjacentVoice(location, 1);
     bool let_ring_active = false;
 
+    int64_t bar_offset = 0;
+
     for (int position = bar_start; position < bar_end; ++position)
     {
         // Handle player/instrument changes.
@@ -626,23 +1030,12 @@ int MidiFile::addEventsForBar(
             continue;
 
         const SystemLocation system_location(system_index, position);
-        int duration = boost::rational_cast<int>(
-            myTicksPerBeat * VoiceUtils::getDurationTime(voice, *pos));
+        int duration = getPositionDuration(system, voice, *pos, bar_start,
+                                           bar_end, myTicksPerBeat,
+                                           bar_offset);
 
         if (pos->isRest())
         {
-            // For whole rests, they must last for the entire bar, regardless
-            // of time signature.
-            if (pos->getDurationType() == Position::WholeNote)
-            {
-                duration = getWholeRestDuration(system, voice, *pos, bar_start,
-                                                bar_end, duration);
-
-                // Extend for multi-bar rests.
-                if (pos->hasMultiBarRest())
-                    duration *= pos->getMultiBarRestCount();
-            }
-
             current_tick += duration;
             continue;
         }
@@ -790,6 +1183,10 @@ int MidiFile::addEventsForBar(
 
             // Generate all events that involve pitch bends.
             {
+                const int min_spacing = getControllerSpacing(
+                    myTicksPerBeat, current_tempo,
+                    options.myControllerResolution);
+
                 std::vector<BendEventInfo> bend_events;
 
                 if (note.hasProperty(Note::SlideIntoFromAbove) ||
@@ -800,7 +1197,7 @@ int MidiFile::addEventsForBar(
                     note.hasProperty(Note::SlideOutOfUpwards))
                 {
                     generateSlides(bend_events, current_tick, duration,
-                                   myTicksPerBeat, note,
+                                   myTicksPerBeat, min_spacing, note,
                                    VoiceUtils::getNextNote(voice, position,
                                                            note.getString()));
                 }
@@ -808,7 +1205,7 @@ int MidiFile::addEventsForBar(
                 if (note.hasBend())
                 {
                     generateBends(bend_events, active_bend, current_tick,
-                                  duration, myTicksPerBeat, note);
+                                  duration, myTicksPerBeat, min_spacing, note);
                 }
 
                 for (const BendEventInfo &event : bend_events)
@@ -879,15 +1276,13 @@ int MidiFile::addEventsForBar(
             if (!tied_to_next_note)
             {
                 // Shorten the note duration for certain effects.
-                boost::rational<int> factor(1);
+                int note_length = duration;
                 if (pos->hasProperty(Position::Staccato))
-                    factor /= 2;
+                    note_length = duration / 2;
                 else if (pos->hasProperty(Position::PalmMuting))
-                    factor /= boost::rational<int>(23, 20);
+                    note_length = duration * 20 / 23;
                 else if (note.hasProperty(Note::Muted))
-                    factor /= 8;
-
-                int note_length = boost::rational_cast<int>(duration * factor);
+                    note_length = duration / 8;
 
                 for (const ActivePlayer &player : active_players)
                 {
@@ -19,15 +19,18 @@
 #define MIDI_MIDIFILE_H
 
 #include <midi/midieventlist.h>
+#include <midi/repeatcontroller.h>
+#include <score/systemlocation.h>
 
 #include <cstdint>
+#include <map>
+#include <tuple>
 #include <vector>
 
 class Barline;
 class Score;
 class Staff;
 class System;
-class SystemLocation;
 class Voice;
 
 class MidiFile
@@ -42,7 +45,8 @@ public:
               myStrongAccentVel(0),
               myWeakAccentVel(0),
               myMetronomePreset(0),
-              myRecordPositionChanges(false)
+              myRecordPositionChanges(false),
+              myControllerResolution(0)
         {
         }
 
@@ -53,22 +57,114 @@ public:
         uint8_t myWeakAccentVel;
         uint8_t myMetronomePreset;
         bool myRecordPositionChanges;
+        /// The maximum number of events per second for gradual bends and
+        /// slides, or 0 for no limit.
+        int myControllerResolution;
     };
 
     MidiFile();
 
     void load(const Score &score, const LoadOptions &options);
 
+    /// Returns the MIDI channel that is used for the player.
+    static int getPlayerChannel(int player);
+
     int getTicksPerBeat() const { return myTicksPerBeat; }
     std::vector<MidiEventList> &getTracks() { return myTracks; }
     const std::vector<MidiEventList> &getTracks() const { return myTracks; }
 
 private:
+    int myTicksPerBeat;
+    std::vector<MidiEventList> myTracks;
+};
+
+/// Generates the MIDI events for a score one bar at a time, following any
+/// repeats and directions. This allows playback to begin before the events
+/// for the rest of the score have been generated. Alternatively, the rest of
+/// the score can be generated at once, with each staff on its own thread.
+class MidiEventGenerator
+{
+public:
+    /// The events for a bar that is played more than once are reused from
+    /// its first pass where possible, unless cache_bars is false (e.g. for
+    /// testing).
+    MidiEventGenerator(const Score &score,
+                       const MidiFile::LoadOptions &options,
+                       bool cache_bars = true);
+
+    int getTicksPerBeat() const { return myTicksPerBeat; }
+    /// Returns the tick where the next bar starts.
+    int getCurrentTick() const { return myCurrentTick; }
+    /// Returns whether the events for the whole score have been generated.
+    bool isFinished() const;
+
+    /// Appends the events for the next bar to the master track (tempo
+    /// changes), the track for each player, and the metronome track, using
+    /// absolute ticks. The events in each track are not necessarily sorted.
+    /// The first call also sets up each player's channel.
+    /// Returns false if there are no bars remaining.
+    bool generateNextBar(MidiEventList &master_track,
+                         std::vector<MidiEventList> &player_tracks,
+                         MidiEventList &metronome_track);
+
+    /// Appends the events for all of the remaining bars, in the same order
+    /// as repeatedly calling generateNextBar(). The bar sequence, tempo
+    /// changes and the start of each bar are resolved first, and then the
+    /// events for each staff are generated in parallel.
+    void generateRemainingBars(MidiEventList &master_track,
+                               std::vector<MidiEventList> &player_tracks,
+                               MidiEventList &metronome_track);
+
+private:
+    /// The location and timing of a bar, resolved without generating its
+    /// notes.
+    struct BarInfo
+    {
+        int mySystemIndex;
+        int myStart;
+        int myEnd;
+        int myStartTick;
+        int myTempo;
+    };
+
+    /// The events for a staff in a bar, relative to the start of the bar.
+    /// These can be reused when the bar is played again (e.g. for repeats),
+    /// if the tempo and the incoming pitch bend are the same.
+    struct BarEvents
+    {
+        std::vector<MidiEventList> myTracks;
+        uint8_t myFinalBend;
+    };
+
+    /// Maps the system, staff, bar position, tempo and incoming pitch bend to
+    /// the bar's events.
+    typedef std::map<std::tuple<int, int, int, int, uint8_t>, BarEvents>
+        BarEventCache;
+
+    /// Adds the initial events for each player, if necessary.
+    void start(std::vector<MidiEventList> &player_tracks);
+
+    /// Adds the tempo and metronome events for the next bar, and moves to
+    /// the bar that follows it.
+    BarInfo resolveNextBar(MidiEventList &master_track,
+                           MidiEventList &metronome_track);
+
+    /// Returns the tick where the bar ends, without generating its notes.
+    int getBarEndTick(const System &system, int start_tick, int bar_start,
+                      int bar_end) const;
+
+    /// Adds the events for each voice of the staff in the bar, and removes
+    /// any redundant controller events. If a cache is provided, the events
+    /// are reused from previous passes through the bar.
+    void addEventsForStaff(std::vector<MidiEventList> &tracks,
+                           uint8_t &active_bend, const BarInfo &bar,
+                           int staff_index, BarEventCache *cache) const;
+
     int generateMetronome(MidiEventList &event_list, int current_tick,
                           const System &system, const Barline &current_bar,
                           const Barline &next_bar,
                           const SystemLocation &location,
-                          const LoadOptions &options);
+                          const MidiFile::LoadOptions &options);
 
     int addTempoEvent(MidiEventList &event_list, int current_tick,
                       int current_tempo, const System &system, int bar_start,
@@ -80,10 +176,21 @@ private:
                         const System &system, int system_index,
                         const Staff &staff, int staff_index, const Voice &voice,
                         int voice_index, int bar_start, int bar_end,
-                        const LoadOptions &options);
+                        const MidiFile::LoadOptions &options) const;
 
-    int myTicksPerBeat;
-    std::vector<MidiEventList> myTracks;
+    const Score &myScore;
+    const MidiFile::LoadOptions myOptions;
+    const int myTicksPerBeat;
+    const bool myCacheBars;
+    RepeatController myRepeatController;
+    bool myStarted;
+    SystemLocation myLocation;
+    int mySystemIndex;
+    std::vector<uint8_t> myActiveBends;
+    /// The events for the bars in the current repeated section.
+    BarEventCache myBarCache;
+    int myCurrentTick;
+    int myCurrentTempo;
 };
 
 #endif
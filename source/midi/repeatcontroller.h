@@ -37,6 +37,12 @@ public:
                         const SystemLocation &currentLocation,
                         SystemLocation &newLocation);
 
+    /// Returns the repeated section that contains the location, if any.
+    const RepeatedSection *findRepeat(const SystemLocation &location) const
+    {
+        return myRepeatIndex.findRepeat(location);
+    }
+
 private:
     DirectionIndex myDirectionIndex;
     RepeatIndexer myRepeatIndex;
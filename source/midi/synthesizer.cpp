@@ -0,0 +1,619 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "synthesizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <midi/midifile.h>
+#include <score/generalmidi.h>
+#include <util/parallelfor.h>
+#include <vector>
+
+/// The number of frames that are rendered for every track before mixing.
+static const size_t BLOCK_FRAMES = 65536;
+/// The number of frames between updates to the pitch of each voice (e.g. for
+/// bends or vibrato).
+static const size_t CONTROL_FRAMES = 64;
+static const int WAVETABLE_SIZE = 2048;
+static const int PERCUSSION_CHANNEL = 9;
+static const int NUM_MIDI_CHANNELS = 16;
+static const int PITCH_WHEEL_CENTER = 8192;
+/// Extra time after the last event, so that the final notes can ring out.
+static const double TAIL_SECONDS = 1.5;
+/// Leaves headroom for several voices playing at once.
+static const float VOICE_GAIN = 0.25f;
+/// A voice is removed once its level falls below this.
+static const float SILENCE_LEVEL = 1e-4f;
+static const double VIBRATO_FREQUENCY = 5.5;
+/// The vibrato depth (in semitones) at the maximum mod wheel level.
+static const double MAX_VIBRATO_DEPTH = 0.5;
+static const double PI = 3.14159265358979323846;
+
+typedef std::array<float, WAVETABLE_SIZE + 1> Wavetable;
+
+/// Builds a single cycle of a waveform from the amplitudes of its harmonics.
+/// The first sample is repeated at the end to simplify interpolation.
+static Wavetable buildWavetable(const std::vector<double> &harmonics)
+{
+    Wavetable table;
+    float peak = 0;
+
+    for (int i = 0; i < WAVETABLE_SIZE; ++i)
+    {
+        double sample = 0;
+        for (size_t h = 0; h < harmonics.size(); ++h)
+        {
+            sample += harmonics[h] *
+                      std::sin(2 * PI * (h + 1) * i / WAVETABLE_SIZE);
+        }
+
+        table[i] = static_cast<float>(sample);
+        peak = std::max(peak, std::abs(table[i]));
+    }
+
+    for (int i = 0; i < WAVETABLE_SIZE; ++i)
+        table[i] /= peak;
+    table[WAVETABLE_SIZE] = table[0];
+
+    return table;
+}
+
+static double getFrequency(double pitch)
+{
+    return 440.0 * std::pow(2.0, (pitch - 69) / 12.0);
+}
+
+namespace
+{
+/// The sound of an instrument.
+struct Patch
+{
+    const Wavetable *myWavetable;
+    /// Times are in seconds.
+    double myAttack;
+    /// The time for the level to fall by 60dB while the note is held.
+    double myDecay;
+    double mySustain;
+    double myRelease;
+};
+
+/// Plucked or struck instruments (e.g. guitars, basses and pianos) decay
+/// while the note is held. Other instruments (e.g. organs, strings or synth
+/// leads) sustain.
+Patch getPatch(uint8_t program)
+{
+    // Bright harmonics for plucked strings, and mostly odd harmonics for the
+    // sustained patches.
+    static const Wavetable thePluckedTable = buildWavetable(
+        { 1, 0.5, 0.33, 0.25, 0.2, 0.16, 0.12, 0.1, 0.08, 0.06 });
+    static const Wavetable theSustainedTable =
+        buildWavetable({ 1, 0.2, 0.4, 0.1, 0.25, 0.05, 0.15, 0.03, 0.1 });
+
+    const bool distorted =
+        program == Midi::MIDI_PRESET_OVERDRIVEN_GUITAR ||
+        program == Midi::MIDI_PRESET_DISTORTION_GUITAR;
+    const bool sustained = distorted || (program >= 16 && program < 24) ||
+                           (program >= 40 && program < 104);
+
+    if (sustained)
+        return { &theSustainedTable, 0.01, 4.0, 0.7, 0.15 };
+    else
+        return { &thePluckedTable, 0.002, 2.5, 0, 0.08 };
+}
+
+/// Returns the factor that reduces a level by 60dB over the given time.
+float getDecayFactor(double seconds, int sample_rate)
+{
+    return static_cast<float>(std::pow(0.001, 1.0 / (seconds * sample_rate)));
+}
+
+struct ChannelState
+{
+    ChannelState()
+        : myProgram(0),
+          myVolume(Midi::MAX_MIDI_CHANNEL_VOLUME),
+          myPan(64),
+          myModulation(0),
+          myBend(PITCH_WHEEL_CENTER),
+          myBendRange(2),
+          myRpn(-1),
+          mySustain(false)
+    {
+    }
+
+    uint8_t myProgram;
+    uint8_t myVolume;
+    uint8_t myPan;
+    uint8_t myModulation;
+    int myBend;
+    /// The range of the pitch wheel, in semitones.
+    int myBendRange;
+    /// The registered parameter that is being edited, or -1.
+    int myRpn;
+    bool mySustain;
+};
+
+struct Voice
+{
+    int myChannel;
+    uint8_t myPitch;
+    bool myPercussion;
+    const Wavetable *myWavetable;
+    float myGain;
+
+    double myPhase;
+    double myIncrement;
+
+    float myLevel;
+    bool myAttacking;
+    float myAttackStep;
+    float myDecayFactor;
+    float mySustain;
+    float myReleaseFactor;
+    bool myReleased;
+    /// The note was released while the sustain pedal was down.
+    bool myHeld;
+
+    /// State of the noise generator for percussion.
+    uint32_t myNoise;
+    float myNoiseAmount;
+};
+
+/// Converts ticks to seconds, using the tempo changes from every track. The
+/// tracks use delta ticks.
+class TempoMap
+{
+public:
+    TempoMap(const std::vector<MidiEventList> &tracks, int ticks_per_beat)
+        : myTicksPerBeat(ticks_per_beat)
+    {
+        std::vector<std::pair<int, int>> tempos;
+        for (const MidiEventList &track : tracks)
+        {
+            int ticks = 0;
+            for (const MidiEvent &event : track)
+            {
+                ticks += event.getTicks();
+                if (event.isTempoChange())
+                    tempos.emplace_back(ticks, event.getTempo());
+            }
+        }
+
+        std::stable_sort(tempos.begin(), tempos.end(),
+                         [](const std::pair<int, int> &a,
+                            const std::pair<int, int> &b) {
+                             return a.first < b.first;
+                         });
+
+        myChanges.push_back({ 0, 0, Midi::BEAT_DURATION_120_BPM });
+        for (const std::pair<int, int> &tempo : tempos)
+        {
+            myChanges.push_back(
+                { tempo.first, getTime(tempo.first), tempo.second });
+        }
+    }
+
+    double getTime(int ticks) const
+    {
+        auto it = std::upper_bound(
+            myChanges.begin(), myChanges.end(), ticks,
+            [](int t, const Change &change) { return t < change.myTicks; });
+        const Change &change = *(it - 1);
+
+        return change.myTime + static_cast<double>(ticks - change.myTicks) *
+                                   change.myTempo / myTicksPerBeat / 1e6;
+    }
+
+private:
+    struct Change
+    {
+        int myTicks;
+        double myTime;
+        /// Microseconds per beat.
+        int myTempo;
+    };
+
+    int myTicksPerBeat;
+    std::vector<Change> myChanges;
+};
+
+/// Renders the notes from one track, reading the events (which use delta
+/// ticks) directly from the track. The state of each voice is kept between
+/// blocks.
+class TrackRenderer
+{
+public:
+    TrackRenderer(const MidiEventList &track, const TempoMap &tempo_map,
+                  int sample_rate)
+        : myTrack(track),
+          myTempoMap(tempo_map),
+          mySampleRate(sample_rate),
+          myNextEvent(track.begin()),
+          myNextTick(0),
+          myNextFrame(0),
+          myFrame(0)
+    {
+        findNextFrame();
+    }
+
+    /// Returns the frame of the last event.
+    size_t getEndFrame() const
+    {
+        int ticks = 0;
+        for (const MidiEvent &event : myTrack)
+            ticks += event.getTicks();
+
+        return getFrame(ticks);
+    }
+
+    /// Renders the next block of frames into the output buffer.
+    void render(float *output, size_t frames)
+    {
+        const size_t end_frame = myFrame + frames;
+
+        while (myFrame < end_frame)
+        {
+            // Handle any events that occur at the current frame.
+            while (myNextEvent != myTrack.end() && myNextFrame <= myFrame)
+            {
+                handleEvent(*myNextEvent);
+                ++myNextEvent;
+                findNextFrame();
+            }
+
+            size_t next_frame = std::min(end_frame, myFrame + CONTROL_FRAMES);
+            if (myNextEvent != myTrack.end())
+                next_frame = std::min(next_frame, myNextFrame);
+
+            const size_t count = next_frame - myFrame;
+            renderVoices(output, count);
+            output += count * Synthesizer::NUM_OUTPUT_CHANNELS;
+            myFrame = next_frame;
+        }
+    }
+
+private:
+    void handleEvent(const MidiEvent &event)
+    {
+        const uint8_t *data = event.getData();
+        const uint8_t status = data[0] & 0xf0;
+        if (event.getDataSize() < 2 || data[0] >= MidiEvent::SysEx)
+            return;
+
+        const int channel = data[0] & 0x0f;
+        ChannelState &state = myChannels[channel];
+
+        switch (status)
+        {
+            case MidiEvent::NoteOn:
+                if (data[2] == 0)
+                    releaseNote(channel, data[1]);
+                else
+                    startNote(channel, data[1], data[2]);
+                break;
+
+            case MidiEvent::NoteOff:
+                releaseNote(channel, data[1]);
+                break;
+
+            case MidiEvent::ProgramChange:
+                state.myProgram = data[1];
+                break;
+
+            case MidiEvent::PitchWheel:
+                state.myBend = (data[2] << 7) | data[1];
+                break;
+
+            case MidiEvent::ControlChange:
+                handleController(channel, data[1], data[2]);
+                break;
+        }
+    }
+
+    void handleController(int channel, uint8_t controller, uint8_t value)
+    {
+        ChannelState &state = myChannels[channel];
+
+        switch (controller)
+        {
+            case 0x01: // Mod wheel.
+                state.myModulation = value;
+                break;
+
+            case 0x06: // Data entry.
+                // Registered parameter 0 is the pitch wheel range.
+                if (state.myRpn == 0)
+                    state.myBendRange = value;
+                break;
+
+            case 0x07: // Channel volume.
+                state.myVolume = value;
+                break;
+
+            case 0x0a: // Pan.
+                state.myPan = value;
+                break;
+
+            case 0x40: // Hold pedal.
+                state.mySustain = value >= 64;
+                if (!state.mySustain)
+                {
+                    for (Voice &voice : myVoices)
+                    {
+                        if (voice.myChannel == channel && voice.myHeld)
+                        {
+                            voice.myHeld = false;
+                            voice.myReleased = true;
+                        }
+                    }
+                }
+                break;
+
+            case 0x64: // RPN LSB.
+                state.myRpn = (std::max(state.myRpn, 0) & 0x3f80) | value;
+                break;
+
+            case 0x65: // RPN MSB.
+                state.myRpn = (std::max(state.myRpn, 0) & 0x7f) | (value << 7);
+                break;
+
+            case 0x7b: // All notes off.
+                for (Voice &voice : myVoices)
+                {
+                    if (voice.myChannel == channel)
+                        voice.myReleased = true;
+                }
+                break;
+        }
+    }
+
+    void startNote(int channel, uint8_t pitch, uint8_t velocity)
+    {
+        const ChannelState &state = myChannels[channel];
+
+        Voice voice;
+        voice.myChannel = channel;
+        voice.myPitch = pitch;
+        voice.myPercussion = (channel == PERCUSSION_CHANNEL);
+        voice.myGain = VOICE_GAIN * velocity / 127.0f;
+        voice.myPhase = 0;
+        voice.myIncrement = 0;
+        voice.myReleased = false;
+        voice.myHeld = false;
+        voice.myNoise = 22222 + pitch;
+
+        if (voice.myPercussion)
+        {
+            // A short click, pitched by the note number. Cymbals and hi-hats
+            // are mostly noise.
+            static const Wavetable theSineTable = buildWavetable({ 1 });
+            voice.myWavetable = &theSineTable;
+            voice.myNoiseAmount =
+                (pitch == 42 || pitch == 44 || pitch == 46 || pitch == 49 ||
+                 pitch == 51 || pitch == 52 || pitch == 55 || pitch == 57 ||
+                 pitch == 59)
+                    ? 0.8f
+                    : 0.15f;
+            voice.myLevel = 1;
+            voice.myAttacking = false;
+            voice.myAttackStep = 0;
+            voice.myDecayFactor = getDecayFactor(0.12, mySampleRate);
+            voice.mySustain = 0;
+            voice.myReleaseFactor = voice.myDecayFactor;
+            voice.myIncrement = getFrequency(pitch + 12) * WAVETABLE_SIZE /
+                                mySampleRate;
+        }
+        else
+        {
+            const Patch patch = getPatch(state.myProgram);
+            voice.myWavetable = patch.myWavetable;
+            voice.myNoiseAmount = 0;
+            voice.myLevel = 0;
+            voice.myAttacking = true;
+            voice.myAttackStep =
+                static_cast<float>(1.0 / (patch.myAttack * mySampleRate));
+            voice.myDecayFactor = getDecayFactor(patch.myDecay, mySampleRate);
+            voice.mySustain = static_cast<float>(patch.mySustain);
+            voice.myReleaseFactor =
+                getDecayFactor(patch.myRelease, mySampleRate);
+        }
+
+        // Restart the note if it is already playing.
+        releaseNote(channel, pitch);
+        myVoices.push_back(voice);
+    }
+
+    void releaseNote(int channel, uint8_t pitch)
+    {
+        for (Voice &voice : myVoices)
+        {
+            if (voice.myChannel == channel && voice.myPitch == pitch &&
+                !voice.myReleased && !voice.myHeld)
+            {
+                if (myChannels[channel].mySustain)
+                    voice.myHeld = true;
+                else
+                    voice.myReleased = true;
+            }
+        }
+    }
+
+    void updatePitch(Voice &voice) const
+    {
+        if (voice.myPercussion)
+            return;
+
+        const ChannelState &state = myChannels[voice.myChannel];
+        double pitch = voice.myPitch +
+                       static_cast<double>(state.myBend - PITCH_WHEEL_CENTER) *
+                           state.myBendRange / PITCH_WHEEL_CENTER;
+
+        if (state.myModulation > 0)
+        {
+            const double time = static_cast<double>(myFrame) / mySampleRate;
+            pitch += MAX_VIBRATO_DEPTH * state.myModulation / 127.0 *
+                     std::sin(2 * PI * VIBRATO_FREQUENCY * time);
+        }
+
+        voice.myIncrement =
+            getFrequency(pitch) * WAVETABLE_SIZE / mySampleRate;
+    }
+
+    void renderVoices(float *output, size_t frames)
+    {
+        for (Voice &voice : myVoices)
+        {
+            updatePitch(voice);
+
+            const ChannelState &state = myChannels[voice.myChannel];
+            const float volume = voice.myGain * state.myVolume / 127.0f;
+            const double pan = state.myPan / 127.0 * PI / 2;
+            const float left = volume * static_cast<float>(std::cos(pan));
+            const float right = volume * static_cast<float>(std::sin(pan));
+            const Wavetable &table = *voice.myWavetable;
+
+            float *out = output;
+            for (size_t i = 0; i < frames; ++i)
+            {
+                // Update the envelope.
+                if (voice.myReleased)
+                    voice.myLevel *= voice.myReleaseFactor;
+                else if (voice.myAttacking)
+                {
+                    voice.myLevel += voice.myAttackStep;
+                    if (voice.myLevel >= 1)
+                    {
+                        voice.myLevel = 1;
+                        voice.myAttacking = false;
+                    }
+                }
+                else
+                {
+                    voice.myLevel =
+                        voice.mySustain + (voice.myLevel - voice.mySustain) *
+                                              voice.myDecayFactor;
+                }
+
+                const int index = static_cast<int>(voice.myPhase);
+                const float frac = static_cast<float>(voice.myPhase - index);
+                float sample =
+                    table[index] + frac * (table[index + 1] - table[index]);
+
+                voice.myPhase += voice.myIncrement;
+                if (voice.myPhase >= WAVETABLE_SIZE)
+                    voice.myPhase -= WAVETABLE_SIZE;
+
+                if (voice.myNoiseAmount > 0)
+                {
+                    voice.myNoise = voice.myNoise * 1664525 + 1013904223;
+                    const float noise =
+                        static_cast<float>(voice.myNoise >> 8) / (1 << 23) -
+                        1.0f;
+                    sample += voice.myNoiseAmount * (noise - sample);
+                }
+
+                sample *= voice.myLevel;
+                out[0] += sample * left;
+                out[1] += sample * right;
+                out += Synthesizer::NUM_OUTPUT_CHANNELS;
+            }
+        }
+
+        // Remove voices that have faded out.
+        myVoices.erase(std::remove_if(myVoices.begin(), myVoices.end(),
+                                      [](const Voice &voice) {
+                                          return !voice.myAttacking &&
+                                                 voice.myLevel < SILENCE_LEVEL;
+                                      }),
+                       myVoices.end());
+    }
+
+    size_t getFrame(int ticks) const
+    {
+        return static_cast<size_t>(myTempoMap.getTime(ticks) * mySampleRate);
+    }
+
+    /// Finds the tick and frame of the next event, if there is one.
+    void findNextFrame()
+    {
+        if (myNextEvent == myTrack.end())
+            return;
+
+        myNextTick += myNextEvent->getTicks();
+        myNextFrame = getFrame(myNextTick);
+    }
+
+    const MidiEventList &myTrack;
+    const TempoMap &myTempoMap;
+    const int mySampleRate;
+    MidiEventList::const_iterator myNextEvent;
+    int myNextTick;
+    size_t myNextFrame;
+    size_t myFrame;
+    std::array<ChannelState, NUM_MIDI_CHANNELS> myChannels;
+    std::vector<Voice> myVoices;
+};
+}
+
+Synthesizer::Synthesizer(int sample_rate) : mySampleRate(sample_rate)
+{
+}
+
+void Synthesizer::render(const MidiFile &file,
+                         const OutputCallback &output) const
+{
+    const std::vector<MidiEventList> &tracks = file.getTracks();
+    const TempoMap tempo_map(tracks, file.getTicksPerBeat());
+
+    std::vector<TrackRenderer> renderers;
+    size_t total_frames = 0;
+    for (const MidiEventList &track : tracks)
+    {
+        renderers.emplace_back(track, tempo_map, mySampleRate);
+        total_frames = std::max(total_frames, renderers.back().getEndFrame());
+    }
+    total_frames += static_cast<size_t>(TAIL_SECONDS * mySampleRate);
+
+    const size_t block_size = BLOCK_FRAMES * NUM_OUTPUT_CHANNELS;
+    std::vector<std::vector<float>> buffers(renderers.size(),
+                                            std::vector<float>(block_size));
+    std::vector<float> mix(block_size);
+
+    for (size_t start = 0; start < total_frames; start += BLOCK_FRAMES)
+    {
+        const size_t frames = std::min(BLOCK_FRAMES, total_frames - start);
+
+        parallelFor(static_cast<int>(renderers.size()), [&](int i) {
+            std::fill(buffers[i].begin(), buffers[i].end(), 0.0f);
+            renderers[i].render(buffers[i].data(), frames);
+        });
+
+        std::fill(mix.begin(), mix.end(), 0.0f);
+        for (const std::vector<float> &buffer : buffers)
+        {
+            for (size_t i = 0; i < frames * NUM_OUTPUT_CHANNELS; ++i)
+                mix[i] += buffer[i];
+        }
+
+        for (size_t i = 0; i < frames * NUM_OUTPUT_CHANNELS; ++i)
+            mix[i] = std::max(-1.0f, std::min(1.0f, mix[i]));
+
+        output(mix.data(), frames);
+    }
+}
@@ -0,0 +1,54 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MIDI_SYNTHESIZER_H
+#define MIDI_SYNTHESIZER_H
+
+#include <cstddef>
+#include <functional>
+
+class MidiFile;
+
+/// A lightweight software synthesizer, which renders a MIDI file to audio
+/// without any audio hardware (e.g. to create practice tracks). Instruments
+/// are approximated by a few wavetable patches, and the percussion channel
+/// (including the metronome) is rendered as short clicks.
+class Synthesizer
+{
+public:
+    /// Receives the next block of interleaved stereo samples, in the range
+    /// [-1, 1].
+    typedef std::function<void(const float *samples, size_t frames)>
+        OutputCallback;
+
+    static const int NUM_OUTPUT_CHANNELS = 2;
+
+    explicit Synthesizer(int sample_rate = 44100);
+
+    int getSampleRate() const { return mySampleRate; }
+
+    /// Renders the tracks in parallel and mixes them together. The events are
+    /// read directly from the file and the output is delivered in blocks, so
+    /// the memory used for rendering doesn't grow with the length of the
+    /// audio.
+    void render(const MidiFile &file, const OutputCallback &output) const;
+
+private:
+    int mySampleRate;
+};
+
+#endif
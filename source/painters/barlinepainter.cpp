@@ -17,28 +17,15 @@
   
 #include "barlinepainter.h"
 
-#include <app/pubsub/clickpubsub.h>
-#include <QCursor>
-#include <QGraphicsSceneMouseEvent>
 #include <QPainter>
 #include <score/barline.h>
 
 const double BarlinePainter::DOUBLE_BAR_WIDTH = 4;
 
 BarlinePainter::BarlinePainter(const LayoutConstPtr &layout,
-                               const Barline &barline,
-                               const ScoreLocation &location,
-                               const std::shared_ptr<ClickPubSub> &pubsub)
-    : myLayout(layout),
-      myBarline(barline),
-      myLocation(location),
-      myPubSub(pubsub),
-      myX(0),
-      myWidth(0)
+                               const Barline &barline)
+    : myLayout(layout), myBarline(barline), myX(0), myWidth(0)
 {
-    setAcceptHoverEvents(true);
-    setToolTip(QObject::tr("Click to edit barline."));
-
     switch (barline.getBarType())
     {
     case Barline::SingleBar:
@@ -72,37 +59,6 @@ BarlinePainter::BarlinePainter(const LayoutConstPtr &layout,
                       layout->getStaffHeight());
 }
 
-void BarlinePainter::mousePressEvent(QGraphicsSceneMouseEvent *event)
-{
-    // Only handle clicks that occur in the standard notation staff.
-    if (!isInStdNotationStaff(event->pos().y()))
-        event->ignore();
-}
-
-void BarlinePainter::mouseReleaseEvent(QGraphicsSceneMouseEvent *)
-{
-    myPubSub->publish(ClickType::Barline, myLocation);
-}
-
-void BarlinePainter::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
-{
-    if (isInStdNotationStaff(event->pos().y()))
-        setCursor(Qt::PointingHandCursor);
-    else
-        unsetCursor();
-}
-
-void BarlinePainter::hoverLeaveEvent(QGraphicsSceneHoverEvent *)
-{
-    unsetCursor();
-}
-
-bool BarlinePainter::isInStdNotationStaff(double y)
-{
-    return (y <= myLayout->getBottomStdNotationLine()) &&
-           (y >= myLayout->getTopStdNotationLine());
-}
-
 void BarlinePainter::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                            QWidget *)
 {
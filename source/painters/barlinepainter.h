@@ -19,19 +19,14 @@
 #define PAINTERS_BARLINEPAINTER_H
 
 #include <QGraphicsItem>
-#include <memory>
 #include <painters/layoutinfo.h>
-#include <score/scorelocation.h>
 
 class Barline;
-class ClickPubSub;
 
 class BarlinePainter : public QGraphicsItem
 {
 public:
-    BarlinePainter(const LayoutConstPtr& layout, const Barline &barline,
-                   const ScoreLocation& location,
-                   const std::shared_ptr<ClickPubSub> &pubsub);
+    BarlinePainter(const LayoutConstPtr& layout, const Barline &barline);
 
     virtual void paint(QPainter *painter,
                        const QStyleOptionGraphicsItem *option,
@@ -43,19 +38,11 @@ public:
     }
 
 private:
-    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void hoverMoveEvent(QGraphicsSceneHoverEvent *) override;
-    virtual void hoverLeaveEvent(QGraphicsSceneHoverEvent *) override;
-
-    bool isInStdNotationStaff(double y);
     void drawVerticalLines(QPainter *painter, double myX);
 
     LayoutConstPtr myLayout;
     const Barline &myBarline;
     QRectF myBounds;
-    ScoreLocation myLocation;
-    std::shared_ptr<ClickPubSub> myPubSub;
     double myX;
     double myWidth;
 
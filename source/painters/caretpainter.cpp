@@ -20,6 +20,7 @@
 #include <app/caret.h>
 #include <app/viewoptions.h>
 #include <boost/lexical_cast.hpp>
+#include <painters/layoutcache.h>
 #include <painters/layoutinfo.h>
 #include <QGraphicsScene>
 #include <QGraphicsView>
@@ -31,9 +32,11 @@
 const double CaretPainter::PEN_WIDTH = 0.75;
 const double CaretPainter::CARET_NOTE_SPACING = 6;
 
-CaretPainter::CaretPainter(const Caret &caret, const ViewOptions &view_options)
+CaretPainter::CaretPainter(const Caret &caret, const ViewOptions &view_options,
+                           const std::shared_ptr<LayoutCache> &layout_cache)
     : myCaret(caret),
       myViewOptions(view_options),
+      myLayoutCache(layout_cache),
       myCaretConnection(caret.subscribeToChanges([=]() {
           onLocationChanged();
       }))
@@ -129,19 +132,77 @@ QRectF CaretPainter::boundingRect() const
         return QRectF();
 }
 
+CaretPainter::SystemGeometry::SystemGeometry(const QRectF &rect)
+    : myRect(rect), mySystem(nullptr), myRevision(0)
+{
+}
+
 void CaretPainter::addSystemRect(const QRectF &rect)
 {
-    mySystemRects.push_back(rect);
+    mySystems.push_back(SystemGeometry(rect));
+    updateGeometry(static_cast<int>(mySystems.size()) - 1);
 }
 
 void CaretPainter::setSystemRect(int index, const QRectF &rect)
 {
-    mySystemRects.at(index) = rect;
+    mySystems.at(index).myRect = rect;
+    updateGeometry(index);
 }
 
 QRectF CaretPainter::getCurrentSystemRect() const
 {
-    return mySystemRects.at(myCaret.getLocation().getSystemIndex());
+    return mySystems.at(myCaret.getLocation().getSystemIndex()).myRect;
+}
+
+void CaretPainter::updateGeometry(int systemIndex)
+{
+    const Score &score = myCaret.getLocation().getScore();
+    if (systemIndex >= static_cast<int>(score.getSystems().size()))
+        return;
+
+    const System &system = score.getSystems()[systemIndex];
+    SystemGeometry &geometry = mySystems.at(systemIndex);
+    if (geometry.mySystem == &system &&
+        geometry.myRevision == system.getRevision())
+    {
+        return;
+    }
+
+    geometry.mySystem = &system;
+    geometry.myRevision = system.getRevision();
+    geometry.myStaves.clear();
+
+    const ViewFilter *filter =
+        myViewOptions.getFilter()
+            ? &score.getViewFilters()[*myViewOptions.getFilter()]
+            : nullptr;
+
+    // Compute the offset due to the previous (visible) staves. The layouts
+    // were already computed when rendering the system.
+    double offset = 0;
+    int i = 0;
+    for (const Staff &staff : system.getStaves())
+    {
+        StaffGeometry staffGeometry;
+        staffGeometry.myCaretOffset = 0;
+
+        if (!filter || filter->accept(score, systemIndex, i))
+        {
+            LayoutConstPtr layout = myLayoutCache->getLayout(
+                score, system, systemIndex, staff, i);
+
+            staffGeometry.myLayout = layout;
+            staffGeometry.myCaretOffset =
+                offset + layout->getSystemSymbolSpacing() +
+                layout->getStaffHeight() - layout->getTabStaffBelowSpacing() -
+                LayoutInfo::STAFF_BORDER_SPACING - layout->getTabStaffHeight();
+
+            offset += layout->getStaffHeight();
+        }
+
+        geometry.myStaves.push_back(staffGeometry);
+        ++i;
+    }
 }
 
 void CaretPainter::updatePosition()
@@ -166,39 +227,39 @@ void CaretPainter::onLocationChanged()
     if (system.getStaves().empty())
         return;
 
-    myLayout.reset(new LayoutInfo(location.getScore(), system,
-                                  location.getSystemIndex(), location.getStaff(),
-                                  location.getStaffIndex()));
-
-    const ViewFilter *filter =
-        myViewOptions.getFilter()
-            ? &location.getScore().getViewFilters()[*myViewOptions.getFilter()]
-            : nullptr;
+    // The system may not have been rendered yet (e.g. if the caret is moved
+    // before a redraw).
+    const int systemIndex = location.getSystemIndex();
+    if (systemIndex >= static_cast<int>(mySystems.size()))
+        return;
 
-    // Compute the offset due to the previous (visible) staves.
-    double offset = 0;
-    for (int i = 0; i < location.getStaffIndex(); ++i)
+    // This is normally just a lookup, unless the system was modified.
+    updateGeometry(systemIndex);
+    const SystemGeometry &geometry = mySystems[systemIndex];
+    const int staffIndex = location.getStaffIndex();
+    if (staffIndex >= static_cast<int>(geometry.myStaves.size()) ||
+        !geometry.myStaves[staffIndex].myLayout)
     {
-        if (!filter ||
-            filter->accept(location.getScore(), location.getSystemIndex(), i))
-        {
-            offset += LayoutInfo(location.getScore(), system,
-                                 location.getSystemIndex(),
-                                 system.getStaves()[i], i).getStaffHeight();
-        }
+        return;
     }
 
+    const StaffGeometry &staffGeometry = geometry.myStaves[staffIndex];
+    myLayout = staffGeometry.myLayout;
+
     const QRectF oldRect = sceneBoundingRect();
-    setPos(0, mySystemRects.at(location.getSystemIndex()).top() + offset +
-           myLayout->getSystemSymbolSpacing() + myLayout->getStaffHeight() -
-           myLayout->getTabStaffBelowSpacing() - myLayout->STAFF_BORDER_SPACING -
-           myLayout->getTabStaffHeight());
+    setPos(0, geometry.myRect.top() + staffGeometry.myCaretOffset);
     update(boundingRect());
     // Ensure that a redraw always occurs at the old location.
     scene()->update(oldRect);
 
-    setToolTip(QString::fromStdString(
-                   boost::lexical_cast<std::string>(location)));
+    // Avoid formatting the tooltip for every note during playback.
+    if (!myCaret.isInPlaybackMode())
+    {
+        setToolTip(QString::fromStdString(
+            boost::lexical_cast<std::string>(location)));
+    }
+    else
+        setToolTip(QString());
 
     // Notify anyone interested in the caret being redrawn.
     onMyLocationChanged();
@@ -19,17 +19,22 @@
 #define PAINTERS_CARETPAINTER_H
 
 #include <boost/signals2/signal.hpp>
+#include <cstdint>
 #include <memory>
 #include <QGraphicsItem>
+#include <vector>
 
 class Caret;
+class LayoutCache;
 struct LayoutInfo;
+class System;
 class ViewOptions;
 
 class CaretPainter : public QGraphicsItem
 {
 public:
-    CaretPainter(const Caret &caret, const ViewOptions &view_options);
+    CaretPainter(const Caret &caret, const ViewOptions &view_options,
+                 const std::shared_ptr<LayoutCache> &layout_cache);
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                        QWidget *) override;
@@ -48,13 +53,40 @@ public:
             const LocationChangedSlot::slot_type &subscriber);
 
 private:
+    /// The layout and offset of a staff, which are computed when the system
+    /// is rendered so that moving the caret (e.g. during playback) only
+    /// requires a lookup.
+    struct StaffGeometry
+    {
+        std::shared_ptr<const LayoutInfo> myLayout;
+        /// Offset of the caret from the top of the system.
+        double myCaretOffset;
+    };
+
+    struct SystemGeometry
+    {
+        SystemGeometry(const QRectF &rect);
+
+        QRectF myRect;
+        const System *mySystem;
+        uint64_t myRevision;
+        /// The geometry of each staff, which has no layout if the staff is
+        /// hidden by the view filter.
+        std::vector<StaffGeometry> myStaves;
+    };
+
+    /// Recomputes the staff geometry for the system if it has been modified
+    /// since it was last computed.
+    void updateGeometry(int systemIndex);
+
     /// Redraw the caret painter whenever the caret moves.
     void onLocationChanged();
 
     const Caret &myCaret;
     const ViewOptions &myViewOptions;
-    std::unique_ptr<LayoutInfo> myLayout;
-    std::vector<QRectF> mySystemRects;
+    std::shared_ptr<LayoutCache> myLayoutCache;
+    std::shared_ptr<const LayoutInfo> myLayout;
+    std::vector<SystemGeometry> mySystems;
     boost::signals2::scoped_connection myCaretConnection;
     LocationChangedSlot onMyLocationChanged;
 
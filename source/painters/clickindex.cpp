@@ -0,0 +1,155 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "clickindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+/// Width of the vertical strips that the regions are grouped into.
+static const double BUCKET_WIDTH = 16;
+
+int ClickIndex::StaffRegion::getPosition(double x) const
+{
+    return myLayout->getPositionFromX(x - myRect.left());
+}
+
+int ClickIndex::StaffRegion::getString(double y) const
+{
+    // Find the position relative to the top of the staff, in terms of the tab
+    // line spacing. Then, round it to find the string index.
+    const double staffY = y - myRect.top();
+    const int string = static_cast<int>(std::floor(
+        ((staffY - myLayout->getTopTabLine()) /
+         myLayout->getTabLineSpacing()) + 0.5));
+
+    if (string >= 0 && string < myLayout->getStringCount())
+        return string;
+    else
+        return -1;
+}
+
+/// Returns the bucket containing the x coordinate, clamped to the valid range.
+static int getBucket(double x, int bucketCount)
+{
+    const int bucket = static_cast<int>(std::floor(x / BUCKET_WIDTH));
+    return std::max(0, std::min(bucketCount - 1, bucket));
+}
+
+ClickIndex::StaffSymbols::StaffSymbols()
+    : myBuckets(static_cast<size_t>(
+          std::ceil(LayoutInfo::STAFF_WIDTH / BUCKET_WIDTH)))
+{
+}
+
+void ClickIndex::addRegion(const QRectF &rect, ClickType type, int staff,
+                           int position, const QString &toolTip)
+{
+    Q_ASSERT(!myStaves.empty());
+    StaffSymbols &symbols = mySymbols.back();
+
+    Region region;
+    region.myRect = rect.translated(-myStaves.back().myRect.topLeft());
+    region.myType = type;
+    region.myStaff = staff;
+    region.myPosition = position;
+    region.myToolTip = toolTip;
+
+    const int index = static_cast<int>(symbols.myRegions.size());
+    symbols.myRegions.push_back(region);
+
+    const int count = static_cast<int>(symbols.myBuckets.size());
+    const int first = getBucket(region.myRect.left(), count);
+    const int last = getBucket(region.myRect.right(), count);
+    for (int i = first; i <= last; ++i)
+        symbols.myBuckets[i].push_back(index);
+}
+
+void ClickIndex::addStaff(const QRectF &rect, int staff,
+                          const LayoutConstPtr &layout)
+{
+    StaffRegion region;
+    region.myRect = rect;
+    region.myStaff = staff;
+    region.myLayout = layout;
+    myStaves.push_back(region);
+    mySymbols.push_back(StaffSymbols());
+}
+
+void ClickIndex::copyStaff(const ClickIndex &other, int staff,
+                           const QRectF &rect)
+{
+    for (size_t i = 0; i < other.myStaves.size(); ++i)
+    {
+        if (other.myStaves[i].myStaff == staff)
+        {
+            // The symbols are relative to the staff, so they move along with
+            // it.
+            myStaves.push_back(other.myStaves[i]);
+            myStaves.back().myRect = rect;
+            mySymbols.push_back(other.mySymbols[i]);
+            return;
+        }
+    }
+
+    Q_ASSERT(false);
+}
+
+const ClickIndex::Region *ClickIndex::findRegion(const QPointF &pos) const
+{
+    const int staff = findStaffIndex(pos);
+    if (staff < 0)
+        return nullptr;
+
+    const QPointF staffPos = pos - myStaves[staff].myRect.topLeft();
+    const StaffSymbols &symbols = mySymbols[staff];
+    const std::vector<int> &bucket = symbols.myBuckets[getBucket(
+        staffPos.x(), static_cast<int>(symbols.myBuckets.size()))];
+
+    // Search from the most recently added region, which is on top.
+    for (auto it = bucket.rbegin(); it != bucket.rend(); ++it)
+    {
+        const Region &region = symbols.myRegions[*it];
+        if (region.myRect.contains(staffPos))
+            return &region;
+    }
+
+    return nullptr;
+}
+
+const ClickIndex::StaffRegion *ClickIndex::findStaff(const QPointF &pos) const
+{
+    const int staff = findStaffIndex(pos);
+    return staff >= 0 ? &myStaves[staff] : nullptr;
+}
+
+int ClickIndex::findStaffIndex(const QPointF &pos) const
+{
+    auto it = std::upper_bound(myStaves.begin(), myStaves.end(), pos.y(),
+                               [](double y, const StaffRegion &staff) {
+        return y < staff.myRect.top();
+    });
+
+    if (it == myStaves.begin())
+        return -1;
+
+    --it;
+    if (it->myRect.contains(pos))
+        return static_cast<int>(it - myStaves.begin());
+    else
+        return -1;
+}
@@ -0,0 +1,96 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_CLICKINDEX_H
+#define PAINTERS_CLICKINDEX_H
+
+#include <app/pubsub/clickpubsub.h>
+#include <painters/layoutinfo.h>
+#include <QRectF>
+#include <QString>
+#include <vector>
+
+/// Spatial index of the interactive regions in a rendered system (barlines,
+/// clefs, key and time signatures, and the staves). This allows mouse events
+/// to be resolved to score locations without searching the scene's items.
+/// The symbols are grouped by staff, so that a staff can be redrawn or moved
+/// without rebuilding the index for the rest of the system.
+class ClickIndex
+{
+public:
+    /// A symbol that can be clicked on.
+    struct Region
+    {
+        /// The symbol's bounds, relative to the top left of its staff.
+        QRectF myRect;
+        ClickType myType;
+        int myStaff;
+        int myPosition;
+        QString myToolTip;
+    };
+
+    /// A staff, where clicking selects a position and string.
+    struct StaffRegion
+    {
+        /// Returns the position index nearest to the x coordinate.
+        int getPosition(double x) const;
+        /// Returns the string at the y coordinate, or -1 if the coordinate is
+        /// not near any of the strings.
+        int getString(double y) const;
+
+        /// The staff's bounds, relative to the system.
+        QRectF myRect;
+        int myStaff;
+        LayoutConstPtr myLayout;
+    };
+
+    /// Adds a symbol (in system coordinates) to the most recently added
+    /// staff. The symbol is placed above any previously added symbols.
+    void addRegion(const QRectF &rect, ClickType type, int staff,
+                   int position, const QString &toolTip);
+    /// Adds a staff. Staves must be added from top to bottom.
+    void addStaff(const QRectF &rect, int staff, const LayoutConstPtr &layout);
+    /// Adds a staff and its symbols from another index, moving it to the
+    /// given bounds.
+    void copyStaff(const ClickIndex &other, int staff, const QRectF &rect);
+
+    /// Returns the topmost symbol at the given point, if any.
+    const Region *findRegion(const QPointF &pos) const;
+    /// Returns the staff at the given point, if any.
+    const StaffRegion *findStaff(const QPointF &pos) const;
+
+private:
+    /// The symbols of a staff.
+    struct StaffSymbols
+    {
+        StaffSymbols();
+
+        std::vector<Region> myRegions;
+        /// Indices of the regions that overlap each vertical strip of the
+        /// staff.
+        std::vector<std::vector<int>> myBuckets;
+    };
+
+    /// Returns the index of the staff containing the point, or -1.
+    int findStaffIndex(const QPointF &pos) const;
+
+    std::vector<StaffRegion> myStaves;
+    /// The symbols of each staff in myStaves.
+    std::vector<StaffSymbols> mySymbols;
+};
+
+#endif
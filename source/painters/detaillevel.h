@@ -0,0 +1,48 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_DETAILLEVEL_H
+#define PAINTERS_DETAILLEVEL_H
+
+/// Controls how much of the score is drawn, so that zoomed out views don't
+/// spend time painting symbols that are too small to be seen.
+enum class DetailLevel
+{
+    /// Everything is drawn.
+    Full,
+    /// The standard notation is replaced by note density bars, and small
+    /// symbols such as articulations are omitted.
+    Reduced,
+    /// Only the staves, barlines, rehearsal signs, and note density bars are
+    /// drawn.
+    Overview
+};
+
+/// Returns the level of detail for drawing the score at the given scale
+/// (e.g. 0.5 for a zoom level of 50%). The score is still readable at 50%,
+/// so only the smallest zoom levels switch to a simpler drawing.
+inline DetailLevel getDetailLevel(double scale)
+{
+    if (scale < 0.2)
+        return DetailLevel::Overview;
+    else if (scale < 0.4)
+        return DetailLevel::Reduced;
+    else
+        return DetailLevel::Full;
+}
+
+#endif
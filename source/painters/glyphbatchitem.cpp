@@ -0,0 +1,223 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "glyphbatchitem.h"
+
+#include <algorithm>
+#include <mutex>
+#include <QFontMetricsF>
+#include <QGlyphRun>
+#include <QHash>
+#include <QPainter>
+#include <QRawFont>
+#include <QStyleOptionGraphicsItem>
+#include <QThreadStorage>
+#include <unordered_map>
+
+namespace
+{
+/// The maximum number of strings in the shared cache. Scores only use a small
+/// set of fonts and strings (tab numbers, music symbols, etc), so this is
+/// only reached if many different documents have been opened.
+const size_t MAX_CACHED_RUNS = 10000;
+
+/// Returns the raw font for the current thread, since a QRawFont can't be
+/// used from a different thread than the one that created it.
+const QRawFont &getRawFont(const QFont &font, const QString &key)
+{
+    static QThreadStorage<QHash<QString, QRawFont>> theRawFonts;
+
+    QHash<QString, QRawFont> &rawFonts = theRawFonts.localData();
+    auto it = rawFonts.find(key);
+    if (it == rawFonts.end())
+        it = rawFonts.insert(key, QRawFont::fromFont(font));
+
+    return *it;
+}
+
+/// Shared cache of the glyphs for each string.
+class GlyphRunCache
+{
+public:
+    std::shared_ptr<const GlyphBatchItem::CachedRun> get(const QString &text,
+                                                         const QFont &font)
+    {
+        const QString fontKey = font.key();
+        const QString key = fontKey + QLatin1Char('\n') + text;
+
+        {
+            // Systems may be rendered from multiple threads.
+            std::lock_guard<std::mutex> lock(myMutex);
+            auto it = myRuns.find(key);
+            if (it != myRuns.end())
+                return it->second;
+        }
+
+        const QRawFont &rawFont = getRawFont(font, fontKey);
+
+        auto run = std::make_shared<GlyphBatchItem::CachedRun>();
+        run->myFont = font;
+        run->myFontKey = fontKey;
+        run->myGlyphs = rawFont.glyphIndexesForString(text);
+
+        const QVector<QPointF> advances =
+            rawFont.advancesForGlyphIndexes(run->myGlyphs);
+        run->myPositions.reserve(advances.size());
+        QPointF pos;
+        for (const QPointF &advance : advances)
+        {
+            run->myPositions.append(pos);
+            pos += advance;
+        }
+
+        // Use the same metrics as SimpleTextItem.
+        QFontMetricsF fm(font);
+        run->myWidth = fm.width(text);
+        run->myAscent = fm.ascent();
+        run->myHeight = fm.height();
+
+        std::lock_guard<std::mutex> lock(myMutex);
+        if (myRuns.size() >= MAX_CACHED_RUNS)
+            myRuns.clear();
+
+        return myRuns.emplace(key, std::move(run)).first->second;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myRuns.clear();
+    }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const QString &key) const { return qHash(key); }
+    };
+
+    std::mutex myMutex;
+    std::unordered_map<QString,
+                       std::shared_ptr<const GlyphBatchItem::CachedRun>,
+                       KeyHash> myRuns;
+};
+
+GlyphRunCache &getCache()
+{
+    static GlyphRunCache theCache;
+    return theCache;
+}
+}
+
+GlyphBatchItem::GlyphBatchItem() : myMaxWidth(0)
+{
+    // Provide the exposed rectangle to paint().
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+void GlyphBatchItem::addText(const QString &text, const QFont &font,
+                             const QPointF &pos, const QColor &color,
+                             const QColor &background)
+{
+    std::shared_ptr<const CachedRun> run = getCache().get(text, font);
+
+    Record record;
+    record.myRun = run;
+    record.myX = pos.x();
+    record.myY = pos.y();
+    record.myColor = color.rgba();
+    record.myBackground = background.rgba();
+
+    // The text is usually added from left to right, so this is normally an
+    // append. Records at the same x coordinate keep the order they were added
+    // in.
+    auto it = std::upper_bound(
+        myRecords.begin(), myRecords.end(), record.myX,
+        [](float x, const Record &other) { return x < other.myX; });
+    myRecords.insert(it, record);
+    myMaxWidth = std::max(myMaxWidth, run->myWidth);
+
+    prepareGeometryChange();
+    myBoundingRect |= QRectF(pos.x(), pos.y(), run->myWidth, run->myHeight);
+}
+
+double GlyphBatchItem::getTextWidth(const QString &text, const QFont &font)
+{
+    return getCache().get(text, font)->myWidth;
+}
+
+void GlyphBatchItem::clearCache()
+{
+    getCache().clear();
+}
+
+void GlyphBatchItem::paint(QPainter *painter,
+                           const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    QRgb currentColor = 0;
+    bool hasPen = false;
+    // The glyph run is built here rather than being cached, since its raw
+    // font belongs to the painting thread.
+    QGlyphRun glyphRun;
+
+    // Only draw the records that intersect the exposed area. A record can
+    // start to the left of the exposed area and still overlap it, by up to
+    // the width of the widest record.
+    QRectF exposed = option->exposedRect;
+    if (exposed.isEmpty())
+        exposed = myBoundingRect;
+
+    auto first = std::lower_bound(
+        myRecords.begin(), myRecords.end(), exposed.left() - myMaxWidth,
+        [](const Record &record, double x) { return record.myX < x; });
+
+    for (auto it = first; it != myRecords.end() && it->myX <= exposed.right();
+         ++it)
+    {
+        const Record &record = *it;
+        const CachedRun &run = *record.myRun;
+
+        if (!exposed.intersects(QRectF(record.myX, record.myY, run.myWidth,
+                                       run.myHeight)))
+        {
+            continue;
+        }
+
+        // Draw the background band, as in SimpleTextItem.
+        if (qAlpha(record.myBackground) != 0)
+        {
+            painter->fillRect(QRectF(record.myX,
+                                     record.myY + run.myHeight / 3,
+                                     run.myWidth, run.myHeight / 3),
+                              QColor::fromRgba(record.myBackground));
+        }
+
+        // Records with the same color are usually adjacent, so avoid
+        // changing the pen for each record.
+        if (!hasPen || record.myColor != currentColor)
+        {
+            painter->setPen(QColor::fromRgba(record.myColor));
+            currentColor = record.myColor;
+            hasPen = true;
+        }
+
+        glyphRun.setRawFont(getRawFont(run.myFont, run.myFontKey));
+        glyphRun.setGlyphIndexes(run.myGlyphs);
+        glyphRun.setPositions(run.myPositions);
+        painter->drawGlyphRun(QPointF(record.myX, record.myY + run.myAscent),
+                              glyphRun);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_GLYPHBATCHITEM_H
+#define PAINTERS_GLYPHBATCHITEM_H
+
+#include <memory>
+#include <QColor>
+#include <QFont>
+#include <QGraphicsItem>
+#include <QPointF>
+#include <QVector>
+#include <vector>
+
+/// Draws many short pieces of text (e.g. all of the tab numbers or note heads
+/// in a staff) from a single item, rather than creating an item for each of
+/// them. The glyphs for each string are computed once and shared between all
+/// items, and only the text in the exposed area is drawn.
+/// Items can be created on any thread. The fonts that are used for drawing
+/// are only ever used by the thread that created them.
+class GlyphBatchItem : public QGraphicsItem
+{
+public:
+    GlyphBatchItem();
+
+    /// Adds text whose top left corner is at the given position, aligned in
+    /// the same way as SimpleTextItem.
+    /// If a background color is given, a band through the middle of the text
+    /// is filled (e.g. to hide the staff line behind a tab number).
+    void addText(const QString &text, const QFont &font, const QPointF &pos,
+                 const QColor &color = Qt::black,
+                 const QColor &background = Qt::transparent);
+
+    /// Returns the width of the text, as used for alignment by addText().
+    static double getTextWidth(const QString &text, const QFont &font);
+
+    /// Releases the shared glyphs (e.g. after closing a document). Existing
+    /// items keep the glyphs that they use.
+    static void clearCache();
+
+    virtual QRectF boundingRect() const override { return myBoundingRect; }
+
+    virtual void paint(QPainter *painter,
+                       const QStyleOptionGraphicsItem *option,
+                       QWidget *widget) override;
+
+    /// Glyphs and metrics for a string in a particular font. This doesn't
+    /// hold a QRawFont, so that it can be shared between threads.
+    struct CachedRun
+    {
+        QFont myFont;
+        QString myFontKey;
+        QVector<quint32> myGlyphs;
+        QVector<QPointF> myPositions;
+        double myWidth;
+        double myAscent;
+        double myHeight;
+    };
+
+private:
+    struct Record
+    {
+        std::shared_ptr<const CachedRun> myRun;
+        float myX;
+        float myY;
+        QRgb myColor;
+        QRgb myBackground;
+    };
+
+    /// Sorted by their x coordinate, so that the records in the exposed area
+    /// can be found with a binary search.
+    std::vector<Record> myRecords;
+    /// The width of the widest record.
+    double myMaxWidth;
+    QRectF myBoundingRect;
+};
+
+#endif
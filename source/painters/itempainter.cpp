@@ -0,0 +1,67 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "itempainter.h"
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+static bool isBehindParent(const QGraphicsItem *item)
+{
+    return item->zValue() < 0 ||
+           (item->flags() & QGraphicsItem::ItemStacksBehindParent);
+}
+
+static void paintItem(QPainter *painter, QGraphicsItem *item,
+                      const QGraphicsItem *root, const QGraphicsItem *skip,
+                      const QTransform &baseTransform)
+{
+    if (item == skip || !item->isVisible())
+        return;
+
+    // The children are sorted by their stacking order.
+    const QList<QGraphicsItem *> children = item->childItems();
+    for (QGraphicsItem *child : children)
+    {
+        if (isBehindParent(child))
+            paintItem(painter, child, root, skip, baseTransform);
+    }
+
+    painter->save();
+    painter->setWorldTransform(item->itemTransform(root) * baseTransform);
+    painter->setOpacity(item->effectiveOpacity());
+
+    QStyleOptionGraphicsItem option;
+    option.exposedRect = item->boundingRect();
+    option.rect = option.exposedRect.toAlignedRect();
+    item->paint(painter, &option, nullptr);
+
+    painter->restore();
+
+    for (QGraphicsItem *child : children)
+    {
+        if (!isBehindParent(child))
+            paintItem(painter, child, root, skip, baseTransform);
+    }
+}
+
+void ItemPainter::paintTree(QPainter *painter, QGraphicsItem *root,
+                            const QGraphicsItem *skip)
+{
+    paintItem(painter, root, root, skip, painter->worldTransform());
+}
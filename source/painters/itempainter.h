@@ -0,0 +1,33 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_ITEMPAINTER_H
+#define PAINTERS_ITEMPAINTER_H
+
+class QGraphicsItem;
+class QPainter;
+
+namespace ItemPainter
+{
+/// Paints an item and its children in the same order as the scene would, but
+/// without requiring the items to be added to a scene. The item to skip (and
+/// its children) are not painted.
+void paintTree(QPainter *painter, QGraphicsItem *root,
+               const QGraphicsItem *skip = nullptr);
+}
+
+#endif
@@ -17,48 +17,21 @@
   
 #include "keysignaturepainter.h"
 
-#include <app/pubsub/clickpubsub.h>
 #include <painters/musicfont.h>
-#include <QCursor>
 #include <QPainter>
 #include <score/keysignature.h>
 
-KeySignaturePainter::KeySignaturePainter(
-    const LayoutConstPtr &layout, const KeySignature &key,
-    const ScoreLocation &location, const std::shared_ptr<ClickPubSub> &pubsub)
+KeySignaturePainter::KeySignaturePainter(const LayoutConstPtr &layout,
+                                         const KeySignature &key)
     : myLayout(layout),
       myKeySignature(key),
-      myLocation(location),
-      myPubSub(pubsub),
       myMusicFont(MusicFont::getFont(MusicFont::DEFAULT_FONT_SIZE)),
       myBounds(0, -10, LayoutInfo::getWidth(myKeySignature),
                layout->getStdNotationStaffHeight())
 {
-    setAcceptHoverEvents(true);
-    setToolTip(QObject::tr("Click to edit key signature."));
     initAccidentalPositions();
 }
 
-void KeySignaturePainter::mousePressEvent(QGraphicsSceneMouseEvent *)
-{
-    // No action is needed here, but this will let us grab future mouse events.
-}
-
-void KeySignaturePainter::mouseReleaseEvent(QGraphicsSceneMouseEvent *)
-{
-    myPubSub->publish(ClickType::KeySignature, myLocation);
-}
-
-void KeySignaturePainter::hoverEnterEvent(QGraphicsSceneHoverEvent *)
-{
-    setCursor(Qt::PointingHandCursor);
-}
-
-void KeySignaturePainter::hoverLeaveEvent(QGraphicsSceneHoverEvent *)
-{
-    unsetCursor();
-}
-
 void KeySignaturePainter::paint(QPainter *painter,
                                 const QStyleOptionGraphicsItem*, QWidget*)
 {
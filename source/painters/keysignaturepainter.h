@@ -22,16 +22,11 @@
 #include <QFont>
 #include <QGraphicsItem>
 #include <painters/layoutinfo.h>
-#include <score/scorelocation.h>
-
-class ClickPubSub;
 
 class KeySignaturePainter : public QGraphicsItem
 {
 public:
-    KeySignaturePainter(const LayoutConstPtr &layout, const KeySignature &key,
-                        const ScoreLocation &location,
-                        const std::shared_ptr<ClickPubSub> &pubsub);
+    KeySignaturePainter(const LayoutConstPtr &layout, const KeySignature &key);
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                        QWidget *) override;
@@ -41,15 +36,8 @@ public:
     }
 
 private:
-    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void hoverEnterEvent(QGraphicsSceneHoverEvent *) override;
-    virtual void hoverLeaveEvent(QGraphicsSceneHoverEvent *) override;
-
     LayoutConstPtr myLayout;
     const KeySignature &myKeySignature;
-    const ScoreLocation myLocation;
-    std::shared_ptr<ClickPubSub> myPubSub;
     QFont myMusicFont;
     const QRectF myBounds;
     QVector<double> myFlatPositions;
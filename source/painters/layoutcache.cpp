@@ -0,0 +1,107 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "layoutcache.h"
+
+#include <algorithm>
+#include <score/score.h>
+
+LayoutCache::Entry LayoutCache::makeEntry(const Score &score,
+                                          const System &system,
+                                          int systemIndex, const Staff &staff)
+{
+    Entry entry;
+    entry.mySystem = &system;
+    entry.mySystemOwnRevision = system.getOwnRevision();
+    entry.myNumPositions = LayoutInfo::findNumPositions(system);
+    entry.myStaff = &staff;
+    entry.myStaffRevision = staff.getRevision();
+    entry.myLineSpacing = score.getLineSpacing();
+
+    if (const PlayerChange *players =
+            ScoreUtils::getCurrentPlayers(score, systemIndex, 0))
+    {
+        entry.myPlayers = *players;
+    }
+
+    return entry;
+}
+
+LayoutConstPtr LayoutCache::getLayout(const Score &score, const System &system,
+                                      int systemIndex, const Staff &staff,
+                                      int staffIndex)
+{
+    Entry entry = makeEntry(score, system, systemIndex, staff);
+    const auto key = std::make_pair(systemIndex, staffIndex);
+
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+
+        // The system and staff addresses are compared as well, since a copy
+        // of a system (e.g. from an undo snapshot) keeps the same revision
+        // but the layout refers to the original object.
+        auto it = myEntries.find(key);
+        if (it != myEntries.end())
+        {
+            const Entry &cached = it->second;
+            if (cached.mySystem == entry.mySystem &&
+                cached.mySystemOwnRevision == entry.mySystemOwnRevision &&
+                cached.myNumPositions == entry.myNumPositions &&
+                cached.myStaff == entry.myStaff &&
+                cached.myStaffRevision == entry.myStaffRevision &&
+                cached.myLineSpacing == entry.myLineSpacing &&
+                cached.myPlayers == entry.myPlayers)
+            {
+                return cached.myLayout;
+            }
+        }
+    }
+
+    // Compute the layout without holding the lock, so that other staves can
+    // be laid out concurrently.
+    entry.myLayout = std::make_shared<LayoutInfo>(score, system, systemIndex,
+                                                  staff, staffIndex);
+
+    std::lock_guard<std::mutex> lock(myMutex);
+    myEntries[key] = entry;
+    return entry.myLayout;
+}
+
+void LayoutCache::update(const Score &score)
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    if (myPlayers.size() != score.getPlayers().size() ||
+        !std::equal(myPlayers.begin(), myPlayers.end(),
+                    score.getPlayers().begin()))
+    {
+        myEntries.clear();
+        myPlayers.assign(score.getPlayers().begin(), score.getPlayers().end());
+        return;
+    }
+
+    const int numSystems = static_cast<int>(score.getSystems().size());
+    myEntries.erase(myEntries.lower_bound(std::make_pair(numSystems, 0)),
+                    myEntries.end());
+}
+
+void LayoutCache::clear()
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+    myEntries.clear();
+    myPlayers.clear();
+}
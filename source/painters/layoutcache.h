@@ -0,0 +1,81 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_LAYOUTCACHE_H
+#define PAINTERS_LAYOUTCACHE_H
+
+#include <boost/optional/optional.hpp>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <painters/layoutinfo.h>
+#include <score/player.h>
+#include <score/playerchange.h>
+#include <utility>
+#include <vector>
+
+class Score;
+class Staff;
+class System;
+
+/// Caches the layout of each staff in a score, so that the layouts can be
+/// shared by the system renderer, the caret, etc. A layout is reused until
+/// its staff or the system's own symbols are modified. Modifying another staff
+/// in the system only invalidates the layout if the number of positions in
+/// the system changes, so that the system can be partially redrawn.
+/// This can be used from multiple threads.
+class LayoutCache
+{
+public:
+    /// Returns the layout for the staff, computing it if necessary.
+    LayoutConstPtr getLayout(const Score &score, const System &system,
+                             int systemIndex, const Staff &staff,
+                             int staffIndex);
+
+    /// Discards any layouts that depend on score-wide data that has changed
+    /// (e.g. the players' tunings), and layouts of systems that have been
+    /// removed.
+    void update(const Score &score);
+
+    /// Discards all of the cached layouts.
+    void clear();
+
+private:
+    struct Entry
+    {
+        const System *mySystem;
+        uint64_t mySystemOwnRevision;
+        int myNumPositions;
+        const Staff *myStaff;
+        uint64_t myStaffRevision;
+        int myLineSpacing;
+        /// The players that are active at the start of the system, which
+        /// may come from a player change in a previous system.
+        boost::optional<PlayerChange> myPlayers;
+        LayoutConstPtr myLayout;
+    };
+
+    static Entry makeEntry(const Score &score, const System &system,
+                           int systemIndex, const Staff &staff);
+
+    std::mutex myMutex;
+    /// Cached layouts, indexed by the system and staff index.
+    std::map<std::pair<int, int>, Entry> myEntries;
+    std::vector<Player> myPlayers;
+};
+
+#endif
@@ -17,6 +17,7 @@
   
 #include "layoutinfo.h"
 
+#include <algorithm>
 #include <boost/algorithm/clamp.hpp>
 #include <painters/verticallayout.h>
 #include <score/keysignature.h>
@@ -55,6 +56,7 @@ LayoutInfo::LayoutInfo(const Score &score, const System &system, int systemIndex
       myStdNotationStaffBelowSpacing(0)
 {
     computePositionSpacing();
+    computePositionXs();
     calculateTabStaffBelowLayout();
     calculateTabStaffAboveLayout();
 
@@ -216,6 +218,9 @@ double LayoutInfo::getFirstPositionX() const
 
 double LayoutInfo::getPositionX(int position) const
 {
+    if (position >= 0 && position < static_cast<int>(myPositionXs.size()))
+        return myPositionXs[position];
+
     double x = getFirstPositionX();
     // Include the width of all key/time signatures.
     x += getCumulativeBarlineWidths(position);
@@ -230,14 +235,18 @@ int LayoutInfo::getPositionFromX(double x) const
         return 0;
 
     const int maxPosition = getNumPositions() - 1;
+    if (maxPosition < 1)
+        return maxPosition;
 
-    for (int i = 1; i <= maxPosition; ++i)
-    {
-        if (getPositionX(i) >= x)
-            return i - 1;
-    }
+    // The positions are in increasing order, so find the first position that
+    // is past x.
+    auto begin = myPositionXs.begin() + 1;
+    auto end = myPositionXs.begin() + maxPosition + 1;
+    auto it = std::lower_bound(begin, end, x);
+    if (it == end)
+        return maxPosition;
 
-    return maxPosition;
+    return static_cast<int>(it - myPositionXs.begin()) - 1;
 }
 
 double LayoutInfo::getWidth(const KeySignature &key)
@@ -320,35 +329,61 @@ static void updateMaxPosition(int &max, const Range &range)
         max = std::max(max, obj.getPosition());
 }
 
-void LayoutInfo::computePositionSpacing()
+int LayoutInfo::findNumPositions(const System &system)
 {
-    const double width = getFirstPositionX() + getCumulativeBarlineWidths();
+    int numPositions = 0;
 
-    // Find the number of positions needed for the system.
-    for (const Staff &staff : mySystem.getStaves())
+    for (const Staff &staff : system.getStaves())
     {
         for (const Voice &voice : staff.getVoices())
         {
             for (const Position &position : voice.getPositions())
-            {
-                myNumPositions = std::max(myNumPositions,
-                                          position.getPosition());
-            }
+                numPositions = std::max(numPositions, position.getPosition());
         }
     }
 
-    updateMaxPosition(myNumPositions, mySystem.getBarlines());
-    updateMaxPosition(myNumPositions, mySystem.getTempoMarkers());
-    updateMaxPosition(myNumPositions, mySystem.getAlternateEndings());
-    updateMaxPosition(myNumPositions, mySystem.getChords());
-    updateMaxPosition(myNumPositions, mySystem.getTextItems());
-    updateMaxPosition(myNumPositions, mySystem.getDirections());
-    updateMaxPosition(myNumPositions, mySystem.getPlayerChanges());
+    updateMaxPosition(numPositions, system.getBarlines());
+    updateMaxPosition(numPositions, system.getTempoMarkers());
+    updateMaxPosition(numPositions, system.getAlternateEndings());
+    updateMaxPosition(numPositions, system.getChords());
+    updateMaxPosition(numPositions, system.getTextItems());
+    updateMaxPosition(numPositions, system.getDirections());
+    updateMaxPosition(numPositions, system.getPlayerChanges());
+
+    return numPositions;
+}
+
+void LayoutInfo::computePositionSpacing()
+{
+    const double width = getFirstPositionX() + getCumulativeBarlineWidths();
+
+    // Find the number of positions needed for the system.
+    myNumPositions = findNumPositions(mySystem);
 
     const double availableSpace = STAFF_WIDTH - width;
     myPositionSpacing = availableSpace / (myNumPositions + 2);
 }
 
+void LayoutInfo::computePositionXs()
+{
+    myPositionXs.reserve(myNumPositions + 1);
+
+    // Accumulate the widths of the barlines in a single pass, rather than
+    // calling getPositionX() for each position.
+    const auto &barlines = mySystem.getBarlines();
+    const size_t lastBar = barlines.size() - 1;
+    size_t bar = 1;
+    double x = getFirstPositionX();
+
+    for (int i = 0; i <= myNumPositions; ++i)
+    {
+        for (; bar < lastBar && barlines[bar].getPosition() < i; ++bar)
+            x += getWidth(barlines[bar]);
+
+        myPositionXs.push_back(x + (i + 1) * getPositionSpacing());
+    }
+}
+
 void LayoutInfo::calculateTabStaffBelowLayout()
 {
     for (const Voice &voice : myStaff.getVoices())
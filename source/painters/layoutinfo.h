@@ -152,6 +152,10 @@ struct LayoutInfo
         return (xmin + ((xmax - (xmin + width)) / 2) + 1);
     }
 
+    /// Returns the number of positions needed for the notes and symbols in
+    /// all of the system's staves.
+    static int findNumPositions(const System &system);
+
     static double getWidth(const KeySignature &key);
     static double getWidth(const TimeSignature &time);
     static double getWidth(const Barline &bar);
@@ -179,6 +183,9 @@ private:
     /// Compute an optimal position spacing for the system.
     void computePositionSpacing();
 
+    /// Caches the x-coordinate of each position.
+    void computePositionXs();
+
     /// Compute the spacing and layout of symbols that are drawn below the
     /// tab staff.
     void calculateTabStaffBelowLayout();
@@ -211,6 +218,7 @@ private:
     int myLineSpacing;
     double myPositionSpacing;
     int myNumPositions;
+    std::vector<double> myPositionXs;
 
     std::vector<SymbolGroup> myTabStaffBelowSymbols;
     double myTabStaffBelowSpacing;
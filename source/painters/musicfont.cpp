@@ -27,3 +27,12 @@ QFont MusicFont::getFont(int pixel_size)
     font.setPixelSize(pixel_size);
     return font;
 }
+
+void MusicFont::loadFonts()
+{
+    // Load the music notation font.
+    QFontDatabase::addApplicationFont(":fonts/emmentaler-13.otf");
+    // Load the tab note font.
+    QFontDatabase::addApplicationFont(":fonts/LiberationSans-Regular.ttf");
+    QFontDatabase::addApplicationFont(":fonts/LiberationSerif-Regular.ttf");
+}
@@ -88,6 +88,10 @@ public:
     static const int GRACE_NOTE_SIZE = 15;
 
     static QFont getFont(int pixel_size);
+
+    /// Registers the music notation font and the text fonts that are bundled
+    /// with the application.
+    static void loadFonts();
 };
 
 #endif
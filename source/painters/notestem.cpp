@@ -19,7 +19,8 @@
 
 #include <painters/layoutinfo.h>
 #include <score/position.h>
-#include <score/voiceutils.h>
+#include <score/ticks.h>
+#include <score/voice.h>
 
 NoteStem::NoteStem(const Voice &voice, const Position &pos, double x,
                    double noteHeadWidth,
@@ -103,8 +104,10 @@ double NoteStem::getNoteHeadWidth() const
 
 double NoteStem::getDurationTime() const
 {
-    return boost::rational_cast<double>(
-        VoiceUtils::getDurationTime(*myVoice, *myPosition));
+    const VoiceTimeline &timeline = myVoice->getTimeline();
+    const int64_t duration =
+        timeline.getDuration(timeline.findIndex(myPosition->getPosition()));
+    return static_cast<double>(duration) / Ticks::PER_QUARTER;
 }
 
 int NoteStem::getPositionIndex() const
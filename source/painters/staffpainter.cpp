@@ -17,49 +17,12 @@
   
 #include "staffpainter.h"
 
-#include <app/pubsub/clickpubsub.h>
-#include <cmath>
-#include <QGraphicsSceneMouseEvent>
 #include <QPainter>
 
-StaffPainter::StaffPainter(const LayoutConstPtr &layout,
-                           const ScoreLocation &location,
-                           const std::shared_ptr<ClickPubSub> &pubsub)
+StaffPainter::StaffPainter(const LayoutConstPtr &layout)
     : myLayout(layout),
-      myPubSub(pubsub),
-      myLocation(location),
       myBounds(0, 0, LayoutInfo::STAFF_WIDTH, layout->getStaffHeight())
 {
-    // Only use the left mouse button for making selections.
-    setAcceptedMouseButtons(Qt::LeftButton);
-}
-
-void StaffPainter::mousePressEvent(QGraphicsSceneMouseEvent *event)
-{
-    const double x = event->pos().x();
-    const double y = event->pos().y();
-
-    // Find the position relative to the top of the staff, in terms of the tab
-    // line spacing. Then, round it to find the string index.
-    const int string = std::floor(((y - myLayout->getTopTabLine()) /
-                                   myLayout->getTabLineSpacing()) + 0.5);
-
-    if (string >= 0 && string < myLayout->getStringCount())
-    {
-        const int position = myLayout->getPositionFromX(x);
-        myLocation.setPositionIndex(position);
-        myLocation.setSelectionStart(position);
-        myLocation.setString(string);
-
-        myPubSub->publish(ClickType::Selection, myLocation);
-    }
-}
-
-void StaffPainter::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
-{
-    const double x = event->pos().x();
-    myLocation.setPositionIndex(myLayout->getPositionFromX(x));
-    myPubSub->publish(ClickType::Selection, myLocation);
 }
 
 void StaffPainter::paint(QPainter *painter, const QStyleOptionGraphicsItem *,
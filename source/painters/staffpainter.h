@@ -18,20 +18,13 @@
 #ifndef PAINTERS_STAFFPAINTER_H
 #define PAINTERS_STAFFPAINTER_H
 
-#include <memory>
 #include <painters/layoutinfo.h>
 #include <QGraphicsItem>
-#include <score/scorelocation.h>
-
-class ScoreLocation;
-class ClickPubSub;
-class Staff;
 
 class StaffPainter : public QGraphicsItem
 {
 public:
-    StaffPainter(const LayoutConstPtr &layout, const ScoreLocation &location,
-                 const std::shared_ptr<ClickPubSub> &pubsub);
+    explicit StaffPainter(const LayoutConstPtr &layout);
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                        QWidget *) override;
@@ -41,18 +34,17 @@ public:
         return myBounds;
     }
 
-protected:
-    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
+    /// Returns the layout that the staff was drawn with.
+    const LayoutConstPtr &getLayout() const
+    {
+        return myLayout;
+    }
 
 private:
     void drawStaffLines(QPainter *painter, int lineCount, double lineSpacing,
                         double startHeight);
-    int getPositionFromX(double x) const;
 
     LayoutConstPtr myLayout;
-    std::shared_ptr<ClickPubSub> myPubSub;
-    ScoreLocation myLocation;
     const QRectF myBounds;
 };
 
@@ -0,0 +1,221 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "systemrastercache.h"
+
+#include <cmath>
+#include <painters/itempainter.h>
+#include <QPainter>
+
+/// Default memory budget, which is enough for a few hundred systems.
+static const int64_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+
+/// Largest image (in pixels along either side) that will be cached. Systems
+/// that are larger than this at the current zoom level are painted directly.
+static const int MAX_IMAGE_SIZE = 8192;
+
+SystemRasterCache::SystemRasterCache() : myBudget(DEFAULT_BUDGET), myUsage(0)
+{
+}
+
+SystemRasterCache &SystemRasterCache::getInstance()
+{
+    static SystemRasterCache theCache;
+    return theCache;
+}
+
+void SystemRasterCache::setBudget(int64_t bytes)
+{
+    myBudget = bytes;
+    evict();
+}
+
+const QPixmap *SystemRasterCache::find(uint64_t item, double scale,
+                                       int pixelRatio)
+{
+    auto it = myIndex.find(item);
+    if (it == myIndex.end())
+        return nullptr;
+
+    EntryList::iterator entry = it->second;
+    if (entry->myScale != scale || entry->myPixelRatio != pixelRatio)
+        return nullptr;
+
+    // Mark the entry as the most recently used.
+    myEntries.splice(myEntries.begin(), myEntries, entry);
+    return &entry->myPixmap;
+}
+
+void SystemRasterCache::insert(uint64_t item, void *group, double scale,
+                               int pixelRatio, const QPixmap &pixmap)
+{
+    remove(item);
+
+    Entry entry;
+    entry.myItem = item;
+    entry.myGroup = group;
+    entry.myScale = scale;
+    entry.myPixelRatio = pixelRatio;
+    entry.myPixmap = pixmap;
+    entry.mySize = static_cast<int64_t>(pixmap.width()) * pixmap.height() *
+                   pixmap.depth() / 8;
+
+    myEntries.push_front(entry);
+    myIndex[item] = myEntries.begin();
+    myUsage += entry.mySize;
+
+    evict();
+}
+
+void SystemRasterCache::remove(uint64_t item)
+{
+    auto it = myIndex.find(item);
+    if (it != myIndex.end())
+        erase(it->second);
+}
+
+void SystemRasterCache::removeGroup(void *group)
+{
+    for (auto it = myEntries.begin(); it != myEntries.end();)
+    {
+        auto next = std::next(it);
+        if (it->myGroup == group)
+            erase(it);
+        it = next;
+    }
+}
+
+void SystemRasterCache::erase(EntryList::iterator entry)
+{
+    myUsage -= entry->mySize;
+    myIndex.erase(entry->myItem);
+    myEntries.erase(entry);
+}
+
+void SystemRasterCache::evict()
+{
+    while (myUsage > myBudget && !myEntries.empty())
+        erase(std::prev(myEntries.end()));
+}
+
+/// Key for marking the items that were disabled by disablePainting(), as
+/// opposed to items that never paint anything (e.g. item groups).
+static const int PAINTING_DISABLED_KEY = 0;
+
+/// Marks the item and its children as not painting anything, so that only
+/// the cached image is drawn by the scene.
+static void disablePainting(QGraphicsItem *item)
+{
+    if (!(item->flags() & QGraphicsItem::ItemHasNoContents))
+    {
+        item->setFlag(QGraphicsItem::ItemHasNoContents, true);
+        item->setData(PAINTING_DISABLED_KEY, true);
+    }
+
+    for (QGraphicsItem *child : item->childItems())
+        disablePainting(child);
+}
+
+void CachedSystemItem::enablePainting(QGraphicsItem *item)
+{
+    if (item->data(PAINTING_DISABLED_KEY).toBool())
+    {
+        item->setFlag(QGraphicsItem::ItemHasNoContents, false);
+        item->setData(PAINTING_DISABLED_KEY, QVariant());
+    }
+
+    for (QGraphicsItem *child : item->childItems())
+        enablePainting(child);
+}
+
+static uint64_t theNextId = 1;
+
+CachedSystemItem::CachedSystemItem(QGraphicsItem *system, void *group)
+    : myId(theNextId++),
+      mySystem(system),
+      myGroup(group),
+      myBounds(system->boundingRect() | system->childrenBoundingRect())
+{
+    disablePainting(system);
+
+    setAcceptedMouseButtons(Qt::NoButton);
+    setParentItem(system);
+}
+
+CachedSystemItem::~CachedSystemItem()
+{
+    SystemRasterCache::getInstance().remove(myId);
+}
+
+void CachedSystemItem::paint(QPainter *painter,
+                             const QStyleOptionGraphicsItem *, QWidget *widget)
+{
+    // Draw directly when not painting to the view (e.g. when printing).
+    if (!widget)
+    {
+        paintSystem(painter);
+        return;
+    }
+
+    // The view only scales and translates the scene.
+    const QTransform transform = painter->worldTransform();
+    const double scale = transform.m11();
+    const int pixelRatio = painter->device()->devicePixelRatio();
+
+    const QSize size(
+        static_cast<int>(std::ceil(myBounds.width() * scale * pixelRatio)),
+        static_cast<int>(std::ceil(myBounds.height() * scale * pixelRatio)));
+    if (size.isEmpty() || size.width() > MAX_IMAGE_SIZE ||
+        size.height() > MAX_IMAGE_SIZE)
+    {
+        paintSystem(painter);
+        return;
+    }
+
+    SystemRasterCache &cache = SystemRasterCache::getInstance();
+    QPixmap pixmap;
+    if (const QPixmap *cached = cache.find(myId, scale, pixelRatio))
+        pixmap = *cached;
+    else
+    {
+        pixmap = QPixmap(size);
+        pixmap.fill(Qt::transparent);
+
+        QPainter imagePainter(&pixmap);
+        imagePainter.setRenderHints(painter->renderHints());
+        imagePainter.scale(scale * pixelRatio, scale * pixelRatio);
+        imagePainter.translate(-myBounds.topLeft());
+        paintSystem(&imagePainter);
+        imagePainter.end();
+
+        pixmap.setDevicePixelRatio(pixelRatio);
+        cache.insert(myId, myGroup, scale, pixelRatio, pixmap);
+    }
+
+    // Draw the image without any scaling, aligned to the device pixels.
+    const QPointF topLeft = transform.map(myBounds.topLeft());
+    painter->save();
+    painter->resetTransform();
+    painter->drawPixmap(
+        QPointF(std::round(topLeft.x()), std::round(topLeft.y())), pixmap);
+    painter->restore();
+}
+
+void CachedSystemItem::paintSystem(QPainter *painter) const
+{
+    ItemPainter::paintTree(painter, mySystem, this);
+}
@@ -0,0 +1,110 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAINTERS_SYSTEMRASTERCACHE_H
+#define PAINTERS_SYSTEMRASTERCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <QGraphicsItem>
+#include <QPixmap>
+#include <unordered_map>
+
+/// Stores rasterized systems for all open documents, and evicts the least
+/// recently used images when the memory budget is exceeded.
+class SystemRasterCache
+{
+public:
+    SystemRasterCache();
+
+    /// Returns the cache that is shared by all score areas.
+    static SystemRasterCache &getInstance();
+
+    /// Sets the maximum amount of memory used by the images.
+    void setBudget(int64_t bytes);
+    int64_t getBudget() const { return myBudget; }
+    /// Returns the amount of memory used by the images.
+    int64_t getUsage() const { return myUsage; }
+
+    /// Returns the image for the item, if it was rendered at the given scale
+    /// and device pixel ratio.
+    const QPixmap *find(uint64_t item, double scale, int pixelRatio);
+    /// Stores the image for the item, replacing any previous image.
+    void insert(uint64_t item, void *group, double scale, int pixelRatio,
+                const QPixmap &pixmap);
+
+    /// Discards the image for an item.
+    void remove(uint64_t item);
+    /// Discards the images for all items in a group (e.g. a score area).
+    void removeGroup(void *group);
+
+private:
+    struct Entry
+    {
+        uint64_t myItem;
+        void *myGroup;
+        double myScale;
+        int myPixelRatio;
+        QPixmap myPixmap;
+        int64_t mySize;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    void erase(EntryList::iterator entry);
+    void evict();
+
+    /// Entries in order of most to least recently used.
+    EntryList myEntries;
+    std::unordered_map<uint64_t, EntryList::iterator> myIndex;
+    int64_t myBudget;
+    int64_t myUsage;
+};
+
+/// Draws a rendered system and all of its child items from an image that is
+/// cached for the current zoom level, rather than repainting every item. The
+/// child items still provide tooltips, but no longer paint themselves.
+/// Other items in the scene (e.g. the caret) are painted normally on top.
+class CachedSystemItem : public QGraphicsItem
+{
+public:
+    /// Caches the drawing of the system. This item becomes a child of the
+    /// system, and the image is stored in the group's cache.
+    CachedSystemItem(QGraphicsItem *system, void *group);
+    ~CachedSystemItem();
+
+    /// Lets a system that was drawn from an image paint itself again, after
+    /// its CachedSystemItem was removed.
+    static void enablePainting(QGraphicsItem *system);
+
+    virtual QRectF boundingRect() const override { return myBounds; }
+
+    virtual void paint(QPainter *painter,
+                       const QStyleOptionGraphicsItem *option,
+                       QWidget *widget) override;
+
+private:
+    /// Paints the system and its children directly.
+    void paintSystem(QPainter *painter) const;
+
+    const uint64_t myId;
+    QGraphicsItem *mySystem;
+    void *myGroup;
+    QRectF myBounds;
+};
+
+#endif
@@ -17,8 +17,6 @@
 
 #include "systemrenderer.h"
 
-#include <app/pubsub/clickpubsub.h>
-#include <app/scorearea.h>
 #include <app/viewoptions.h>
 #include <boost/algorithm/clamp.hpp>
 #include <boost/lexical_cast.hpp>
@@ -26,8 +24,9 @@
 #include <boost/range/algorithm/find_if.hpp>
 #include <painters/antialiasedpathitem.h>
 #include <painters/barlinepainter.h>
-#include <painters/clickablegroup.h>
+#include <painters/glyphbatchitem.h>
 #include <painters/keysignaturepainter.h>
+#include <painters/layoutcache.h>
 #include <painters/layoutinfo.h>
 #include <painters/simpletextitem.h>
 #include <painters/staffpainter.h>
@@ -39,10 +38,10 @@
 #include <QGraphicsItem>
 #include <QPen>
 #include <score/score.h>
-#include <score/scorelocation.h>
 #include <score/system.h>
 #include <score/utils.h>
 #include <score/voiceutils.h>
+#include <unordered_map>
 
 void SystemRenderer::centerHorizontally(QGraphicsItem &item, double xmin,
                                         double xmax)
@@ -58,11 +57,14 @@ void SystemRenderer::centerSymbolVertically(QGraphicsItem &item, double y)
                          item.boundingRect().height()));
 }
 
-SystemRenderer::SystemRenderer(const ScoreArea *score_area, const Score &score,
-                               const ViewOptions &view_options)
-    : myScoreArea(score_area),
-      myScore(score),
+SystemRenderer::SystemRenderer(const Score &score,
+                               const ViewOptions &view_options,
+                               const std::shared_ptr<LayoutCache> &layoutCache,
+                               DetailLevel detailLevel)
+    : myScore(score),
       myViewOptions(view_options),
+      myLayoutCache(layoutCache),
+      myDetailLevel(detailLevel),
       myParentSystem(nullptr),
       myParentStaff(nullptr),
       myMusicNotationFont(MusicFont::getFont(MusicFont::DEFAULT_FONT_SIZE)),
@@ -80,28 +82,25 @@ SystemRenderer::SystemRenderer(const ScoreArea *score_area, const Score &score,
 QGraphicsItem *SystemRenderer::operator()(const System &system,
                                           int systemIndex)
 {
+    myClickIndex = ClickIndex();
+
     // Draw the bounding rectangle for the system.
     myParentSystem = new QGraphicsRectItem();
     myParentSystem->setPen(QPen(QBrush(QColor(0, 0, 0, 127)), 0.5));
 
-    const ViewFilter *filter =
-        myViewOptions.getFilter()
-            ? &myScore.getViewFilters()[*myViewOptions.getFilter()]
-            : nullptr;
-
     // Draw each staff.
     double height = 0;
     int i = 0;
     for (const Staff &staff : system.getStaves())
     {
-        if (filter && !filter->accept(myScore, systemIndex, i))
+        if (!isStaffVisible(systemIndex, i))
         {
             ++i;
             continue;
         }
 
         const bool isFirstStaff = (height == 0);
-        LayoutConstPtr layout = std::make_shared<LayoutInfo>(
+        LayoutConstPtr layout = myLayoutCache->getLayout(
             myScore, system, systemIndex, staff, i);
 
         if (isFirstStaff)
@@ -110,37 +109,140 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
             height += layout->getSystemSymbolSpacing();
         }
 
-        myParentStaff = new StaffPainter(layout,
-                                         ScoreLocation(myScore, systemIndex, i),
-                                         myScoreArea->getClickPubSub());
-        myParentStaff->setPos(0, height);
-        myParentStaff->setParentItem(myParentSystem);
+        drawStaff(system, systemIndex, staff, i, layout, height, isFirstStaff,
+                  isFirstStaff);
         height += layout->getStaffHeight();
+        ++i;
+    }
+
+    myParentSystem->setRect(0, 0, LayoutInfo::STAFF_WIDTH, height);
+    return myParentSystem;
+}
+
+bool SystemRenderer::redrawStaves(QGraphicsItem *renderedSystem,
+                                  const ClickIndex &clickIndex,
+                                  const System &system, int systemIndex)
+{
+    myParentSystem = qgraphicsitem_cast<QGraphicsRectItem *>(renderedSystem);
+    Q_ASSERT(myParentSystem);
+
+    // Find the previously drawn staves. A layout is only reused if the staff
+    // is unmodified and the system's spacing is unchanged.
+    std::unordered_map<const LayoutInfo *, StaffPainter *> oldStaves;
+    for (QGraphicsItem *item : myParentSystem->childItems())
+    {
+        if (auto painter = dynamic_cast<StaffPainter *>(item))
+            oldStaves[painter->getLayout().get()] = painter;
+    }
+
+    std::vector<std::pair<int, LayoutConstPtr>> layouts;
+    bool canReuse = false;
+    int i = 0;
+    for (const Staff &staff : system.getStaves())
+    {
+        if (isStaffVisible(systemIndex, i))
+        {
+            LayoutConstPtr layout = myLayoutCache->getLayout(
+                myScore, system, systemIndex, staff, i);
+            canReuse |= oldStaves.find(layout.get()) != oldStaves.end();
+            layouts.emplace_back(i, layout);
+        }
+
+        ++i;
+    }
+
+    // If none of the staves can be kept, the system's own symbols (which are
+    // kept as well) may also have changed.
+    if (!canReuse)
+        return false;
 
+    myClickIndex = ClickIndex();
+    double height = layouts.front().second->getSystemSymbolSpacing();
+
+    for (size_t j = 0; j < layouts.size(); ++j)
+    {
+        const int staffIndex = layouts[j].first;
+        const LayoutConstPtr &layout = layouts[j].second;
+
+        auto it = oldStaves.find(layout.get());
+        if (it != oldStaves.end())
+        {
+            // Move the staff if a staff above it changed height.
+            StaffPainter *painter = it->second;
+            oldStaves.erase(it);
+            painter->setPos(0, height);
+            myClickIndex.copyStaff(
+                clickIndex, staffIndex,
+                painter->mapRectToItem(myParentSystem,
+                                       painter->boundingRect()));
+        }
+        else
+        {
+            drawStaff(system, systemIndex, system.getStaves()[staffIndex],
+                      staffIndex, layout, height, j == 0, false);
+        }
+
+        height += layout->getStaffHeight();
+    }
+
+    // Remove the staves that were replaced.
+    for (auto &oldStaff : oldStaves)
+        delete oldStaff.second;
+
+    myParentSystem->setRect(0, 0, LayoutInfo::STAFF_WIDTH, height);
+    return true;
+}
+
+bool SystemRenderer::isStaffVisible(int systemIndex, int staffIndex) const
+{
+    if (!myViewOptions.getFilter())
+        return true;
+
+    const ViewFilter &filter =
+        myScore.getViewFilters()[*myViewOptions.getFilter()];
+    return filter.accept(myScore, systemIndex, staffIndex);
+}
+
+void SystemRenderer::drawStaff(const System &system, int systemIndex,
+                               const Staff &staff, int staffIndex,
+                               const LayoutConstPtr &layout, double y,
+                               bool isFirstStaff, bool drawRehearsalSigns)
+{
+    myParentStaff = new StaffPainter(layout);
+    myParentStaff->setPos(0, y);
+    myParentStaff->setParentItem(myParentSystem);
+    myClickIndex.addStaff(
+        myParentStaff->mapRectToItem(myParentSystem,
+                                     myParentStaff->boundingRect()),
+        staffIndex, layout);
+
+    if (myDetailLevel != DetailLevel::Overview)
+    {
         if (isFirstStaff)
             drawBarNumber(systemIndex, *layout);
 
         // Draw the clefs.
         const double CLEF_OFFSET =
             (staff.getClefType() == Staff::TrebleClef) ? -6 : -21;
-        auto pubsub = myScoreArea->getClickPubSub();
-        const ScoreLocation location(myScore, systemIndex, i);
-        auto clef = new SimpleTextItem(staff.getClefType() == Staff::TrebleClef
-                                           ? QChar(MusicFont::TrebleClef)
-                                           : QChar(MusicFont::BassClef),
-                                       myMusicNotationFont);
-        auto group = new ClickableGroup(
-            QObject::tr("Click to change clef type."), [=]() {
-            pubsub->publish(ClickType::Clef, location);
-        });
-        group->addToGroup(clef);
-        group->setPos(LayoutInfo::CLEF_PADDING,
-                      layout->getTopStdNotationLine() + CLEF_OFFSET);
-        group->setParentItem(myParentStaff);
-
-        drawTabClef(LayoutInfo::CLEF_PADDING, *layout, location);
-
-        drawBarlines(system, systemIndex, layout, isFirstStaff);
+        auto clef = new SimpleTextItem(
+            staff.getClefType() == Staff::TrebleClef
+                ? QChar(MusicFont::TrebleClef)
+                : QChar(MusicFont::BassClef),
+            myMusicNotationFont);
+        clef->setPos(LayoutInfo::CLEF_PADDING,
+                     layout->getTopStdNotationLine() + CLEF_OFFSET);
+        clef->setParentItem(myParentStaff);
+        addClickRegion(*clef, clef->boundingRect(), ClickType::Clef,
+                       staffIndex, 0,
+                       QObject::tr("Click to change clef type."));
+
+        drawTabClef(LayoutInfo::CLEF_PADDING, *layout, staffIndex);
+    }
+
+    drawBarlines(system, systemIndex, layout, drawRehearsalSigns);
+
+    if (myDetailLevel == DetailLevel::Full)
+    {
         drawTabNotes(staff, layout);
         drawLegato(staff, *layout);
         drawSlides(staff, *layout);
@@ -150,18 +252,30 @@ QGraphicsItem *SystemRenderer::operator()(const System &system,
         drawSymbolsAboveTabStaff(staff, *layout);
         drawSymbolsBelowTabStaff(*layout);
 
-        drawPlayerChanges(system, i, *layout);
+        drawPlayerChanges(system, staffIndex, *layout);
         drawStdNotation(system, staff, *layout);
+    }
+    else
+    {
+        // The tab numbers are still legible at the reduced level.
+        if (myDetailLevel == DetailLevel::Reduced)
+            drawTabNotes(staff, layout);
 
-        ++i;
+        drawNoteDensity(system, staff, *layout);
     }
+}
 
-    myParentSystem->setRect(0, 0, LayoutInfo::STAFF_WIDTH, height);
-    return myParentSystem;
+void SystemRenderer::addClickRegion(const QGraphicsItem &item,
+                                    const QRectF &rect, ClickType type,
+                                    int staff, int position,
+                                    const QString &toolTip)
+{
+    myClickIndex.addRegion(item.mapRectToItem(myParentSystem, rect), type,
+                           staff, position, toolTip);
 }
 
 void SystemRenderer::drawTabClef(double x, const LayoutInfo &layout,
-                                 const ScoreLocation &location)
+                                 int staffIndex)
 {
     // Determine the size of the clef symbol based on the number of strings and
     // the line spacing.
@@ -171,16 +285,11 @@ void SystemRenderer::drawTabClef(double x, const LayoutInfo &layout,
 
     auto clef = new SimpleTextItem(QChar(MusicFont::TabClef), font);
 
-    auto pubsub = myScoreArea->getClickPubSub();
-    auto group = new ClickableGroup(
-        QObject::tr("Click to edit the number of strings."), [=]() {
-        pubsub->publish(ClickType::TabClef, location);
-    });
-    group->addToGroup(clef);
-
     // Position the clef symbol.
-    group->setPos(x, layout.getTopTabLine() - pixel_size / 2.1);
-    group->setParentItem(myParentStaff);
+    clef->setPos(x, layout.getTopTabLine() - pixel_size / 2.1);
+    clef->setParentItem(myParentStaff);
+    addClickRegion(*clef, clef->boundingRect(), ClickType::TabClef, staffIndex,
+                   0, QObject::tr("Click to edit the number of strings."));
 }
 
 void SystemRenderer::drawBarNumber(int systemIndex, const LayoutInfo &layout)
@@ -200,18 +309,14 @@ void SystemRenderer::drawBarNumber(int systemIndex, const LayoutInfo &layout)
 
 void SystemRenderer::drawBarlines(const System &system, int systemIndex,
                                   const LayoutConstPtr &layout,
-                                  bool isFirstStaff)
+                                  bool drawRehearsalSigns)
 {
     for (const Barline &barline : system.getBarlines())
     {
-        const ScoreLocation location(myScore, systemIndex, -1,
-                                     barline.getPosition());
-
         const KeySignature &keySig = barline.getKeySignature();
         const TimeSignature &timeSig = barline.getTimeSignature();
 
-        BarlinePainter *barlinePainter = new BarlinePainter(layout, barline,
-                location, myScoreArea->getClickPubSub());
+        BarlinePainter *barlinePainter = new BarlinePainter(layout, barline);
 
         double x = layout->getPositionX(barline.getPosition());
         double keySigX = x + barlinePainter->boundingRect().width() - 1;
@@ -254,27 +359,39 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
         barlinePainter->setPos(x, 0);
         barlinePainter->setParentItem(myParentStaff);
 
-        if (keySig.isVisible())
+        // Barlines can only be clicked in the standard notation staff.
+        addClickRegion(*barlinePainter,
+                       QRectF(0, layout->getTopStdNotationLine(),
+                              barlinePainter->boundingRect().width(),
+                              layout->getStdNotationStaffHeight()),
+                       ClickType::Barline, -1, barline.getPosition(),
+                       QObject::tr("Click to edit barline."));
+
+        if (myDetailLevel != DetailLevel::Overview && keySig.isVisible())
         {
-            KeySignaturePainter *keySigPainter = new KeySignaturePainter(
-                        layout, keySig, location,
-                        myScoreArea->getClickPubSub());
+            KeySignaturePainter *keySigPainter =
+                new KeySignaturePainter(layout, keySig);
 
             keySigPainter->setPos(keySigX, layout->getTopStdNotationLine());
             keySigPainter->setParentItem(myParentStaff);
+            addClickRegion(*keySigPainter, keySigPainter->boundingRect(),
+                           ClickType::KeySignature, -1, barline.getPosition(),
+                           QObject::tr("Click to edit key signature."));
         }
 
-        if (timeSig.isVisible())
+        if (myDetailLevel != DetailLevel::Overview && timeSig.isVisible())
         {
-            TimeSignaturePainter *timeSigPainter = new TimeSignaturePainter(
-                        layout, timeSig, location,
-                        myScoreArea->getClickPubSub());
+            TimeSignaturePainter *timeSigPainter =
+                new TimeSignaturePainter(layout, timeSig);
 
             timeSigPainter->setPos(timeSigX, layout->getTopStdNotationLine());
             timeSigPainter->setParentItem(myParentStaff);
+            addClickRegion(*timeSigPainter, timeSigPainter->boundingRect(),
+                           ClickType::TimeSignature, -1, barline.getPosition(),
+                           QObject::tr("Click to edit time signature."));
         }
 
-        if (barline.hasRehearsalSign() && isFirstStaff)
+        if (barline.hasRehearsalSign() && drawRehearsalSigns)
         {
             const RehearsalSign &sign = barline.getRehearsalSign();
             const int RECTANGLE_OFFSET = 4;
@@ -319,6 +436,9 @@ void SystemRenderer::drawBarlines(const System &system, int systemIndex,
 void SystemRenderer::drawTabNotes(const Staff &staff,
                                   const LayoutConstPtr &layout)
 {
+    auto tabNotes = new GlyphBatchItem();
+    tabNotes->setParentItem(myParentStaff);
+
     for (const Voice &voice : staff.getVoices())
     {
         for (const Position &pos : voice.getPositions())
@@ -333,22 +453,23 @@ void SystemRenderer::drawTabNotes(const Staff &staff,
                 const QString text = QString::fromStdString(
                             boost::lexical_cast<std::string>(note));
 
-                auto tabNote = new SimpleTextItem(
-                    text, myPlainTextFont,
-                    QPen(note.hasProperty(Note::Tied) ? Qt::lightGray
-                                                      : Qt::black),
-                    QBrush(QColor(255, 255, 255)));
-
-                centerHorizontally(*tabNote, location,
-                                   location + layout->getPositionSpacing());
-                tabNote->setY(layout->getTabLine(note.getString() + 1) -
-                              0.6 * myPlainTextFont.pixelSize());
-                tabNote->setParentItem(myParentStaff);
+                const double width =
+                    GlyphBatchItem::getTextWidth(text, myPlainTextFont);
+                const double x =
+                    location + (layout->getPositionSpacing() - width) / 2;
+                const double y = layout->getTabLine(note.getString() + 1) -
+                                 0.6 * myPlainTextFont.pixelSize();
+
+                tabNotes->addText(
+                    text, myPlainTextFont, QPointF(x, y),
+                    note.hasProperty(Note::Tied) ? Qt::lightGray : Qt::black,
+                    QColor(255, 255, 255));
             }
 
             // Draw arpeggios if necessary.
-            if (pos.hasProperty(Position::ArpeggioDown) ||
-                pos.hasProperty(Position::ArpeggioUp))
+            if (myDetailLevel == DetailLevel::Full &&
+                (pos.hasProperty(Position::ArpeggioDown) ||
+                 pos.hasProperty(Position::ArpeggioUp)))
             {
                 drawArpeggio(pos, location, *layout);
             }
@@ -393,6 +514,9 @@ void SystemRenderer::drawSystemSymbols(const System &system,
                                        const LayoutInfo& layout)
 {
     double height = 0;
+    // Only the rehearsal signs are drawn in the overview, but the space for
+    // the other symbols is kept so that the layout doesn't change.
+    const bool drawSymbols = myDetailLevel != DetailLevel::Overview;
 
     // Allocate space for any rehearsal signs - they are drawn at the same
     // time as barlines.
@@ -408,14 +532,16 @@ void SystemRenderer::drawSystemSymbols(const System &system,
 
     if (!system.getAlternateEndings().empty())
     {
-        drawAlternateEndings(system, layout, height);
+        if (drawSymbols)
+            drawAlternateEndings(system, layout, height);
         height += LayoutInfo::SYSTEM_SYMBOL_SPACING;
         drawDividerLine(height);
     }
 
     if (!system.getTempoMarkers().empty())
     {
-        drawTempoMarkers(system, layout, height);
+        if (drawSymbols)
+            drawTempoMarkers(system, layout, height);
         height += LayoutInfo::SYSTEM_SYMBOL_SPACING;
         drawDividerLine(height);
     }
@@ -428,14 +554,16 @@ void SystemRenderer::drawSystemSymbols(const System &system,
 
     if (!system.getChords().empty())
     {
-        drawChordText(system, layout, height);
+        if (drawSymbols)
+            drawChordText(system, layout, height);
         height += LayoutInfo::SYSTEM_SYMBOL_SPACING;
         drawDividerLine(height);
     }
 
     if (!system.getTextItems().empty())
     {
-        drawTextItems(system, layout, height);
+        if (drawSymbols)
+            drawTextItems(system, layout, height);
         height += LayoutInfo::SYSTEM_SYMBOL_SPACING;
         drawDividerLine(height);
     }
@@ -580,13 +708,7 @@ void SystemRenderer::drawTempoMarkers(const System &system,
 
         const double x = layout.getPositionX(tempo.getPosition());
 
-#if 0
-        auto group = new ClickableGroup([]() {
-            // TODO - allow editing a tempo marker by clicking on it.
-        });
-#else
         auto group = new QGraphicsItemGroup();
-#endif
 
         QFont font = myPlainTextFont;
         if (tempo.getMarkerType() == TempoMarker::AlterationOfPace)
@@ -1355,6 +1477,11 @@ QGraphicsItem *SystemRenderer::createDynamic(const Dynamic &dynamic)
 void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
                                      const LayoutInfo &layout)
 {
+    // Draw all of the rests, note heads, accidentals, and dots from a single
+    // item.
+    auto glyphs = new GlyphBatchItem();
+    glyphs->setParentItem(myParentStaff);
+
     // Draw rests.
     for (const Voice &voice : staff.getVoices())
     {
@@ -1373,7 +1500,7 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
             }
             else if (pos.isRest())
             {
-                drawRest(pos, x, layout);
+                drawRest(pos, x, layout, *glyphs);
             }
         }
     }
@@ -1407,38 +1534,18 @@ void SystemRenderer::drawStdNotation(const System &system, const Staff &staff,
         const double y =
             note.getY() + layout.getTopStdNotationLine() - fm->ascent();
 
-        QGraphicsItemGroup *group = nullptr;
-        auto text = new SimpleTextItem(accidentalText + noteHead, *font);
-
         if (note.isDotted() || note.isDoubleDotted())
         {
-            group = new QGraphicsItemGroup();
-            const double dotX = noteHeadWidth + 2;
+            const double dotX = x + noteHeadWidth + 2;
 
             const QChar dot(MusicFont::Dot);
-            auto dotText = new SimpleTextItem(dot, *font);
-            dotText->setPos(dotX, 0);
-            group->addToGroup(dotText);
+            glyphs->addText(dot, *font, QPointF(dotX, y));
 
             if (note.isDoubleDotted())
-            {
-                auto dotText2 = new SimpleTextItem(dot, *font);
-                dotText2->setPos(dotX + 4, 0);
-                group->addToGroup(dotText2);
-            }
+                glyphs->addText(dot, *font, QPointF(dotX + 4, y));
         }
 
-        if (group)
-        {
-            group->addToGroup(text);
-            group->setPos(x, y);
-            group->setParentItem(myParentStaff);
-        }
-        else
-        {
-            text->setPos(x, y);
-            text->setParentItem(myParentStaff);
-        }
+        glyphs->addText(accidentalText + noteHead, *font, QPointF(x, y));
 
         const int position = note.getPosition();
         minNoteLocations[position] = std::min(minNoteLocations[position],
@@ -1593,6 +1700,87 @@ void SystemRenderer::drawIrregularGroups(const Voice &voice,
     }
 }
 
+void SystemRenderer::drawNoteDensity(const System &system, const Staff &staff,
+                                     const LayoutInfo &layout)
+{
+    // Find the positions that contain notes, and the range of strings that
+    // they use.
+    std::map<int, std::pair<int, int>> stringRanges;
+    for (const Voice &voice : staff.getVoices())
+    {
+        for (const Position &pos : voice.getPositions())
+        {
+            for (const Note &note : pos.getNotes())
+            {
+                auto it = stringRanges.find(pos.getPosition());
+                if (it == stringRanges.end())
+                {
+                    stringRanges[pos.getPosition()] =
+                        std::make_pair(note.getString(), note.getString());
+                }
+                else
+                {
+                    it->second.first =
+                        std::min(it->second.first, note.getString());
+                    it->second.second =
+                        std::max(it->second.second, note.getString());
+                }
+            }
+        }
+    }
+
+    const double spacing = layout.getPositionSpacing();
+    QPainterPath path;
+
+    // In the standard notation staff, draw a bar for each measure whose
+    // height indicates how many of its positions contain notes.
+    const double staffHeight = layout.getStdNotationStaffHeight();
+    const double centerY = layout.getTopStdNotationLine() + 0.5 * staffHeight;
+    const Barline *prevBar = nullptr;
+    for (const Barline &bar : system.getBarlines())
+    {
+        if (prevBar && bar.getPosition() > prevBar->getPosition())
+        {
+            const int left = prevBar->getPosition();
+            const int right = bar.getPosition();
+            const auto count =
+                std::distance(stringRanges.lower_bound(left),
+                              stringRanges.lower_bound(right));
+            const double height =
+                staffHeight *
+                std::min(1.0, static_cast<double>(count) / (right - left));
+
+            if (count > 0)
+            {
+                const double leftX = layout.getPositionX(left) + 0.5 * spacing;
+                const double rightX = layout.getPositionX(right);
+                path.addRect(leftX, centerY - 0.5 * height, rightX - leftX,
+                             height);
+            }
+        }
+
+        prevBar = &bar;
+    }
+
+    // In the overview, the tab numbers are replaced by a mark at each position
+    // that covers the strings being played.
+    if (myDetailLevel == DetailLevel::Overview)
+    {
+        for (const auto &range : stringRanges)
+        {
+            const double x = layout.getPositionX(range.first) + 0.3 * spacing;
+            const double top = layout.getTabLine(range.second.first + 1);
+            const double bottom = layout.getTabLine(range.second.second + 1);
+            path.addRect(x, top - 1, 0.4 * spacing, bottom - top + 2);
+        }
+    }
+
+    auto bars = new QGraphicsPathItem(path);
+    bars->setPen(Qt::NoPen);
+    bars->setBrush(QBrush(Qt::darkGray));
+    bars->setParentItem(myParentStaff);
+}
+
 void SystemRenderer::drawMultiBarRest(const System &system,
                                       const Barline &leftBar,
                                       const LayoutInfo &layout,
@@ -1638,7 +1826,8 @@ void SystemRenderer::drawMultiBarRest(const System &system,
     horizontalLine->setParentItem(myParentStaff);
 }
 
-void SystemRenderer::drawRest(const Position &pos, double x, const LayoutInfo &layout)
+void SystemRenderer::drawRest(const Position &pos, double x,
+                              const LayoutInfo &layout, GlyphBatchItem &glyphs)
 {
     // Position it approximately in the middle of the staff.
     double y = 2 * LayoutInfo::STD_NOTATION_LINE_SPACING -
@@ -1672,36 +1861,38 @@ void SystemRenderer::drawRest(const Position &pos, double x, const LayoutInfo &l
         break;
     }
 
-    auto group = new QGraphicsItemGroup();
-    auto text = new SimpleTextItem(symbol, myMusicNotationFont);
-    text->setPos(0, y);
-    group->addToGroup(text);
-
-    // Draw dots if necessary.
+    const QString restText(symbol);
     const QChar dot = MusicFont::Dot;
     const double dotX = myMusicNotationFont.pixelSize() / 2.0;
     // Position just below second line of staff.
     const double dotY = 1.6 * LayoutInfo::STD_NOTATION_LINE_SPACING -
             myMusicFontMetrics.ascent();
 
-    if (pos.hasProperty(Position::Dotted) ||
-        pos.hasProperty(Position::DoubleDotted))
-    {
-        auto dotText = new SimpleTextItem(dot, myMusicNotationFont);
-        dotText->setPos(dotX, dotY);
-        group->addToGroup(dotText);
+    int numDots = 0;
+    if (pos.hasProperty(Position::DoubleDotted))
+        numDots = 2;
+    else if (pos.hasProperty(Position::Dotted))
+        numDots = 1;
 
-        if (pos.hasProperty(Position::DoubleDotted))
-        {
-            auto dotText2 = new SimpleTextItem(dot, myMusicNotationFont);
-            dotText2->setPos(dotX + 4, dotY);
-            group->addToGroup(dotText2);
-        }
+    // Center the rest and its dots within the position.
+    double width = GlyphBatchItem::getTextWidth(restText, myMusicNotationFont);
+    if (numDots > 0)
+    {
+        width = std::max(width, dotX + 4 * (numDots - 1) +
+                                    GlyphBatchItem::getTextWidth(
+                                        dot, myMusicNotationFont));
     }
 
-    centerHorizontally(*group, x, x + layout.getPositionSpacing() * 1.25);
-    group->setY(layout.getTopStdNotationLine());
-    group->setParentItem(myParentStaff);
+    const double left = x + (layout.getPositionSpacing() * 1.25 - width) / 2;
+    const double top = layout.getTopStdNotationLine();
+
+    glyphs.addText(restText, myMusicNotationFont, QPointF(left, top + y));
+
+    for (int i = 0; i < numDots; ++i)
+    {
+        glyphs.addText(dot, myMusicNotationFont,
+                       QPointF(left + dotX + 4 * i, top + dotY));
+    }
 }
 
 void SystemRenderer::drawLedgerLines(
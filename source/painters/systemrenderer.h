@@ -19,36 +19,62 @@
 #define PAINTERS_SYSTEMRENDERER_H
 
 #include <map>
+#include <memory>
+#include <painters/clickindex.h>
+#include <painters/detaillevel.h>
 #include <painters/layoutinfo.h>
 #include <painters/musicfont.h>
 #include <QFontMetricsF>
 #include <score/staff.h>
 
+class GlyphBatchItem;
+class LayoutCache;
 class QGraphicsItem;
 class QGraphicsItemGroup;
 class QGraphicsRectItem;
 class Score;
-class ScoreArea;
-class ScoreLocation;
 class System;
 class ViewOptions;
 
 class SystemRenderer
 {
 public:
-    SystemRenderer(const ScoreArea *score_area, const Score &score,
-                   const ViewOptions &view_options);
+    SystemRenderer(const Score &score, const ViewOptions &view_options,
+                   const std::shared_ptr<LayoutCache> &layoutCache,
+                   DetailLevel detailLevel = DetailLevel::Full);
 
     QGraphicsItem *operator()(const System &system, int systemIndex);
 
+    /// Redraws the modified staves of a previously rendered system, and keeps
+    /// the items of the other staves. Returns false if none of the staves
+    /// could be kept, in which case the whole system should be redrawn.
+    bool redrawStaves(QGraphicsItem *renderedSystem,
+                      const ClickIndex &clickIndex, const System &system,
+                      int systemIndex);
+
+    /// Returns the clickable regions of the most recently rendered system.
+    const ClickIndex &getClickIndex() const { return myClickIndex; }
+
 private:
+    /// Returns whether the view filter accepts the staff.
+    bool isStaffVisible(int systemIndex, int staffIndex) const;
+
+    /// Draws a staff and its notes and symbols at the given height.
+    void drawStaff(const System &system, int systemIndex, const Staff &staff,
+                   int staffIndex, const LayoutConstPtr &layout, double y,
+                   bool isFirstStaff, bool drawRehearsalSigns);
+
+    /// Adds a clickable region for the item to the click index.
+    void addClickRegion(const QGraphicsItem &item, const QRectF &rect,
+                        ClickType type, int staff, int position,
+                        const QString &toolTip);
+
     /// Draws the tab clef.
-    void drawTabClef(double x, const LayoutInfo &layout,
-                     const ScoreLocation &location);
+    void drawTabClef(double x, const LayoutInfo &layout, int staffIndex);
 
     /// Draws barlines, along with time signatures, rehearsal signs, etc.
     void drawBarlines(const System &system, int systemIndex,
-                      const LayoutConstPtr &layout, bool isFirstStaff);
+                      const LayoutConstPtr &layout, bool drawRehearsalSigns);
 
     /// Draws the tab notes for all notes in the staff.
     void drawTabNotes(const Staff &staff, const LayoutConstPtr &layout);
@@ -172,8 +198,13 @@ private:
     void drawMultiBarRest(const System &system, const Barline &leftBar,
                           const LayoutInfo &layout, int measureCount);
 
+    /// Draws simplified note density bars in place of the notes.
+    void drawNoteDensity(const System &system, const Staff &staff,
+                         const LayoutInfo &layout);
+
     /// Draws a rest symbol.
-    void drawRest(const Position &pos, double x, const LayoutInfo &layout);
+    void drawRest(const Position &pos, double x, const LayoutInfo &layout,
+                  GlyphBatchItem &glyphs);
 
     /// Draws ledger lines for all positions in the staff.
     void drawLedgerLines(const LayoutInfo &layout,
@@ -188,12 +219,14 @@ private:
     void drawSlide(const LayoutInfo &layout, int string, bool slideUp,
                    int position1, int position2) const;
 
-    const ScoreArea *myScoreArea;
     const Score &myScore;
     const ViewOptions &myViewOptions;
+    const std::shared_ptr<LayoutCache> myLayoutCache;
+    const DetailLevel myDetailLevel;
 
     QGraphicsRectItem *myParentSystem;
     QGraphicsItem *myParentStaff;
+    ClickIndex myClickIndex;
 
     QFont myMusicNotationFont;
     QFontMetricsF myMusicFontMetrics;
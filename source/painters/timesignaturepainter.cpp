@@ -17,30 +17,17 @@
   
 #include "timesignaturepainter.h"
 
-#include <app/pubsub/clickpubsub.h>
 #include <painters/musicfont.h>
-#include <QCursor>
 #include <QPainter>
 #include <score/timesignature.h>
 
 TimeSignaturePainter::TimeSignaturePainter(const LayoutConstPtr &layout,
-                                           const TimeSignature &time,
-                                           const ScoreLocation &location,
-                                           const std::shared_ptr<ClickPubSub> &pubsub)
+                                           const TimeSignature &time)
     : myLayout(layout),
       myTimeSignature(time),
-      myLocation(location),
-      myPubSub(pubsub),
       myBounds(0, 0, LayoutInfo::getWidth(myTimeSignature),
                myLayout->getStdNotationStaffHeight())
 {
-    setAcceptHoverEvents(true);
-    setToolTip(QObject::tr("Click to edit time signature."));
-}
-
-void TimeSignaturePainter::mouseReleaseEvent(QGraphicsSceneMouseEvent *)
-{
-    myPubSub->publish(ClickType::TimeSignature, myLocation);
 }
 
 void TimeSignaturePainter::paint(QPainter *painter,
@@ -65,21 +52,6 @@ void TimeSignaturePainter::paint(QPainter *painter,
     }
 }
 
-void TimeSignaturePainter::mousePressEvent(QGraphicsSceneMouseEvent *)
-{
-    // No action is needed here, but this will let us grab future mouse events.
-}
-
-void TimeSignaturePainter::hoverEnterEvent(QGraphicsSceneHoverEvent *)
-{
-    setCursor(Qt::PointingHandCursor);
-}
-
-void TimeSignaturePainter::hoverLeaveEvent(QGraphicsSceneHoverEvent *)
-{
-    unsetCursor();
-}
-
 void TimeSignaturePainter::drawNumber(QPainter* painter, const double y,
                                       const int number) const
 {
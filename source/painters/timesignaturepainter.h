@@ -21,18 +21,14 @@
 #include <memory>
 #include <painters/layoutinfo.h>
 #include <QGraphicsItem>
-#include <score/scorelocation.h>
 
-class ClickPubSub;
 class TimeSignature;
 
 class TimeSignaturePainter : public QGraphicsItem
 {
 public:
     TimeSignaturePainter(const LayoutConstPtr &layout,
-                         const TimeSignature &time,
-                         const ScoreLocation &location,
-                         const std::shared_ptr<ClickPubSub> &pubsub);
+                         const TimeSignature &time);
 
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
                        QWidget *) override;
@@ -42,19 +38,11 @@ public:
         return myBounds;
     }
 
-protected:
-    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
-    virtual void hoverEnterEvent(QGraphicsSceneHoverEvent *) override;
-    virtual void hoverLeaveEvent(QGraphicsSceneHoverEvent *) override;
-
 private:
     void drawNumber(QPainter* painter, const double y, const int number) const;
 
     LayoutConstPtr myLayout;
     const TimeSignature &myTimeSignature;
-    const ScoreLocation myLocation;
-    std::shared_ptr<ClickPubSub> myPubSub;
     const QRectF myBounds;
 };
 
@@ -18,13 +18,138 @@
 #include "verticallayout.h"
 
 #include <algorithm>
+#include <limits>
+
+/// Marks a node without a pending height.
+static const int NO_HEIGHT = std::numeric_limits<int>::min();
+static const int MIN_SIZE = 32;
+
+VerticalLayout::VerticalLayout() : mySize(0)
+{
+}
 
 int VerticalLayout::addBox(int left, int right, int height)
 {
-    heights.resize(std::max<size_t>(heights.size(), right + 1));
+    reserve(right + 1);
+
+    // An empty box is placed on top of the position at its left edge.
     const int newHeight =
-        *std::max_element(heights.begin() + left, heights.begin() + right) +
-        height;
-    std::fill_n(heights.begin() + left, right - left, newHeight);
+        findMax(1, 0, mySize, left, std::max(right, left + 1)) + height;
+    if (left < right)
+        raise(1, 0, mySize, left, right, newHeight);
+
     return newHeight;
 }
+
+int VerticalLayout::getHeight(int position) const
+{
+    if (position >= mySize)
+        return 0;
+
+    return findMax(1, 0, mySize, position, position + 1);
+}
+
+void VerticalLayout::reserve(int size)
+{
+    if (size <= mySize)
+        return;
+
+    std::vector<int> heights(mySize);
+    if (mySize > 0)
+        collect(1, 0, mySize, heights);
+
+    int newSize = std::max(mySize, MIN_SIZE);
+    while (newSize < size)
+        newSize *= 2;
+
+    heights.resize(newSize, 0);
+    mySize = newSize;
+    myMaxHeights.assign(2 * mySize, 0);
+    myPendingHeights.assign(2 * mySize, NO_HEIGHT);
+    build(1, 0, mySize, heights);
+}
+
+void VerticalLayout::build(int node, int nodeLeft, int nodeRight,
+                           const std::vector<int> &heights)
+{
+    if (nodeRight - nodeLeft == 1)
+    {
+        myMaxHeights[node] = heights[nodeLeft];
+        return;
+    }
+
+    const int mid = (nodeLeft + nodeRight) / 2;
+    build(2 * node, nodeLeft, mid, heights);
+    build(2 * node + 1, mid, nodeRight, heights);
+    myMaxHeights[node] =
+        std::max(myMaxHeights[2 * node], myMaxHeights[2 * node + 1]);
+}
+
+void VerticalLayout::collect(int node, int nodeLeft, int nodeRight,
+                             std::vector<int> &heights) const
+{
+    if (myPendingHeights[node] != NO_HEIGHT)
+    {
+        std::fill(heights.begin() + nodeLeft, heights.begin() + nodeRight,
+                  myPendingHeights[node]);
+    }
+    else if (nodeRight - nodeLeft == 1)
+        heights[nodeLeft] = myMaxHeights[node];
+    else
+    {
+        const int mid = (nodeLeft + nodeRight) / 2;
+        collect(2 * node, nodeLeft, mid, heights);
+        collect(2 * node + 1, mid, nodeRight, heights);
+    }
+}
+
+int VerticalLayout::findMax(int node, int nodeLeft, int nodeRight, int left,
+                            int right) const
+{
+    if (right <= nodeLeft || nodeRight <= left)
+        return NO_HEIGHT;
+
+    // The whole range has the same height.
+    if ((left <= nodeLeft && nodeRight <= right) ||
+        myPendingHeights[node] != NO_HEIGHT)
+    {
+        return myMaxHeights[node];
+    }
+
+    const int mid = (nodeLeft + nodeRight) / 2;
+    return std::max(findMax(2 * node, nodeLeft, mid, left, right),
+                    findMax(2 * node + 1, mid, nodeRight, left, right));
+}
+
+void VerticalLayout::raise(int node, int nodeLeft, int nodeRight, int left,
+                           int right, int height)
+{
+    if (right <= nodeLeft || nodeRight <= left)
+        return;
+
+    if (left <= nodeLeft && nodeRight <= right)
+    {
+        myMaxHeights[node] = height;
+        myPendingHeights[node] = height;
+        return;
+    }
+
+    // Pass on the pending height before modifying part of the range.
+    int &pending = myPendingHeights[node];
+    if (pending != NO_HEIGHT)
+    {
+        for (int child : { 2 * node, 2 * node + 1 })
+        {
+            myMaxHeights[child] = pending;
+            myPendingHeights[child] = pending;
+        }
+
+        pending = NO_HEIGHT;
+    }
+
+    const int mid = (nodeLeft + nodeRight) / 2;
+    raise(2 * node, nodeLeft, mid, left, right, height);
+    raise(2 * node + 1, mid, nodeRight, left, right, height);
+    myMaxHeights[node] =
+        std::max(myMaxHeights[2 * node], myMaxHeights[2 * node + 1]);
+}
@@ -20,15 +20,45 @@
 
 #include <vector>
 
+/// Stacks boxes (e.g. groups of symbols above the tab staff) so that they
+/// don't overlap. The height at each position is stored in a segment tree, so
+/// adding a box takes O(log n) time regardless of how many positions it spans.
 class VerticalLayout
 {
 public:
+    VerticalLayout();
+
     /// Adds a box to the layout. Returns the y-coordinate where the box should
     /// be placed.
     int addBox(int left, int right, int height);
 
+    /// Returns the height of the boxes at the given position.
+    int getHeight(int position) const;
+
 private:
-    std::vector<int> heights;
+    /// Grows the tree to hold at least the given number of positions.
+    void reserve(int size);
+    /// Builds the subtree for the given range from a list of heights.
+    void build(int node, int nodeLeft, int nodeRight,
+               const std::vector<int> &heights);
+    /// Copies the heights of the subtree's range into the list.
+    void collect(int node, int nodeLeft, int nodeRight,
+                 std::vector<int> &heights) const;
+    /// Returns the maximum height in the range [left, right).
+    int findMax(int node, int nodeLeft, int nodeRight, int left,
+                int right) const;
+    /// Sets the height of the range [left, right), which must not be lower
+    /// than any of the current heights in that range.
+    void raise(int node, int nodeLeft, int nodeRight, int left, int right,
+               int height);
+
+    /// The number of positions in the tree, which is a power of two.
+    int mySize;
+    /// The maximum height in each node's range.
+    std::vector<int> myMaxHeights;
+    /// Heights that were assigned to a node's entire range but haven't been
+    /// passed on to its children yet.
+    std::vector<int> myPendingHeights;
 };
 
 #endif
@@ -0,0 +1,77 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_CACHEDVALUE_H
+#define SCORE_CACHEDVALUE_H
+
+#include <memory>
+
+/// Holds a lazily computed value that is derived from the owning object.
+/// The value is shared by copies of the owning object, and can be computed
+/// from multiple threads since score snapshots may be read concurrently.
+template <typename T>
+class CachedValue
+{
+public:
+    CachedValue()
+    {
+    }
+
+    CachedValue(const CachedValue &other)
+        : myValue(std::atomic_load(&other.myValue))
+    {
+    }
+
+    CachedValue &operator=(const CachedValue &other)
+    {
+        std::atomic_store(&myValue, std::atomic_load(&other.myValue));
+        return *this;
+    }
+
+    /// Returns the cached value, computing it first if necessary.
+    template <typename Function>
+    const T &get(Function compute) const
+    {
+        std::shared_ptr<const T> value = std::atomic_load(&myValue);
+        if (!value)
+        {
+            value = std::make_shared<const T>(compute());
+
+            // If another thread stored a value first, use that one instead so
+            // that the returned reference remains valid.
+            std::shared_ptr<const T> expected;
+            if (!std::atomic_compare_exchange_strong(&myValue, &expected,
+                                                     value))
+            {
+                value = expected;
+            }
+        }
+
+        return *value;
+    }
+
+    /// Discards the cached value, e.g. after the owning object is modified.
+    void reset()
+    {
+        std::atomic_store(&myValue, std::shared_ptr<const T>());
+    }
+
+private:
+    mutable std::shared_ptr<const T> myValue;
+};
+
+#endif
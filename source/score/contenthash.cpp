@@ -0,0 +1,116 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "contenthash.h"
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include "staff.h"
+#include "system.h"
+
+ContentHashCache::ContentHashCache() : myRevision(0), myHash(0)
+{
+}
+
+ContentHashCache::ContentHashCache(const ContentHashCache &other)
+    : myRevision(0), myHash(0)
+{
+    *this = other;
+}
+
+ContentHashCache &ContentHashCache::operator=(const ContentHashCache &other)
+{
+    // Read the revision first, so that a hash that is being stored
+    // concurrently is not paired with the wrong revision.
+    const uint64_t revision = other.myRevision.load(std::memory_order_acquire);
+    const uint64_t hash = other.myHash.load(std::memory_order_relaxed);
+    myRevision.store(0, std::memory_order_relaxed);
+    store(revision, hash);
+    return *this;
+}
+
+boost::optional<uint64_t> ContentHashCache::find(uint64_t revision) const
+{
+    if (myRevision.load(std::memory_order_acquire) != revision)
+        return boost::none;
+
+    return myHash.load(std::memory_order_relaxed);
+}
+
+void ContentHashCache::store(uint64_t revision, uint64_t hash) const
+{
+    myHash.store(hash, std::memory_order_relaxed);
+    myRevision.store(revision, std::memory_order_release);
+}
+
+/// 64-bit FNV-1a parameters.
+static const uint64_t theFnvOffsetBasis = 14695981039346656037ULL;
+static const uint64_t theFnvPrime = 1099511628211ULL;
+
+ScoreUtils::HashArchive::HashArchive() : myHash(theFnvOffsetBasis)
+{
+}
+
+void ScoreUtils::HashArchive::write(uint64_t val)
+{
+    // Hash the bytes in a fixed order so that the result doesn't depend on
+    // the platform's endianness.
+    for (int i = 0; i < 8; ++i)
+    {
+        myHash ^= (val >> (8 * i)) & 0xff;
+        myHash *= theFnvPrime;
+    }
+}
+
+void ScoreUtils::HashArchive::write(int val)
+{
+    write(static_cast<uint64_t>(static_cast<int64_t>(val)));
+}
+
+void ScoreUtils::HashArchive::write(unsigned int val)
+{
+    write(static_cast<uint64_t>(val));
+}
+
+void ScoreUtils::HashArchive::write(bool val)
+{
+    write(static_cast<uint64_t>(val ? 1 : 0));
+}
+
+void ScoreUtils::HashArchive::write(const std::string &str)
+{
+    write(static_cast<uint64_t>(str.size()));
+    for (char c : str)
+    {
+        myHash ^= static_cast<unsigned char>(c);
+        myHash *= theFnvPrime;
+    }
+}
+
+void ScoreUtils::HashArchive::write(const boost::gregorian::date &date)
+{
+    write(boost::gregorian::to_iso_string(date));
+}
+
+void ScoreUtils::HashArchive::write(const Staff &staff)
+{
+    write(staff.getContentHash());
+}
+
+void ScoreUtils::HashArchive::write(const System &system)
+{
+    write(system.getContentHash());
+}
@@ -0,0 +1,172 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_CONTENTHASH_H
+#define SCORE_CONTENTHASH_H
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <boost/optional/optional.hpp>
+#include "copyonwrite.h"
+#include <cstdint>
+#include "fileversion.h"
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace boost {
+namespace gregorian {
+class date;
+}
+}
+
+class Staff;
+class System;
+
+/// Caches the content hash of an object. The hash remains valid until the
+/// object's revision changes.
+/// This can be safely accessed from multiple threads, since snapshots of a
+/// score may be shared with e.g. a background thread.
+class ContentHashCache
+{
+public:
+    ContentHashCache();
+    ContentHashCache(const ContentHashCache &other);
+    ContentHashCache &operator=(const ContentHashCache &other);
+
+    /// Returns the cached hash, if it was computed for the given revision.
+    boost::optional<uint64_t> find(uint64_t revision) const;
+    /// Caches the hash for the given revision.
+    void store(uint64_t revision, uint64_t hash) const;
+
+private:
+    mutable std::atomic<uint64_t> myRevision;
+    mutable std::atomic<uint64_t> myHash;
+};
+
+namespace ScoreUtils
+{
+/// Computes a hash of an object's contents by visiting the same members that
+/// are serialized. The hash does not depend on the platform, and staves and
+/// systems contribute their cached hashes rather than being visited again.
+class HashArchive
+{
+public:
+    HashArchive();
+
+    template <typename T>
+    void operator()(const std::string &, const T &obj)
+    {
+        // The members are always visited in the same order, so the names
+        // don't need to be included in the hash.
+        write(obj);
+    }
+
+    /// Hashes the members of the object (e.g. to compute the cached hash of
+    /// a staff or system).
+    template <typename T>
+    void writeMembers(const T &obj)
+    {
+        const_cast<T &>(obj).serialize(*this, FileVersion::LATEST_VERSION);
+    }
+
+    uint64_t getHash() const { return myHash; }
+
+private:
+    void write(uint64_t val);
+    void write(int val);
+    void write(unsigned int val);
+    void write(bool val);
+    void write(const std::string &str);
+    void write(const boost::gregorian::date &date);
+    void write(const Staff &staff);
+    void write(const System &system);
+
+    template <typename T>
+    void write(const std::vector<T> &vec)
+    {
+        write(static_cast<uint64_t>(vec.size()));
+        for (const T &obj : vec)
+            write(obj);
+    }
+
+    template <typename K, typename V, typename C>
+    void write(const std::map<K, V, C> &map)
+    {
+        write(static_cast<uint64_t>(map.size()));
+        for (const auto &pair : map)
+        {
+            write(pair.first);
+            write(pair.second);
+        }
+    }
+
+    template <typename T, size_t N>
+    void write(const std::array<T, N> &arr)
+    {
+        for (const T &obj : arr)
+            write(obj);
+    }
+
+    template <size_t N>
+    void write(const std::bitset<N> &bits)
+    {
+        write(bits.to_string());
+    }
+
+    template <typename T>
+    void write(const boost::optional<T> &val)
+    {
+        write(static_cast<bool>(val));
+        if (val)
+            write(*val);
+    }
+
+    template <typename T>
+    void write(const CopyOnWrite<T> &val)
+    {
+        write(*val);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type write(const T &val)
+    {
+        write(static_cast<int>(val));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_class<T>::value>::type write(const T &obj)
+    {
+        writeMembers(obj);
+    }
+
+    uint64_t myHash;
+};
+
+/// Computes the hash of an object's members.
+template <typename T>
+uint64_t hashContents(const T &obj)
+{
+    HashArchive ar;
+    ar.writeMembers(obj);
+    return ar.getHash();
+}
+}
+
+#endif
@@ -0,0 +1,152 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_COPYONWRITE_H
+#define SCORE_COPYONWRITE_H
+
+#include <atomic>
+#include <boost/iterator/iterator_adaptor.hpp>
+#include <memory>
+#include <vector>
+
+/// Holds a value that is shared between copies until one of them is modified.
+/// Copying is therefore O(1), and a deep copy is only made by write() when
+/// the value is still shared with another copy.
+/// References returned by write() must not be held across a copy of the
+/// object, since they would otherwise modify the shared value.
+template <typename T>
+class CopyOnWrite
+{
+public:
+    CopyOnWrite() : myData(std::make_shared<T>())
+    {
+    }
+
+    explicit CopyOnWrite(const T &value) : myData(std::make_shared<T>(value))
+    {
+    }
+
+    bool operator==(const CopyOnWrite &other) const
+    {
+        return myData == other.myData || *myData == *other.myData;
+    }
+
+    bool operator!=(const CopyOnWrite &other) const
+    {
+        return !(*this == other);
+    }
+
+    const T &operator*() const
+    {
+        return *myData;
+    }
+
+    const T *operator->() const
+    {
+        return myData.get();
+    }
+
+    /// Returns a modifiable reference to the value, first making a private
+    /// copy of it if it is shared with another object.
+    T &write()
+    {
+        if (myData.use_count() != 1)
+            myData = std::make_shared<T>(*myData);
+        else
+        {
+            // use_count() is only a relaxed load. If the other copies were
+            // released on another thread (e.g. a snapshot used for playback
+            // or export), synchronize with their release of the value before
+            // modifying it.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+
+        return *myData;
+    }
+
+    /// Returns whether the value is shared with another object.
+    bool isShared() const
+    {
+        return myData.use_count() != 1;
+    }
+
+    /// Returns whether both objects share the same value.
+    bool isSameAs(const CopyOnWrite &other) const
+    {
+        return myData == other.myData;
+    }
+
+private:
+    std::shared_ptr<T> myData;
+};
+
+/// Iterator over a list of shared values, which detaches each value before
+/// handing out a modifiable reference to it.
+template <typename T>
+class CopyOnWriteIterator
+    : public boost::iterator_adaptor<
+          CopyOnWriteIterator<T>,
+          typename std::vector<CopyOnWrite<T>>::iterator, T>
+{
+public:
+    CopyOnWriteIterator()
+    {
+    }
+
+    explicit CopyOnWriteIterator(
+        typename std::vector<CopyOnWrite<T>>::iterator it)
+        : CopyOnWriteIterator::iterator_adaptor_(it)
+    {
+    }
+
+private:
+    friend class boost::iterator_core_access;
+
+    T &dereference() const
+    {
+        return this->base()->write();
+    }
+};
+
+/// Read-only iterator over a list of shared values.
+template <typename T>
+class CopyOnWriteConstIterator
+    : public boost::iterator_adaptor<
+          CopyOnWriteConstIterator<T>,
+          typename std::vector<CopyOnWrite<T>>::const_iterator, const T>
+{
+public:
+    CopyOnWriteConstIterator()
+    {
+    }
+
+    explicit CopyOnWriteConstIterator(
+        typename std::vector<CopyOnWrite<T>>::const_iterator it)
+        : CopyOnWriteConstIterator::iterator_adaptor_(it)
+    {
+    }
+
+private:
+    friend class boost::iterator_core_access;
+
+    const T &dereference() const
+    {
+        return **this->base();
+    }
+};
+
+#endif
@@ -22,6 +22,5 @@
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/range/iterator_range_core.hpp>
-#include <boost/rational.hpp>
 #include <boost/regex.hpp>
 #include <boost/variant.hpp>
@@ -0,0 +1,31 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_REVISION_H
+#define SCORE_REVISION_H
+
+#include <cstdint>
+
+namespace ScoreUtils
+{
+/// Returns a new revision stamp, which is greater than any stamp that was
+/// previously returned. Two objects with the same revision are copies of each
+/// other that have not been modified since.
+uint64_t nextRevision();
+}
+
+#endif
@@ -17,11 +17,15 @@
 
 #include "score.h"
 
+#include "contenthash.h"
+#include "revision.h"
+
 const int Score::MIN_LINE_SPACING = 6;
 const int Score::MAX_LINE_SPACING = 14;
 
 Score::Score()
-    : myLineSpacing(9)
+    : myRevision(ScoreUtils::nextRevision()),
+      myLineSpacing(9)
 {
 }
 
@@ -41,34 +45,56 @@ const ScoreInfo &Score::getScoreInfo() const
 
 void Score::setScoreInfo(const ScoreInfo &info)
 {
+    markModified();
     myScoreInfo = info;
 }
 
 boost::iterator_range<Score::SystemIterator> Score::getSystems()
 {
-    return boost::make_iterator_range(mySystems);
+    markModified();
+    std::vector<CopyOnWrite<System>> &systems = mySystems.write();
+    return boost::make_iterator_range(SystemIterator(systems.begin()),
+                                      SystemIterator(systems.end()));
 }
 
 boost::iterator_range<Score::SystemConstIterator> Score::getSystems() const
 {
-    return boost::make_iterator_range(mySystems);
+    return boost::make_iterator_range(SystemConstIterator(mySystems->begin()),
+                                      SystemConstIterator(mySystems->end()));
 }
 
 void Score::insertSystem(const System &system, int index)
 {
+    markModified();
+    std::vector<CopyOnWrite<System>> &systems = mySystems.write();
+
     if (index < 0)
-        mySystems.push_back(system);
+        systems.push_back(CopyOnWrite<System>(system));
     else
-        mySystems.insert(mySystems.begin() + index, system);
+        systems.insert(systems.begin() + index, CopyOnWrite<System>(system));
 }
 
 void Score::removeSystem(int index)
 {
-    mySystems.erase(mySystems.begin() + index);
+    markModified();
+    std::vector<CopyOnWrite<System>> &systems = mySystems.write();
+    systems.erase(systems.begin() + index);
+}
+
+Score::SystemList Score::getSystemsSnapshot() const
+{
+    return mySystems;
+}
+
+void Score::restoreSystemsSnapshot(const SystemList &systems)
+{
+    markModified();
+    mySystems = systems;
 }
 
 boost::iterator_range<Score::PlayerIterator> Score::getPlayers()
 {
+    markModified();
     return boost::make_iterator_range(myPlayers);
 }
 
@@ -79,21 +105,25 @@ boost::iterator_range<Score::PlayerConstIterator> Score::getPlayers() const
 
 void Score::insertPlayer(const Player &player)
 {
+    markModified();
     myPlayers.push_back(player);
 }
 
 void Score::insertPlayer(const Player &player, int index)
 {
+    markModified();
     myPlayers.insert(myPlayers.begin() + index, player);
 }
 
 void Score::removePlayer(int index)
 {
+    markModified();
     myPlayers.erase(myPlayers.begin() + index);
 }
 
 boost::iterator_range<Score::InstrumentIterator> Score::getInstruments()
 {
+    markModified();
     return boost::make_iterator_range(myInstruments);
 }
 
@@ -104,21 +134,25 @@ boost::iterator_range<Score::InstrumentConstIterator> Score::getInstruments() co
 
 void Score::insertInstrument(const Instrument &instrument)
 {
+    markModified();
     myInstruments.push_back(instrument);
 }
 
 void Score::insertInstrument(const Instrument &instrument, int index)
 {
+    markModified();
     myInstruments.insert(myInstruments.begin() + index, instrument);
 }
 
 void Score::removeInstrument(int index)
 {
+    markModified();
     myInstruments.erase(myInstruments.begin() + index);
 }
 
 boost::iterator_range<Score::ViewFilterIterator> Score::getViewFilters()
 {
+    markModified();
     return boost::make_iterator_range(myViewFilters);
 }
 
@@ -129,11 +163,13 @@ boost::iterator_range<Score::ViewFilterConstIterator> Score::getViewFilters() co
 
 void Score::insertViewFilter(const ViewFilter &filter)
 {
+    markModified();
     myViewFilters.push_back(filter);
 }
 
 void Score::removeViewFilter(int index)
 {
+    markModified();
     myViewFilters.erase(myViewFilters.begin() + index);
 }
 
@@ -144,12 +180,35 @@ int Score::getLineSpacing() const
 
 void Score::setLineSpacing(int value)
 {
+    markModified();
     if (value < MIN_LINE_SPACING || value > MAX_LINE_SPACING)
         throw std::out_of_range("Invalid line spacing");
 
     myLineSpacing = value;
 }
 
+uint64_t Score::getRevision() const
+{
+    return myRevision;
+}
+
+uint64_t Score::getContentHash() const
+{
+    boost::optional<uint64_t> hash = myHashCache.find(myRevision);
+    if (!hash)
+    {
+        hash = ScoreUtils::hashContents(*this);
+        myHashCache.store(myRevision, *hash);
+    }
+
+    return *hash;
+}
+
+void Score::markModified()
+{
+    myRevision = ScoreUtils::nextRevision();
+}
+
 const PlayerChange *ScoreUtils::getCurrentPlayers(const Score &score,
                                                   int systemIndex,
                                                   int positionIndex)
@@ -19,6 +19,9 @@
 #define SCORE_SCORE_H
 
 #include <boost/range/iterator_range_core.hpp>
+#include "contenthash.h"
+#include "copyonwrite.h"
+#include <cstdint>
 #include "fileversion.h"
 #include "instrument.h"
 #include "player.h"
@@ -32,8 +35,8 @@ class PlayerChange;
 class Score
 {
 public:
-    typedef std::vector<System>::iterator SystemIterator;
-    typedef std::vector<System>::const_iterator SystemConstIterator;
+    typedef CopyOnWriteIterator<System> SystemIterator;
+    typedef CopyOnWriteConstIterator<System> SystemConstIterator;
     typedef std::vector<Player>::iterator PlayerIterator;
     typedef std::vector<Player>::const_iterator PlayerConstIterator;
     typedef std::vector<Instrument>::iterator InstrumentIterator;
@@ -41,9 +44,15 @@ public:
     typedef std::vector<ViewFilter>::iterator ViewFilterIterator;
     typedef std::vector<ViewFilter>::const_iterator ViewFilterConstIterator;
 
+    /// A list of systems that can be shared between scores. Each system is
+    /// only copied when it is modified.
+    typedef CopyOnWrite<std::vector<CopyOnWrite<System>>> SystemList;
+
     Score();
-    Score(const Score &other) = delete;
-    Score &operator=(const Score &other) = delete;
+    /// Copying a score is cheap, since the systems are shared with the
+    /// original score until they are modified.
+    Score(const Score &other) = default;
+    Score &operator=(const Score &other) = default;
     bool operator==(const Score &other) const;
 
     template <class Archive>
@@ -64,6 +73,12 @@ public:
     /// Removes the specified system from the score.
     void removeSystem(int index);
 
+    /// Returns a snapshot of the systems in the score, in constant time.
+    /// The snapshot is unaffected by later changes to the score.
+    SystemList getSystemsSnapshot() const;
+    /// Replaces the systems in the score with a previous snapshot.
+    void restoreSystemsSnapshot(const SystemList &systems);
+
     /// Returns the set of players in the score.
     boost::iterator_range<PlayerIterator> getPlayers();
     /// Returns the set of players in the score.
@@ -101,13 +116,26 @@ public:
     /// Sets the spacing between tabulature lines for the score.
     void setLineSpacing(int value);
 
+    /// Returns a stamp that changes whenever the score may have been
+    /// modified (including through the non-const accessors). Copies of the
+    /// score share the same revision until either of them is modified.
+    uint64_t getRevision() const;
+
+    /// Returns a hash of the score's contents, which is cached until the
+    /// score is modified.
+    uint64_t getContentHash() const;
+
     static const int MIN_LINE_SPACING;
     static const int MAX_LINE_SPACING;
 
 private:
+    void markModified();
+
+    uint64_t myRevision;
+    ContentHashCache myHashCache;
     // TODO - add font settings, chord diagrams, etc.
     ScoreInfo myScoreInfo;
-    std::vector<System> mySystems;
+    SystemList mySystems;
     std::vector<Player> myPlayers;
     std::vector<Instrument> myInstruments;
     int myLineSpacing; ///< Spacing between tab lines (in pixels).
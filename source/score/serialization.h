@@ -24,6 +24,7 @@
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
 #include <bitset>
+#include "copyonwrite.h"
 #include "fileversion.h"
 #include <map>
 #include <rapidjson/document.h>
@@ -136,6 +137,9 @@ private:
     template <typename T>
     void read(boost::optional<T> &val);
 
+    template <typename T>
+    void read(CopyOnWrite<T> &val);
+
     inline void read(boost::gregorian::date &date);
 
     template <typename T>
@@ -209,6 +213,9 @@ private:
     template <typename T>
     void write(const boost::optional<T> &val);
 
+    template <typename T>
+    void write(const CopyOnWrite<T> &val);
+
     inline void write(const boost::gregorian::date &date);
 
     template <typename T>
@@ -342,6 +349,12 @@ void InputArchive::read(boost::optional<T> &val)
     }
 }
 
+template <typename T>
+void InputArchive::read(CopyOnWrite<T> &val)
+{
+    read(val.write());
+}
+
 void InputArchive::read(boost::gregorian::date &date)
 {
     std::string date_str;
@@ -416,6 +429,12 @@ void OutputArchive::write(const boost::optional<T> &val)
         myStream.Null();
 }
 
+template <typename T>
+void OutputArchive::write(const CopyOnWrite<T> &val)
+{
+    write(*val);
+}
+
 void OutputArchive::write(const boost::gregorian::date &date)
 {
     write(boost::gregorian::to_iso_string(date));
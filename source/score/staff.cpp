@@ -17,14 +17,21 @@
 
 #include "staff.h"
 
+#include "contenthash.h"
+#include "revision.h"
 #include "utils.h"
 
-Staff::Staff() : myClefType(TrebleClef), myStringCount(6)
+Staff::Staff()
+    : myRevision(ScoreUtils::nextRevision()),
+      myClefType(TrebleClef),
+      myStringCount(6)
 {
 }
 
 Staff::Staff(int stringCount)
-    : myClefType(TrebleClef), myStringCount(stringCount)
+    : myRevision(ScoreUtils::nextRevision()),
+      myClefType(TrebleClef),
+      myStringCount(stringCount)
 {
 }
 
@@ -42,6 +49,7 @@ Staff::ClefType Staff::getClefType() const
 
 void Staff::setClefType(ClefType type)
 {
+    markModified();
     myClefType = type;
 }
 
@@ -52,6 +60,7 @@ int Staff::getStringCount() const
 
 void Staff::setStringCount(int count)
 {
+    markModified();
     myStringCount = count;
 
     // Clean up notes / positions that are no longer valid.
@@ -72,6 +81,7 @@ void Staff::setStringCount(int count)
 
 boost::iterator_range<Staff::VoiceIterator> Staff::getVoices()
 {
+    markModified();
     return boost::make_iterator_range(myVoices);
 }
 
@@ -82,6 +92,7 @@ boost::iterator_range<Staff::VoiceConstIterator> Staff::getVoices() const
 
 boost::iterator_range<Staff::DynamicIterator> Staff::getDynamics()
 {
+    markModified();
     return boost::make_iterator_range(myDynamics);
 }
 
@@ -92,10 +103,34 @@ boost::iterator_range<Staff::DynamicConstIterator> Staff::getDynamics() const
 
 void Staff::insertDynamic(const Dynamic &dynamic)
 {
+    markModified();
     ScoreUtils::insertObject(myDynamics, dynamic);
 }
 
 void Staff::removeDynamic(const Dynamic &dynamic)
 {
+    markModified();
     ScoreUtils::removeObject(myDynamics, dynamic);
 }
+
+uint64_t Staff::getRevision() const
+{
+    return myRevision;
+}
+
+uint64_t Staff::getContentHash() const
+{
+    boost::optional<uint64_t> hash = myHashCache.find(myRevision);
+    if (!hash)
+    {
+        hash = ScoreUtils::hashContents(*this);
+        myHashCache.store(myRevision, *hash);
+    }
+
+    return *hash;
+}
+
+void Staff::markModified()
+{
+    myRevision = ScoreUtils::nextRevision();
+}
@@ -20,6 +20,8 @@
 
 #include <array>
 #include <boost/range/iterator_range_core.hpp>
+#include "contenthash.h"
+#include <cstdint>
 #include "dynamic.h"
 #include "fileversion.h"
 #include <vector>
@@ -79,7 +81,20 @@ public:
     /// Removes the specified dynamic from the staff.
     void removeDynamic(const Dynamic &dynamic);
 
+    /// Returns a stamp that changes whenever the staff may have been modified
+    /// (including through the non-const accessors). Copies of the staff share
+    /// the same revision until either of them is modified.
+    uint64_t getRevision() const;
+
+    /// Returns a hash of the staff's contents, which is cached until the staff
+    /// is modified.
+    uint64_t getContentHash() const;
+
 private:
+    void markModified();
+
+    uint64_t myRevision;
+    ContentHashCache myHashCache;
     ClefType myClefType;
     int myStringCount;
     std::array<Voice, NUM_VOICES> myVoices;
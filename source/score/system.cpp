@@ -20,9 +20,12 @@
 #include <algorithm>
 #include <boost/range/adaptor/reversed.hpp>
 #include <cstddef>
+#include "contenthash.h"
+#include "revision.h"
 #include "utils.h"
 
 System::System()
+    : myRevision(ScoreUtils::nextRevision()), myOwnRevision(myRevision)
 {
     // Add the start and end bars.
     myBarlines.push_back(Barline());
@@ -44,31 +47,38 @@ bool System::operator==(const System &other) const
 
 boost::iterator_range<System::StaffIterator> System::getStaves()
 {
-    return boost::make_iterator_range(myStaves);
+    markStavesModified();
+    return boost::make_iterator_range(StaffIterator(myStaves.begin()),
+                                      StaffIterator(myStaves.end()));
 }
 
 boost::iterator_range<System::StaffConstIterator> System::getStaves() const
 {
-    return boost::make_iterator_range(myStaves);
+    return boost::make_iterator_range(StaffConstIterator(myStaves.begin()),
+                                      StaffConstIterator(myStaves.end()));
 }
 
 void System::insertStaff(const Staff &staff)
 {
-    myStaves.push_back(staff);
+    markModified();
+    myStaves.push_back(CopyOnWrite<Staff>(staff));
 }
 
 void System::insertStaff(const Staff &staff, int index)
 {
-    myStaves.insert(myStaves.begin() + index, staff);
+    markModified();
+    myStaves.insert(myStaves.begin() + index, CopyOnWrite<Staff>(staff));
 }
 
 void System::removeStaff(int index)
 {
+    markModified();
     myStaves.erase(myStaves.begin() + index);
 }
 
 boost::iterator_range<System::BarlineIterator> System::getBarlines()
 {
+    markModified();
     return boost::make_iterator_range(myBarlines);
 }
 
@@ -79,6 +89,7 @@ boost::iterator_range<System::BarlineConstIterator> System::getBarlines() const
 
 void System::insertBarline(const Barline &barline)
 {
+    markModified();
     // Ensure that the end bar remains the end bar.
     myBarlines.back().setPosition(
         std::max(myBarlines.back().getPosition(), barline.getPosition() + 1));
@@ -87,6 +98,7 @@ void System::insertBarline(const Barline &barline)
 
 void System::removeBarline(const Barline &barline)
 {
+    markModified();
     ScoreUtils::removeObject(myBarlines, barline);
 }
 
@@ -114,6 +126,7 @@ const Barline *System::getNextBarline(int position) const
 
 Barline *System::getNextBarline(int position)
 {
+    markModified();
     for (Barline &barline : myBarlines)
     {
         if (barline.getPosition() > position)
@@ -125,6 +138,7 @@ Barline *System::getNextBarline(int position)
 
 boost::iterator_range<System::TempoMarkerIterator> System::getTempoMarkers()
 {
+    markModified();
     return boost::make_iterator_range(myTempoMarkers);
 }
 
@@ -135,16 +149,19 @@ boost::iterator_range<System::TempoMarkerConstIterator> System::getTempoMarkers(
 
 void System::insertTempoMarker(const TempoMarker &marker)
 {
+    markModified();
     ScoreUtils::insertObject(myTempoMarkers, marker);
 }
 
 void System::removeTempoMarker(const TempoMarker &marker)
 {
+    markModified();
     ScoreUtils::removeObject(myTempoMarkers, marker);
 }
 
 boost::iterator_range<System::AlternateEndingIterator> System::getAlternateEndings()
 {
+    markModified();
     return boost::make_iterator_range(myAlternateEndings);
 }
 
@@ -155,16 +172,19 @@ boost::iterator_range<System::AlternateEndingConstIterator> System::getAlternate
 
 void System::insertAlternateEnding(const AlternateEnding &ending)
 {
+    markModified();
     ScoreUtils::insertObject(myAlternateEndings, ending);
 }
 
 void System::removeAlternateEnding(const AlternateEnding &ending)
 {
+    markModified();
     ScoreUtils::removeObject(myAlternateEndings, ending);
 }
 
 boost::iterator_range<System::DirectionIterator> System::getDirections()
 {
+    markModified();
     return boost::make_iterator_range(myDirections);
 }
 
@@ -175,16 +195,19 @@ boost::iterator_range<System::DirectionConstIterator> System::getDirections() co
 
 void System::insertDirection(const Direction &direction)
 {
+    markModified();
     ScoreUtils::insertObject(myDirections, direction);
 }
 
 void System::removeDirection(const Direction &direction)
 {
+    markModified();
     ScoreUtils::removeObject(myDirections, direction);
 }
 
 boost::iterator_range<System::PlayerChangeIterator> System::getPlayerChanges()
 {
+    markModified();
     return boost::make_iterator_range(myPlayerChanges);
 }
 
@@ -195,16 +218,19 @@ boost::iterator_range<System::PlayerChangeConstIterator> System::getPlayerChange
 
 void System::insertPlayerChange(const PlayerChange &change)
 {
+    markModified();
     ScoreUtils::insertObject(myPlayerChanges, change);
 }
 
 void System::removePlayerChange(const PlayerChange &change)
 {
+    markModified();
     ScoreUtils::removeObject(myPlayerChanges, change);
 }
 
 boost::iterator_range<System::ChordTextIterator> System::getChords()
 {
+    markModified();
     return boost::make_iterator_range(myChords);
 }
 
@@ -215,16 +241,19 @@ boost::iterator_range<System::ChordTextConstIterator> System::getChords() const
 
 void System::insertChord(const ChordText &chord)
 {
+    markModified();
     ScoreUtils::insertObject(myChords, chord);
 }
 
 void System::removeChord(const ChordText &chord)
 {
+    markModified();
     ScoreUtils::removeObject(myChords, chord);
 }
 
 boost::iterator_range<System::TextItemIterator> System::getTextItems()
 {
+    markModified();
     return boost::make_iterator_range(myTextItems);
 }
 
@@ -235,11 +264,13 @@ boost::iterator_range<System::TextItemConstIterator> System::getTextItems() cons
 
 void System::insertTextItem(const TextItem &text)
 {
+    markModified();
     ScoreUtils::insertObject(myTextItems, text);
 }
 
 void System::removeTextItem(const TextItem &text)
 {
+    markModified();
     ScoreUtils::removeObject(myTextItems, text);
 }
 
@@ -288,3 +319,36 @@ void SystemUtils::shiftBackward(System &system, int position)
 {
     shift(system, position, -1);
 }
+
+uint64_t System::getRevision() const
+{
+    return myRevision;
+}
+
+uint64_t System::getOwnRevision() const
+{
+    return myOwnRevision;
+}
+
+uint64_t System::getContentHash() const
+{
+    boost::optional<uint64_t> hash = myHashCache.find(myRevision);
+    if (!hash)
+    {
+        hash = ScoreUtils::hashContents(*this);
+        myHashCache.store(myRevision, *hash);
+    }
+
+    return *hash;
+}
+
+void System::markModified()
+{
+    myRevision = ScoreUtils::nextRevision();
+    myOwnRevision = myRevision;
+}
+
+void System::markStavesModified()
+{
+    myRevision = ScoreUtils::nextRevision();
+}
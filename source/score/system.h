@@ -22,6 +22,9 @@
 #include "barline.h"
 #include <boost/range/iterator_range_core.hpp>
 #include "chordtext.h"
+#include "contenthash.h"
+#include "copyonwrite.h"
+#include <cstdint>
 #include "direction.h"
 #include "fileversion.h"
 #include "playerchange.h"
@@ -33,8 +36,8 @@
 class System
 {
 public:
-    typedef std::vector<Staff>::iterator StaffIterator;
-    typedef std::vector<Staff>::const_iterator StaffConstIterator;
+    typedef CopyOnWriteIterator<Staff> StaffIterator;
+    typedef CopyOnWriteConstIterator<Staff> StaffConstIterator;
     typedef std::vector<Barline>::iterator BarlineIterator;
     typedef std::vector<Barline>::const_iterator BarlineConstIterator;
     typedef std::vector<TempoMarker>::iterator TempoMarkerIterator;
@@ -144,8 +147,32 @@ public:
     /// Removes the specified text item from the system.
     void removeTextItem(const TextItem &text);
 
+    /// Returns a stamp that changes whenever the system or any of its staves
+    /// may have been modified (including through the non-const accessors).
+    /// Copies of the system share the same revision until either of them is
+    /// modified.
+    uint64_t getRevision() const;
+    /// Returns a stamp that changes whenever the system may have been
+    /// modified, except for changes that were only made to the contents of its
+    /// staves (e.g. entering a note).
+    uint64_t getOwnRevision() const;
+
+    /// Returns a hash of the system's contents, which is cached until the
+    /// system is modified.
+    uint64_t getContentHash() const;
+
 private:
-    std::vector<Staff> myStaves;
+    void markModified();
+    /// Records a change to the contents of the staves, which doesn't modify
+    /// the system's own revision.
+    void markStavesModified();
+
+    uint64_t myRevision;
+    uint64_t myOwnRevision;
+    ContentHashCache myHashCache;
+    /// The staves are shared between copies of the system until they are
+    /// modified, so that copying a system only copies its staves on demand.
+    std::vector<CopyOnWrite<Staff>> myStaves;
     /// List of the barlines in the system. This will always contain at least
     /// two barlines - the start and end bars.
     std::vector<Barline> myBarlines;
@@ -0,0 +1,64 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_TICKS_H
+#define SCORE_TICKS_H
+
+#include <boost/config.hpp>
+#include <cstdint>
+
+/// Rhythmic durations are measured in ticks, at a fixed resolution that can
+/// represent every duration in the score exactly.
+namespace Ticks
+{
+/// Number of ticks in a quarter note. The shortest duration is a double dotted
+/// 64th note (7/64 of a quarter note), and an irregular grouping can divide a
+/// duration by up to 16 notes, so this is 64 * lcm(1, ..., 16).
+const int64_t PER_QUARTER = 64 * 720720LL;
+
+/// Resolution used for MIDI events. MIDI files store the resolution in 15
+/// bits, so it can't represent every duration exactly. Positions are instead
+/// placed at PER_QUARTER resolution and rounded to the nearest MIDI tick.
+const int MIDI_PER_QUARTER = 960;
+
+static_assert(PER_QUARTER % MIDI_PER_QUARTER == 0,
+              "The MIDI resolution must divide the score resolution.");
+
+/// A double dotted 64th note is 7/64 of a quarter note, so irregular
+/// groupings of up to 16 of the shortest notes are exact as long as this is a
+/// multiple of lcm(1, ..., 16).
+static_assert(PER_QUARTER / 64 % 720720 == 0,
+              "Irregular groupings of the shortest notes must be exact.");
+
+/// Returns the number of ticks in a note of the given duration type (e.g. 8
+/// for an eighth note) and number of dots.
+inline BOOST_CONSTEXPR int64_t getNoteDuration(int duration_type, int dots)
+{
+    return 4 * PER_QUARTER / duration_type * ((2 << dots) - 1) / (1 << dots);
+}
+
+/// Converts a number of ticks to the MIDI resolution, rounding to the
+/// nearest MIDI tick.
+inline BOOST_CONSTEXPR int toMidiTicks(int64_t ticks)
+{
+    return static_cast<int>(
+        (ticks + PER_QUARTER / MIDI_PER_QUARTER / 2) /
+        (PER_QUARTER / MIDI_PER_QUARTER));
+}
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scorediff.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <score/score.h>
+
+static std::vector<uint64_t> getSystemHashes(const Score &score)
+{
+    std::vector<uint64_t> hashes;
+    for (const System &system : score.getSystems())
+        hashes.push_back(system.getContentHash());
+
+    return hashes;
+}
+
+/// Records a run of removed and inserted systems. Systems that were replaced
+/// in place are reported as being changed.
+static void addDifferences(std::vector<ScoreUtils::SystemDifference> &diffs,
+                           int oldStart, int oldEnd, int newStart, int newEnd)
+{
+    using ScoreUtils::SystemDifference;
+
+    int i = oldStart;
+    int j = newStart;
+
+    for (; i < oldEnd && j < newEnd; ++i, ++j)
+        diffs.push_back(SystemDifference(SystemDifference::Changed, i, j));
+    for (; i < oldEnd; ++i)
+        diffs.push_back(SystemDifference(SystemDifference::Removed, i, -1));
+    for (; j < newEnd; ++j)
+        diffs.push_back(SystemDifference(SystemDifference::Inserted, -1, j));
+}
+
+std::vector<ScoreUtils::SystemDifference> ScoreUtils::diffScores(
+    const Score &oldScore, const Score &newScore)
+{
+    std::vector<SystemDifference> diffs;
+
+    if (oldScore.getContentHash() == newScore.getContentHash())
+        return diffs;
+
+    const std::vector<uint64_t> oldHashes = getSystemHashes(oldScore);
+    const std::vector<uint64_t> newHashes = getSystemHashes(newScore);
+
+    // Skip over any unchanged systems at the start or end of the score.
+    int prefix = 0;
+    const int maxPrefix = static_cast<int>(
+        std::min(oldHashes.size(), newHashes.size()));
+    while (prefix < maxPrefix && oldHashes[prefix] == newHashes[prefix])
+        ++prefix;
+
+    int oldEnd = static_cast<int>(oldHashes.size());
+    int newEnd = static_cast<int>(newHashes.size());
+    while (oldEnd > prefix && newEnd > prefix &&
+           oldHashes[oldEnd - 1] == newHashes[newEnd - 1])
+    {
+        --oldEnd;
+        --newEnd;
+    }
+
+    // Find the longest common subsequence of the remaining systems.
+    const int oldCount = oldEnd - prefix;
+    const int newCount = newEnd - prefix;
+    std::vector<int> lengths((oldCount + 1) * (newCount + 1), 0);
+    auto length = [&](int i, int j) -> int & {
+        return lengths[i * (newCount + 1) + j];
+    };
+
+    for (int i = oldCount - 1; i >= 0; --i)
+    {
+        for (int j = newCount - 1; j >= 0; --j)
+        {
+            if (oldHashes[prefix + i] == newHashes[prefix + j])
+                length(i, j) = length(i + 1, j + 1) + 1;
+            else
+                length(i, j) = std::max(length(i + 1, j), length(i, j + 1));
+        }
+    }
+
+    // Walk through the common subsequence, and report the systems in between
+    // the matching systems.
+    int i = 0;
+    int j = 0;
+    int oldRunStart = 0;
+    int newRunStart = 0;
+
+    while (i < oldCount && j < newCount)
+    {
+        if (oldHashes[prefix + i] == newHashes[prefix + j])
+        {
+            addDifferences(diffs, prefix + oldRunStart, prefix + i,
+                           prefix + newRunStart, prefix + j);
+            oldRunStart = ++i;
+            newRunStart = ++j;
+        }
+        else if (length(i + 1, j) >= length(i, j + 1))
+            ++i;
+        else
+            ++j;
+    }
+
+    addDifferences(diffs, prefix + oldRunStart, prefix + oldCount,
+                   prefix + newRunStart, prefix + newCount);
+
+    return diffs;
+}
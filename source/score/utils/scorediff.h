@@ -0,0 +1,62 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_UTILS_SCOREDIFF_H
+#define SCORE_UTILS_SCOREDIFF_H
+
+#include <vector>
+
+class Score;
+
+namespace ScoreUtils
+{
+/// Describes a system that differs between two versions of a score.
+struct SystemDifference
+{
+    enum Type
+    {
+        Changed,
+        Inserted,
+        Removed
+    };
+
+    SystemDifference(Type type, int oldIndex, int newIndex)
+        : myType(type), myOldIndex(oldIndex), myNewIndex(newIndex)
+    {
+    }
+
+    bool operator==(const SystemDifference &other) const
+    {
+        return myType == other.myType && myOldIndex == other.myOldIndex &&
+               myNewIndex == other.myNewIndex;
+    }
+
+    Type myType;
+    /// Index of the system in the old score, or -1 if it was inserted.
+    int myOldIndex;
+    /// Index of the system in the new score, or -1 if it was removed.
+    int myNewIndex;
+};
+
+/// Lists the systems that were changed, inserted, or removed between the two
+/// scores. Systems are compared using their content hashes, so unmodified
+/// systems are not visited again.
+std::vector<SystemDifference> diffScores(const Score &oldScore,
+                                         const Score &newScore);
+}
+
+#endif
@@ -19,7 +19,7 @@
 
 #include <map>
 #include <score/score.h>
-#include <score/voiceutils.h>
+#include <score/ticks.h>
 #include <score/utils.h>
 #include <unordered_map>
 #include <unordered_set>
@@ -27,6 +27,10 @@
 class TimeStamp
 {
 public:
+    TimeStamp() : myTime(0)
+    {
+    }
+
     bool operator<(const TimeStamp &other) const
     {
         if (myTime == other.myTime)
@@ -42,7 +46,7 @@ public:
             return myTime < other.myTime;
     }
 
-    void advance(const boost::rational<int> &duration)
+    void advance(int64_t duration)
     {
         myTime += duration;
     }
@@ -53,16 +57,16 @@ public:
     }
 
 private:
-    /// The time from the start of the bar.
-    boost::rational<int> myTime;
+    /// The time (in ticks) from the start of the bar.
+    int64_t myTime;
     /// Grace notes occur at the same timestamp as the note that they precede,
     /// but need to appear before the actual note.
     boost::optional<int> myGraceNoteNumber;
 };
 
-static int getDefaultNoteSpacing(const boost::rational<int> &duration)
+static int getDefaultNoteSpacing(int64_t duration)
 {
-    return std::max(2 * boost::rational_cast<int>(duration), 1);
+    return std::max(static_cast<int>(2 * (duration / Ticks::PER_QUARTER)), 1);
 }
 
 template <typename T>
@@ -151,6 +155,7 @@ void ScoreUtils::polishSystem(System &system)
         {
             for (const Voice &voice : staff.getVoices())
             {
+                const VoiceTimeline &timeline = voice.getTimeline();
                 TimeStamp timestamp;
                 boost::optional<int> grace_note;
                 int currentPosition = 0;
@@ -168,8 +173,8 @@ void ScoreUtils::polishSystem(System &system)
 
                     computeTimestampPosition(timestamp, currentPosition,
                                              timestampPositions);
-                    boost::rational<int> duration =
-                        VoiceUtils::getDurationTime(voice, position);
+                    const int64_t duration = timeline.getDuration(
+                        timeline.findIndex(position.getPosition()));
 
                     currentPosition = timestampPositions[timestamp] +
                                       getDefaultNoteSpacing(duration);
@@ -245,6 +250,19 @@ void ScoreUtils::polishSystem(System &system)
 
 void ScoreUtils::polishScore(Score &score)
 {
-    for (System &system : score.getSystems())
+    const Score &constScore = score;
+    const int systemCount = static_cast<int>(constScore.getSystems().size());
+
+    for (int i = 0; i < systemCount; ++i)
+    {
+        // Polish a copy of the system, and only replace the original if
+        // something changed. Systems that are shared with a snapshot of the
+        // score (e.g. for undo) then remain shared if they were unchanged.
+        const System &original = constScore.getSystems()[i];
+        System system(original);
         polishSystem(system);
+
+        if (!(system == original))
+            score.getSystems()[i] = system;
+    }
 }
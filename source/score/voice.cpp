@@ -31,6 +31,7 @@ bool Voice::operator==(const Voice &other) const
 
 boost::iterator_range<Voice::PositionIterator> Voice::getPositions()
 {
+    myTimeline.reset();
     return boost::make_iterator_range(myPositions);
 }
 
@@ -41,17 +42,20 @@ boost::iterator_range<Voice::PositionConstIterator> Voice::getPositions() const
 
 void Voice::insertPosition(const Position &position)
 {
+    myTimeline.reset();
     ScoreUtils::insertObject(myPositions, position);
 }
 
 void Voice::removePosition(const Position &position)
 {
+    myTimeline.reset();
     ScoreUtils::removeObject(myPositions, position);
 }
 
 boost::iterator_range<Voice::IrregularGroupingIterator>
 Voice:: getIrregularGroupings()
 {
+    myTimeline.reset();
     return boost::make_iterator_range(myIrregularGroupings);
 }
 
@@ -63,10 +67,17 @@ Voice:: getIrregularGroupings() const
 
 void Voice::insertIrregularGrouping(const IrregularGrouping &group)
 {
+    myTimeline.reset();
     ScoreUtils::insertObject(myIrregularGroupings, group);
 }
 
 void Voice::removeIrregularGrouping(const IrregularGrouping &group)
 {
+    myTimeline.reset();
     ScoreUtils::removeObject(myIrregularGroupings, group);
 }
+
+const VoiceTimeline &Voice::getTimeline() const
+{
+    return myTimeline.get([this]() { return VoiceTimeline(*this); });
+}
@@ -19,10 +19,12 @@
 #define SCORE_VOICE_H
 
 #include <boost/range/iterator_range_core.hpp>
+#include "cachedvalue.h"
 #include "fileversion.h"
 #include "irregulargrouping.h"
 #include "position.h"
 #include <vector>
+#include "voicetimeline.h"
 
 class Voice
 {
@@ -64,9 +66,16 @@ public:
     /// Removes the specified irregular grouping from the voice.
     void removeIrregularGrouping(const IrregularGrouping &group);
 
+    /// Returns the onsets and durations of the positions in the voice. This
+    /// is cached until the voice is modified through one of its non-const
+    /// methods, so references to positions must not be held across a call
+    /// to this method and then modified.
+    const VoiceTimeline &getTimeline() const;
+
 private:
     std::vector<Position> myPositions;
     std::vector<IrregularGrouping> myIrregularGroupings;
+    CachedValue<VoiceTimeline> myTimeline;
 };
 
 template <class Archive>
@@ -79,6 +88,7 @@ void Voice::serialize(Archive &ar, const FileVersion /*version*/)
 template <typename Predicate>
 void Voice::removePositions(Predicate p)
 {
+    myTimeline.reset();
     myPositions.erase(std::remove_if(myPositions.begin(), myPositions.end(), p),
                       myPositions.end());
 }
@@ -0,0 +1,137 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "voicetimeline.h"
+
+#include <algorithm>
+#include <boost/config.hpp>
+#include "ticks.h"
+#include "voice.h"
+
+VoiceTimeline::VoiceTimeline(const Voice &voice)
+{
+    for (const Position &pos : voice.getPositions())
+        myPositionNumbers.push_back(pos.getPosition());
+
+    const int count = getPositionCount();
+    std::vector<int64_t> durations;
+    durations.reserve(count);
+
+    for (const Position &pos : voice.getPositions())
+        durations.push_back(getBaseDuration(pos));
+
+    // Adjust for irregular groups. As an example, with triplets we have 3
+    // notes played in the time of 2, so each note is 2/3 of its normal
+    // duration. This is exact unless irregular groups are nested.
+    for (const IrregularGrouping &group : voice.getIrregularGroupings())
+    {
+        const int start = findIndex(group.getPosition());
+        if (start < 0)
+            continue;
+
+        const int end = std::min(start + group.getLength(), count);
+        for (int i = start; i < end; ++i)
+        {
+            durations[i] = durations[i] * group.getNotesPlayedOver() /
+                           group.getNotesPlayed();
+        }
+    }
+
+    myOnsets.reserve(count + 1);
+    myOnsets.push_back(0);
+    for (int64_t duration : durations)
+        myOnsets.push_back(myOnsets.back() + duration);
+}
+
+int VoiceTimeline::getPositionCount() const
+{
+    return static_cast<int>(myPositionNumbers.size());
+}
+
+int64_t VoiceTimeline::getOnset(int index) const
+{
+    return myOnsets[index];
+}
+
+int64_t VoiceTimeline::getDuration(int index) const
+{
+    return myOnsets[index + 1] - myOnsets[index];
+}
+
+int64_t VoiceTimeline::getTotalDuration() const
+{
+    return myOnsets.back();
+}
+
+int VoiceTimeline::findIndex(int position) const
+{
+    auto it = std::lower_bound(myPositionNumbers.begin(),
+                               myPositionNumbers.end(), position);
+    if (it == myPositionNumbers.end() || *it != position)
+        return -1;
+
+    return static_cast<int>(it - myPositionNumbers.begin());
+}
+
+int VoiceTimeline::findIndexAtTick(int64_t tick) const
+{
+    if (tick < 0 || tick >= getTotalDuration())
+        return -1;
+
+    // Find the last position that starts at or before the tick. Grace notes
+    // have no duration, so this skips over them to the note that they
+    // precede.
+    auto it = std::upper_bound(myOnsets.begin(), myOnsets.end(), tick);
+    return static_cast<int>(it - myOnsets.begin()) - 1;
+}
+
+/// Durations of whole notes through to 64th notes, with up to two dots. This
+/// is computed at compile time where constexpr is supported.
+static BOOST_CONSTEXPR_OR_CONST int64_t theNoteDurations[7][3] = {
+    { Ticks::getNoteDuration(1, 0), Ticks::getNoteDuration(1, 1),
+      Ticks::getNoteDuration(1, 2) },
+    { Ticks::getNoteDuration(2, 0), Ticks::getNoteDuration(2, 1),
+      Ticks::getNoteDuration(2, 2) },
+    { Ticks::getNoteDuration(4, 0), Ticks::getNoteDuration(4, 1),
+      Ticks::getNoteDuration(4, 2) },
+    { Ticks::getNoteDuration(8, 0), Ticks::getNoteDuration(8, 1),
+      Ticks::getNoteDuration(8, 2) },
+    { Ticks::getNoteDuration(16, 0), Ticks::getNoteDuration(16, 1),
+      Ticks::getNoteDuration(16, 2) },
+    { Ticks::getNoteDuration(32, 0), Ticks::getNoteDuration(32, 1),
+      Ticks::getNoteDuration(32, 2) },
+    { Ticks::getNoteDuration(64, 0), Ticks::getNoteDuration(64, 1),
+      Ticks::getNoteDuration(64, 2) }
+};
+
+int64_t VoiceTimeline::getBaseDuration(const Position &pos)
+{
+    if (pos.hasProperty(Position::Acciaccatura))
+        return 0;
+
+    int type_index = 0;
+    while ((1 << type_index) < pos.getDurationType())
+        ++type_index;
+
+    int dots = 0;
+    if (pos.hasProperty(Position::Dotted))
+        dots = 1;
+    else if (pos.hasProperty(Position::DoubleDotted))
+        dots = 2;
+
+    return theNoteDurations[type_index][dots];
+}
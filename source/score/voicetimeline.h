@@ -0,0 +1,65 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCORE_VOICETIMELINE_H
+#define SCORE_VOICETIMELINE_H
+
+#include <cstdint>
+#include <vector>
+
+class Position;
+class Voice;
+
+/// Stores the onset and duration (in ticks) of every position in a voice.
+/// Onsets are measured from the start of the voice, so the time from the
+/// start of a bar can be found by subtracting the onset of the bar's first
+/// position.
+class VoiceTimeline
+{
+public:
+    explicit VoiceTimeline(const Voice &voice);
+
+    /// Returns the number of positions in the voice.
+    int getPositionCount() const;
+
+    /// Returns the onset of the position at the given index. The index may
+    /// also be the number of positions, which gives the end of the voice.
+    int64_t getOnset(int index) const;
+    /// Returns the duration of the position at the given index, including
+    /// dots, irregular groupings, etc.
+    int64_t getDuration(int index) const;
+    /// Returns the total duration of the voice.
+    int64_t getTotalDuration() const;
+
+    /// Returns the index of the position with the given position number, or
+    /// -1 if there is no such position.
+    int findIndex(int position) const;
+    /// Returns the index of the position that is sounding at the given tick,
+    /// or -1 if the tick is outside the voice.
+    int findIndexAtTick(int64_t tick) const;
+
+    /// Returns the duration of a position, ignoring any irregular groupings.
+    static int64_t getBaseDuration(const Position &pos);
+
+private:
+    std::vector<int> myPositionNumbers;
+    /// Prefix sums of the durations, with an extra entry for the end of the
+    /// voice.
+    std::vector<int64_t> myOnsets;
+};
+
+#endif
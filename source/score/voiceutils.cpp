@@ -20,6 +20,7 @@
 #include <boost/range/adaptor/reversed.hpp>
 #include "score.h"
 #include "scorelocation.h"
+#include "ticks.h"
 #include "utils.h"
 
 namespace VoiceUtils
@@ -131,18 +132,9 @@ std::vector<const IrregularGrouping *> getIrregularGroupsInRange(
     return groups;
 }
 
-boost::rational<int> getDurationTime(const Voice &voice, const Position &pos)
+int64_t getDurationTime(const Voice &voice, const Position &pos)
 {
-    if (pos.hasProperty(Position::Acciaccatura))
-        return 0;
-
-    boost::rational<int> duration(4, pos.getDurationType());
-
-    // Adjust for dotted notes.
-    if (pos.hasProperty(Position::Dotted))
-        duration += (duration / 2);
-    if (pos.hasProperty(Position::DoubleDotted))
-        duration += duration * boost::rational<int>(3, 4);
+    int64_t duration = VoiceTimeline::getBaseDuration(pos);
 
     // Adjust for irregular groups.
     for (const IrregularGrouping *group :
@@ -150,8 +142,8 @@ boost::rational<int> getDurationTime(const Voice &voice, const Position &pos)
     {
         // As an example, with triplets we have 3 notes played in the time of 2,
         // so each note is 2/3 of its normal duration.
-        duration *= boost::rational<int>(group->getNotesPlayedOver(),
-                                         group->getNotesPlayed());
+        duration = duration * group->getNotesPlayedOver() /
+                   group->getNotesPlayed();
     }
 
     return duration;
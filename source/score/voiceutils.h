@@ -18,7 +18,7 @@
 #ifndef SCORE_VOICEUTILS_H
 #define SCORE_VOICEUTILS_H
 
-#include <boost/rational.hpp>
+#include <cstdint>
 #include <vector>
 
 class ScoreLocation;
@@ -63,9 +63,10 @@ std::vector<const IrregularGrouping *> getIrregularGroupsInRange(
     const Voice &voice, int left, int right);
 
 /// Returns the note duration, including dots, irregular groupings, etc.
-/// This does not include tempo, and the durations are relative to a
-/// quarter note (i.e. a quarter note is 1, eighth note is 1/2, etc).
-boost::rational<int> getDurationTime(const Voice &voice, const Position &pos);
+/// This does not include tempo, and the duration is measured in ticks (see
+/// Ticks::PER_QUARTER).
+/// To look up the durations of many positions, use Voice::getTimeline().
+int64_t getDurationTime(const Voice &voice, const Position &pos);
 }
 
 #endif
@@ -0,0 +1,58 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UTIL_PARALLELFOR_H
+#define UTIL_PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+/// Runs the task for each index from 0 to count - 1, on the given number of
+/// threads. By default, a thread is used for each hardware thread.
+/// If any of the tasks throw, the exception is rethrown once all of the
+/// threads have finished.
+inline void parallelFor(int count, const std::function<void(int)> &task,
+                        int thread_count = 0)
+{
+    if (thread_count <= 0)
+    {
+        thread_count =
+            std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+            task(i);
+    };
+
+    std::vector<std::future<void>> workers;
+    for (int i = 0; i < std::min(count, thread_count); ++i)
+        workers.push_back(std::async(std::launch::async, worker));
+
+    // Wait for all of the threads before reporting any errors.
+    for (auto &&w : workers)
+        w.wait();
+    for (auto &&w : workers)
+        w.get();
+}
+
+#endif
@@ -23,11 +23,13 @@
 
 Mixer::Mixer(QWidget *parent, const TuningDictionary &dictionary,
              const PlayerEditPubSub &editPubSub,
-             const PlayerRemovePubSub &removePubSub)
+             const PlayerRemovePubSub &removePubSub,
+             const PlayerMuteSoloPubSub &muteSoloPubSub)
     : QWidget(parent),
       myDictionary(dictionary),
       myEditPubSub(editPubSub),
-      myRemovePubSub(removePubSub)
+      myRemovePubSub(removePubSub),
+      myMuteSoloPubSub(muteSoloPubSub)
 {
     myLayout = new QVBoxLayout(this);
     myLayout->setSpacing(0);
@@ -43,7 +45,7 @@ void Mixer::reset(const Score &score)
     {
         myLayout->addWidget(new MixerItem(this, i, score.getPlayers()[i],
                                           myDictionary, myEditPubSub,
-                                          myRemovePubSub));
+                                          myRemovePubSub, myMuteSoloPubSub));
     }
 }
 
@@ -58,3 +60,21 @@ void Mixer::clear()
         delete item;
     }
 }
+
+bool Mixer::isPlayerMuted(int player) const
+{
+    const MixerItem *item = getItem(player);
+    return item && item->isMuted();
+}
+
+bool Mixer::isPlayerSolo(int player) const
+{
+    const MixerItem *item = getItem(player);
+    return item && item->isSolo();
+}
+
+const MixerItem *Mixer::getItem(int player) const
+{
+    QLayoutItem *item = myLayout->itemAt(player);
+    return item ? static_cast<const MixerItem *>(item->widget()) : nullptr;
+}
@@ -20,7 +20,9 @@
 
 #include <QWidget>
 
+class MixerItem;
 class PlayerEditPubSub;
+class PlayerMuteSoloPubSub;
 class PlayerRemovePubSub;
 class QVBoxLayout;
 class Score;
@@ -31,7 +33,8 @@ class Mixer : public QWidget
 public:
     Mixer(QWidget *parent, const TuningDictionary &dictionary,
           const PlayerEditPubSub &editPubSub,
-          const PlayerRemovePubSub &removePubSub);
+          const PlayerRemovePubSub &removePubSub,
+          const PlayerMuteSoloPubSub &muteSoloPubSub);
 
     /// Clear and then populate the mixer.
     void reset(const Score &score);
@@ -39,11 +42,19 @@ public:
     /// Removes all items from the mixer.
     void clear();
 
+    /// Returns whether the player is muted for playback.
+    bool isPlayerMuted(int player) const;
+    /// Returns whether the player is soloed for playback.
+    bool isPlayerSolo(int player) const;
+
 private:
+    const MixerItem *getItem(int player) const;
+
     QVBoxLayout *myLayout;
     const TuningDictionary &myDictionary;
     const PlayerEditPubSub &myEditPubSub;
     const PlayerRemovePubSub &myRemovePubSub;
+    const PlayerMuteSoloPubSub &myMuteSoloPubSub;
 };
 
 #endif
@@ -26,12 +26,14 @@
 MixerItem::MixerItem(QWidget *parent, int playerIndex, const Player &player,
                      const TuningDictionary &dictionary,
                      const PlayerEditPubSub &editPubSub,
-                     const PlayerRemovePubSub &removePubSub)
+                     const PlayerRemovePubSub &removePubSub,
+                     const PlayerMuteSoloPubSub &muteSoloPubSub)
     : QWidget(parent),
       ui(new Ui::MixerItem),
       myDictionary(dictionary),
       myEditPubSub(editPubSub),
       myRemovePubSub(removePubSub),
+      myMuteSoloPubSub(muteSoloPubSub),
       myPlayerIndex(playerIndex),
       myTuning(player.getTuning())
 {
@@ -69,6 +71,11 @@ MixerItem::MixerItem(QWidget *parent, int playerIndex, const Player &player,
         onEdited(false);
     });
 
+    connect(ui->muteButton, &QToolButton::toggled, this,
+            &MixerItem::onMuteSoloChanged);
+    connect(ui->soloButton, &QToolButton::toggled, this,
+            &MixerItem::onMuteSoloChanged);
+
     connect(ui->playerTuning, &ClickableLabel::clicked, this,
             &MixerItem::editTuning);
 
@@ -82,6 +89,16 @@ MixerItem::~MixerItem()
     delete ui;
 }
 
+bool MixerItem::isMuted() const
+{
+    return ui->muteButton->isChecked();
+}
+
+bool MixerItem::isSolo() const
+{
+    return ui->soloButton->isChecked();
+}
+
 void MixerItem::onPlayerNameEdited()
 {
     // Avoid sending another message when the editor becomes hidden.
@@ -120,3 +137,8 @@ void MixerItem::onEdited(bool undoable)
 
     myEditPubSub.publish(myPlayerIndex, player, undoable);
 }
+
+void MixerItem::onMuteSoloChanged()
+{
+    myMuteSoloPubSub.publish(myPlayerIndex, isMuted(), isSolo());
+}
@@ -28,6 +28,7 @@ class MixerItem;
 
 class Player;
 class PlayerEditPubSub;
+class PlayerMuteSoloPubSub;
 class PlayerRemovePubSub;
 class TuningDictionary;
 
@@ -37,18 +38,24 @@ public:
     explicit MixerItem(QWidget *parent, int playerIndex, const Player &player,
                        const TuningDictionary &dictionary,
                        const PlayerEditPubSub &editPubSub,
-                       const PlayerRemovePubSub &removePubSub);
+                       const PlayerRemovePubSub &removePubSub,
+                       const PlayerMuteSoloPubSub &muteSoloPubSub);
     ~MixerItem();
 
+    bool isMuted() const;
+    bool isSolo() const;
+
 private:
     void onPlayerNameEdited();
     void editTuning();
     void onEdited(bool undoable);
+    void onMuteSoloChanged();
 
     Ui::MixerItem *ui;
     const TuningDictionary &myDictionary;
     const PlayerEditPubSub &myEditPubSub;
     const PlayerRemovePubSub &myRemovePubSub;
+    const PlayerMuteSoloPubSub &myMuteSoloPubSub;
     const int myPlayerIndex;
     Tuning myTuning;
 };
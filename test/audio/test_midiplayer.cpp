@@ -0,0 +1,559 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <app/appinfo.h>
+#include <app/settingsmanager.h>
+#include <audio/midieventstream.h>
+#include <audio/midiplayer.h>
+#include <audio/recordingmidibackend.h>
+#include <audio/settings.h>
+#include <chrono>
+#include <cstdlib>
+#include <formats/guitar_pro/guitarproimporter.h>
+#include <map>
+#include <midi/midifile.h>
+#include <mutex>
+#include <score/generalmidi.h>
+#include <score/score.h>
+#include <thread>
+#include <vector>
+
+/// The playback speed (percent), so that the tests run quickly.
+static const int THE_PLAYBACK_SPEED = 1000;
+/// The maximum p99 timing error, which leaves headroom for busy test
+/// machines while still catching drift or late event generation.
+static const int64_t THE_MAX_JITTER_US = 20000;
+
+struct ExpectedNote
+{
+    uint8_t myStatus;
+    uint8_t myPitch;
+    int64_t myTime;
+};
+
+/// Computes the notes that should be played on each channel, and their
+/// timing (in microseconds). This uses the events from a MIDI file rather
+/// than the player's event stream, so that the events are generated
+/// independently.
+static std::map<int, std::vector<ExpectedNote>>
+getExpectedNotes(const Score &score)
+{
+    MidiFile file;
+    file.load(score, MidiFile::LoadOptions());
+
+    MidiEventList events;
+    for (const MidiEventList &track : file.getTracks())
+    {
+        MidiEventList track_events(track);
+        track_events.convertToAbsoluteTicks();
+        events.merge(track_events);
+    }
+
+    std::map<int, std::vector<ExpectedNote>> notes;
+    int beat_duration = Midi::BEAT_DURATION_120_BPM;
+    int prev_tick = 0;
+    int64_t time = 0;
+
+    for (const MidiEvent &event : events)
+    {
+        const int64_t duration_us =
+            static_cast<int64_t>(event.getTicks() - prev_tick) *
+            beat_duration / file.getTicksPerBeat();
+        time += static_cast<int64_t>(duration_us *
+                                     (100.0 / THE_PLAYBACK_SPEED));
+        prev_tick = event.getTicks();
+
+        if (event.isTempoChange())
+            beat_duration = event.getTempo();
+
+        if (event.isNoteOnOff())
+        {
+            notes[event.getChannel()].push_back(
+                { event.getData()[0], event.getData()[1], time });
+        }
+    }
+
+    return notes;
+}
+
+static void loadScore(const char *filename, Score &score,
+                      SettingsManager &settings_manager)
+{
+    GuitarProImporter importer;
+    importer.load(AppInfo::getAbsolutePath(filename), score);
+
+    auto settings = settings_manager.getWriteHandle();
+    settings->set(Settings::CountInEnabled, false);
+    settings->set(Settings::MetronomeEnabled, false);
+}
+
+static bool isNoteOnOff(const RecordingMidiBackend::Message &message)
+{
+    const uint8_t type = message.myData[0] & 0xf0;
+    return type == 0x80 || type == 0x90;
+}
+
+/// Plays the score, and returns the notes that were played on each channel.
+static std::map<int, std::vector<RecordingMidiBackend::Message>>
+playScore(const Score &score, SettingsManager &settings_manager)
+{
+    RecordingMidiBackend *recorder = new RecordingMidiBackend();
+    MidiPlayer player(settings_manager, ScoreLocation(score),
+                      THE_PLAYBACK_SPEED,
+                      std::unique_ptr<MidiOutputBackend>(recorder));
+    player.start();
+    player.wait();
+
+    std::map<int, std::vector<RecordingMidiBackend::Message>> notes;
+    for (const RecordingMidiBackend::Message &message :
+         recorder->getMessages())
+    {
+        if (isNoteOnOff(message))
+            notes[message.myData[0] & 0x0f].push_back(message);
+    }
+
+    return notes;
+}
+
+/// Checks that the notes for each channel are played in the same order as
+/// in the score. Simultaneous notes on different channels can be played in
+/// either order.
+static void checkPlayback(const char *filename)
+{
+    Score score;
+    SettingsManager settings_manager;
+    loadScore(filename, score, settings_manager);
+
+    const auto expected = getExpectedNotes(score);
+    REQUIRE(!expected.empty());
+
+    const auto notes = playScore(score, settings_manager);
+    REQUIRE(notes.size() == expected.size());
+
+    for (const auto &channel : expected)
+    {
+        INFO("Channel " << channel.first);
+        REQUIRE(notes.count(channel.first));
+
+        const auto &channel_notes = notes.at(channel.first);
+        REQUIRE(channel_notes.size() == channel.second.size());
+        for (size_t i = 0; i < channel_notes.size(); ++i)
+        {
+            REQUIRE(channel_notes[i].myData[0] == channel.second[i].myStatus);
+            REQUIRE(channel_notes[i].myData[1] == channel.second[i].myPitch);
+        }
+    }
+}
+
+/// Checks that the notes are played close to their scheduled times. This
+/// depends on the load of the machine, so these tests are hidden and need to
+/// be run explicitly (e.g. "pte_tests [timing]").
+static void checkTiming(const char *filename)
+{
+    Score score;
+    SettingsManager settings_manager;
+    loadScore(filename, score, settings_manager);
+
+    const auto expected = getExpectedNotes(score);
+    const auto notes = playScore(score, settings_manager);
+    REQUIRE(notes.size() == expected.size());
+
+    RecordingMidiBackend::Clock::time_point start =
+        RecordingMidiBackend::Clock::time_point::max();
+    for (const auto &channel : notes)
+        start = std::min(start, channel.second.front().myTime);
+
+    // Measure how far each note is from its scheduled time. The offsets are
+    // compared to the median offset rather than to the first note, since
+    // the first note isn't delayed by waking up from a sleep.
+    std::vector<int64_t> offsets;
+    for (const auto &channel : expected)
+    {
+        const auto &channel_notes = notes.at(channel.first);
+        REQUIRE(channel_notes.size() == channel.second.size());
+
+        for (size_t i = 0; i < channel_notes.size(); ++i)
+        {
+            const int64_t actual =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    channel_notes[i].myTime - start).count();
+            offsets.push_back(actual - channel.second[i].myTime);
+        }
+    }
+
+    std::vector<int64_t> sorted_offsets = offsets;
+    std::sort(sorted_offsets.begin(), sorted_offsets.end());
+    const int64_t median = sorted_offsets[sorted_offsets.size() / 2];
+
+    std::vector<int64_t> jitter;
+    for (int64_t offset : offsets)
+        jitter.push_back(std::abs(offset - median));
+    std::sort(jitter.begin(), jitter.end());
+
+    const int64_t p99 = jitter[(jitter.size() - 1) * 99 / 100];
+    INFO("p99 jitter: " << p99 << "us");
+    REQUIRE(p99 < THE_MAX_JITTER_US);
+}
+
+TEST_CASE("Audio/MidiPlayer/Notes", "")
+{
+    checkPlayback("data/notes.gp5");
+}
+
+TEST_CASE("Audio/MidiPlayer/GraceNotes", "")
+{
+    checkPlayback("data/gracenote.gp5");
+}
+
+TEST_CASE("Audio/MidiPlayer/Repeats", "")
+{
+    checkPlayback("data/barlines.gp5");
+}
+
+TEST_CASE("Audio/MidiPlayer/Tempos", "")
+{
+    checkPlayback("data/tempos.gp5");
+}
+
+TEST_CASE("Audio/MidiPlayer/MixerChanges", "")
+{
+    Score score;
+    SettingsManager settings_manager;
+    loadScore("data/notes.gp5", score, settings_manager);
+
+    RecordingMidiBackend *recorder = new RecordingMidiBackend();
+    MidiPlayer player(settings_manager, ScoreLocation(score),
+                      THE_PLAYBACK_SPEED,
+                      std::unique_ptr<MidiOutputBackend>(recorder));
+
+    // None of the changes should be lost, even if many changes are made
+    // before the playback thread applies them.
+    for (int i = 0; i < 5000; ++i)
+        player.setPlayerVolume(0, static_cast<uint8_t>(i % 128));
+    player.setPlayerMuted(0, true);
+
+    player.start();
+    player.wait();
+
+    const int channel = MidiFile::getPlayerChannel(0);
+    for (const RecordingMidiBackend::Message &message :
+         recorder->getMessages())
+    {
+        REQUIRE(message.myData[0] != (0x90 | channel));
+    }
+}
+
+TEST_CASE("Audio/MidiPlayer/Timing/Notes", "[.][timing]")
+{
+    checkTiming("data/notes.gp5");
+}
+
+TEST_CASE("Audio/MidiPlayer/Timing/GraceNotes", "[.][timing]")
+{
+    checkTiming("data/gracenote.gp5");
+}
+
+TEST_CASE("Audio/MidiPlayer/Timing/Repeats", "[.][timing]")
+{
+    checkTiming("data/barlines.gp5");
+}
+
+TEST_CASE("Audio/MidiPlayer/Timing/Tempos", "[.][timing]")
+{
+    checkTiming("data/tempos.gp5");
+}
+
+/// Forwards the messages to a recorder that outlives the player, since a loop
+/// only stops when the player is destroyed.
+class ForwardingBackend : public MidiOutputBackend
+{
+public:
+    ForwardingBackend(MidiOutputBackend &target) : myTarget(target)
+    {
+    }
+
+    virtual bool sendMessage(const uint8_t *data, size_t size) override
+    {
+        return myTarget.sendMessage(data, size);
+    }
+
+private:
+    MidiOutputBackend &myTarget;
+};
+
+TEST_CASE("Audio/MidiPlayer/Timing/Loop", "[.][timing]")
+{
+    Score score;
+    SettingsManager settings_manager;
+    loadScore("data/notes.gp5", score, settings_manager);
+
+    // Loop the second bar, which is four beats long at 120 bpm.
+    const int64_t period_us =
+        4 * Midi::BEAT_DURATION_120_BPM * 100 / THE_PLAYBACK_SPEED;
+
+    RecordingMidiBackend recorder;
+    {
+        MidiPlayer player(settings_manager, ScoreLocation(score, 0, 0, 8),
+                          THE_PLAYBACK_SPEED,
+                          std::unique_ptr<MidiOutputBackend>(
+                              new ForwardingBackend(recorder)));
+        player.setLoop(SystemLocation(0, 17));
+        player.start();
+
+        std::this_thread::sleep_for(std::chrono::microseconds(period_us * 3));
+    }
+
+    std::vector<RecordingMidiBackend::Message> notes;
+    for (const RecordingMidiBackend::Message &message :
+         recorder.getMessages())
+    {
+        if ((message.myData[0] & 0xf0) == 0x90)
+            notes.push_back(message);
+    }
+    REQUIRE(!notes.empty());
+
+    auto getTime = [&](size_t i) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   notes[i].myTime - notes.front().myTime).count();
+    };
+
+    // Find the notes from the first repetition.
+    size_t count = 0;
+    const int64_t first_repetition_end = period_us - THE_MAX_JITTER_US;
+    while (count < notes.size() && getTime(count) < first_repetition_end)
+        ++count;
+    REQUIRE(count > 0);
+    REQUIRE(notes.size() >= 2 * count);
+
+    // Each repetition should play the same notes, without any gap at the
+    // loop boundary.
+    for (size_t i = 0; i + count < notes.size(); ++i)
+    {
+        REQUIRE(notes[i + count].myData == notes[i].myData);
+
+        const int64_t offset = getTime(i + count) - getTime(i) - period_us;
+        INFO("Offset of note " << i << ": " << offset << "us");
+        REQUIRE(std::abs(offset) < THE_MAX_JITTER_US);
+    }
+}
+
+/// Creates a score with three bars, where the tempo, instrument, volume and
+/// pitch wheel are set in the first bar, before the second bar is looped.
+static Score makeLoopScore()
+{
+    Score score;
+    score.insertPlayer(Player());
+    Instrument instrument;
+    instrument.setMidiPreset(Midi::MIDI_PRESET_DISTORTION_GUITAR);
+    score.insertInstrument(instrument);
+
+    System system;
+    system.insertBarline(Barline(8, Barline::SingleBar));
+    system.insertBarline(Barline(16, Barline::SingleBar));
+
+    TempoMarker marker(0);
+    marker.setBeatsPerMinute(90);
+    system.insertTempoMarker(marker);
+
+    Staff staff(6);
+    staff.insertDynamic(Dynamic(1, Dynamic::mp));
+
+    // A bend that is held into the second bar.
+    Voice &voice = staff.getVoices()[0];
+    Position bent(1, Position::WholeNote);
+    bent.insertNote(Note(2, 5));
+    bent.getNotes()[0].setBend(Bend(Bend::BendAndHold, 4, 0, 1));
+    voice.insertPosition(bent);
+
+    for (int position : { 9, 17 })
+    {
+        Position pos(position, Position::WholeNote);
+        pos.insertNote(Note(3, position));
+        voice.insertPosition(pos);
+    }
+
+    system.insertStaff(staff);
+
+    PlayerChange change;
+    change.insertActivePlayer(0, ActivePlayer(0, 0));
+    system.insertPlayerChange(change);
+    score.insertSystem(system);
+    return score;
+}
+
+/// Returns the first event from the loop's entry state that matches the
+/// predicate.
+template <typename Predicate>
+static const MidiEvent *findEntryEvent(const MidiPlayer::Loop &loop,
+                                       Predicate predicate)
+{
+    auto it = std::find_if(loop.myEntryEvents.begin(),
+                           loop.myEntryEvents.end(), predicate);
+    return it != loop.myEntryEvents.end() ? &*it : nullptr;
+}
+
+TEST_CASE("Audio/MidiPlayer/CompileLoop", "")
+{
+    const Score score = makeLoopScore();
+    const SystemLocation start(0, 8);
+    const SystemLocation end(0, 16);
+    const uint8_t channel = MidiFile::getPlayerChannel(0);
+
+    MidiFile::LoadOptions options;
+    options.myRecordPositionChanges = true;
+
+    // Find the expected pitch wheel value at the start of the loop, and the
+    // notes in the loop.
+    MidiFile file;
+    file.load(score, options);
+    const MidiEvent *pitch_wheel = nullptr;
+    std::vector<std::vector<uint8_t>> expected_notes;
+    for (const MidiEventList &track : file.getTracks())
+    {
+        for (const MidiEvent &event : track)
+        {
+            if (event.getLocation() < start &&
+                event.getStatusByte() == (MidiEvent::PitchWheel | channel))
+            {
+                pitch_wheel = &event;
+            }
+            else if (event.isNoteOn() && event.getChannel() == channel &&
+                     !(event.getLocation() < start) &&
+                     event.getLocation() < end)
+            {
+                expected_notes.emplace_back(
+                    event.getData(), event.getData() + event.getDataSize());
+            }
+        }
+    }
+    REQUIRE(pitch_wheel);
+    REQUIRE(expected_notes.size() == 1);
+
+    MidiEventStream stream(score, options, 4);
+    MidiPlayer::Loop loop;
+    REQUIRE(MidiPlayer::compileLoop(stream, start, end, loop));
+
+    // The state of the channel at the start of the loop.
+    REQUIRE(loop.myStartTempo == 60000000 / 90);
+
+    const MidiEvent *program = findEntryEvent(loop, [=](const MidiEvent &e) {
+        return e.isProgramChange() && e.getChannel() == channel;
+    });
+    REQUIRE(program);
+    REQUIRE(program->getData()[1] == Midi::MIDI_PRESET_DISTORTION_GUITAR);
+
+    const MidiEvent *volume = findEntryEvent(loop, [=](const MidiEvent &e) {
+        return e.isVolumeChange() && e.getChannel() == channel;
+    });
+    REQUIRE(volume);
+    REQUIRE(volume->getVolume() == Dynamic::mp);
+
+    const MidiEvent *bend = findEntryEvent(loop, [=](const MidiEvent &e) {
+        return e.getStatusByte() == (MidiEvent::PitchWheel | channel);
+    });
+    REQUIRE(bend);
+    REQUIRE(bend->getData()[1] == pitch_wheel->getData()[1]);
+    REQUIRE(bend->getData()[2] == pitch_wheel->getData()[2]);
+
+    // The loop wraps around at the end of the bar, which has four beats.
+    REQUIRE(loop.myEndTick - loop.myStartTick ==
+            4 * stream.getTicksPerBeat());
+
+    // Only the player's notes from the looped bar are repeated. The
+    // metronome's events are still generated while it is muted.
+    std::vector<std::vector<uint8_t>> notes;
+    for (const MidiEvent &event : loop.myEvents)
+    {
+        REQUIRE(event.getTicks() >= loop.myStartTick);
+        REQUIRE(event.getTicks() <= loop.myEndTick);
+
+        if (event.isNoteOn() && event.getChannel() == channel)
+        {
+            notes.emplace_back(event.getData(),
+                               event.getData() + event.getDataSize());
+        }
+    }
+    REQUIRE(notes == expected_notes);
+}
+
+/// Records the notes that are played on the first player's channel, and can
+/// be read while the player is still running.
+class NoteRecorder : public MidiOutputBackend
+{
+public:
+    virtual bool sendMessage(const uint8_t *data, size_t size) override
+    {
+        if (size == 3 && data[0] == (0x90 | MidiFile::getPlayerChannel(0)) &&
+            data[2] > 0)
+        {
+            std::lock_guard<std::mutex> lock(myMutex);
+            myNotes.push_back(data[1]);
+        }
+
+        return true;
+    }
+
+    std::vector<uint8_t> getNotes() const
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        return myNotes;
+    }
+
+private:
+    mutable std::mutex myMutex;
+    std::vector<uint8_t> myNotes;
+};
+
+TEST_CASE("Audio/MidiPlayer/LoopRepeats", "")
+{
+    const Score score = makeLoopScore();
+    SettingsManager settings_manager;
+    {
+        auto settings = settings_manager.getWriteHandle();
+        settings->set(Settings::CountInEnabled, false);
+        settings->set(Settings::MetronomeEnabled, false);
+    }
+
+    NoteRecorder recorder;
+    {
+        MidiPlayer player(settings_manager, ScoreLocation(score, 0, 0, 8),
+                          THE_PLAYBACK_SPEED,
+                          std::unique_ptr<MidiOutputBackend>(
+                              new ForwardingBackend(recorder)));
+        player.setLoop(SystemLocation(0, 16));
+        player.start();
+
+        // Wait for a few repetitions, rather than for a fixed time.
+        const auto timeout =
+            std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (recorder.getNotes().size() < 3 &&
+               std::chrono::steady_clock::now() < timeout)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    // The note from the second bar is played on each repetition, without
+    // any notes from the bars around it.
+    const std::vector<uint8_t> notes = recorder.getNotes();
+    REQUIRE(notes.size() >= 3);
+    REQUIRE(std::count(notes.begin(), notes.end(), notes.front()) ==
+            static_cast<int>(notes.size()));
+}
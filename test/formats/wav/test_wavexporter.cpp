@@ -0,0 +1,94 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#include <catch.hpp>
+
+#include <app/settingsmanager.h>
+#include <boost/filesystem/operations.hpp>
+#include <cstdint>
+#include <formats/wav/wavexporter.h>
+#include <fstream>
+#include <iterator>
+#include <score/score.h>
+#include <string>
+
+/// Reads a little-endian value from the file's contents.
+static uint32_t read(const std::string &data, size_t offset, int num_bytes)
+{
+    uint32_t val = 0;
+    for (int i = num_bytes - 1; i >= 0; --i)
+        val = val << 8 | static_cast<uint8_t>(data[offset + i]);
+
+    return val;
+}
+
+TEST_CASE("Formats/WavExport/Header", "")
+{
+    // A single bar of 4/4 with a whole note.
+    Score score;
+    score.insertPlayer(Player());
+    score.insertInstrument(Instrument());
+
+    System system;
+    Staff staff(6);
+    Position pos(1, Position::WholeNote);
+    pos.insertNote(Note(2, 5));
+    staff.getVoices()[0].insertPosition(pos);
+    system.insertStaff(staff);
+
+    PlayerChange change;
+    change.insertActivePlayer(0, ActivePlayer(0, 0));
+    system.insertPlayerChange(change);
+    score.insertSystem(system);
+
+    const boost::filesystem::path path =
+        boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("pte-%%%%-%%%%.wav");
+
+    SettingsManager settings_manager;
+    WavExporter exporter(settings_manager);
+    exporter.save(path.string(), score);
+
+    std::string data;
+    {
+        std::ifstream file(path.string(), std::ios::in | std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+    }
+    boost::filesystem::remove(path);
+
+    REQUIRE(data.size() > 44);
+    REQUIRE(data.substr(0, 4) == "RIFF");
+    REQUIRE(read(data, 4, 4) == data.size() - 8);
+    REQUIRE(data.substr(8, 4) == "WAVE");
+
+    // 16-bit stereo PCM at 44.1kHz.
+    REQUIRE(data.substr(12, 4) == "fmt ");
+    REQUIRE(read(data, 16, 4) == 16);
+    REQUIRE(read(data, 20, 2) == 1);
+    REQUIRE(read(data, 22, 2) == 2);
+    REQUIRE(read(data, 24, 4) == 44100);
+    REQUIRE(read(data, 28, 4) == 44100 * 4);
+    REQUIRE(read(data, 32, 2) == 4);
+    REQUIRE(read(data, 34, 2) == 16);
+
+    // The bar lasts for two seconds at the default tempo, followed by 1.5
+    // seconds for the notes to be released.
+    REQUIRE(data.substr(36, 4) == "data");
+    REQUIRE(read(data, 40, 4) == data.size() - 44);
+    REQUIRE(read(data, 40, 4) == static_cast<uint32_t>(3.5 * 44100) * 4);
+}
@@ -0,0 +1,101 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <boost/config.hpp>
+#include <midi/midievent.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef BOOST_NO_CXX11_NOEXCEPT
+static_assert(std::is_nothrow_move_constructible<MidiEvent>::value,
+              "Moving a MidiEvent should not throw.");
+#endif
+
+static void requireEqual(const MidiEvent &event, const MidiEvent &expected)
+{
+    REQUIRE(event.getTicks() == expected.getTicks());
+    REQUIRE(event.getLocation() == expected.getLocation());
+    REQUIRE(event.getDataSize() == expected.getDataSize());
+    REQUIRE(std::vector<uint8_t>(event.getData(),
+                                 event.getData() + event.getDataSize()) ==
+            std::vector<uint8_t>(expected.getData(),
+                                 expected.getData() +
+                                     expected.getDataSize()));
+}
+
+static void checkCopyAndMove(const MidiEvent &event)
+{
+    MidiEvent copy(event);
+    requireEqual(copy, event);
+
+    MidiEvent moved(std::move(copy));
+    requireEqual(moved, event);
+
+    MidiEvent assigned = MidiEvent::endOfTrack(0);
+    assigned = moved;
+    requireEqual(assigned, event);
+
+    MidiEvent move_assigned = MidiEvent::endOfTrack(0);
+    move_assigned = std::move(moved);
+    requireEqual(move_assigned, event);
+
+    // The moved-from events can still be reused.
+    copy = move_assigned;
+    moved = copy;
+    requireEqual(copy, event);
+    requireEqual(moved, event);
+
+    // Growing the vector moves the events.
+    std::vector<MidiEvent> events;
+    for (int i = 0; i < 100; ++i)
+        events.push_back(event);
+    for (const MidiEvent &e : events)
+        requireEqual(e, event);
+}
+
+TEST_CASE("Midi/MidiEvent/InlineData", "")
+{
+    const MidiEvent event =
+        MidiEvent::noteOn(42, 3, 60, 100, SystemLocation(1, 5));
+    const size_t max_inline_size = MidiEvent::MAX_INLINE_SIZE;
+    REQUIRE(event.getDataSize() <= max_inline_size);
+
+    checkCopyAndMove(event);
+}
+
+TEST_CASE("Midi/MidiEvent/ExtendedData", "")
+{
+    const std::string name(200, 'x');
+    const MidiEvent event = MidiEvent::trackName(7, name);
+    const size_t max_inline_size = MidiEvent::MAX_INLINE_SIZE;
+    REQUIRE(event.getDataSize() > max_inline_size);
+
+    // The name is stored after the status byte, meta type and length.
+    const uint8_t *data = event.getData();
+    REQUIRE(std::string(data + event.getDataSize() - name.size(),
+                        data + event.getDataSize()) == name);
+
+    // Copies have their own data.
+    const MidiEvent copy(event);
+    REQUIRE(copy.getData() != event.getData());
+
+    checkCopyAndMove(event);
+}
@@ -0,0 +1,399 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <app/appinfo.h>
+#include <audio/midieventstream.h>
+#include <formats/guitar_pro/guitarproimporter.h>
+#include <formats/powertab_old/powertaboldimporter.h>
+#include <fstream>
+#include <map>
+#include <midi/midifile.h>
+#include <score/score.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// The scores from the import tests, which cover repeats, alternate endings,
+/// directions, bends, slides, grace notes and tempo changes.
+static const char *theScores[] = {
+    "alternate_endings.ptb", "barlines.ptb",     "bends.ptb",
+    "chordtext.ptb",         "directions.ptb",   "floating_text.ptb",
+    "guitar_ins.ptb",        "guitars.ptb",      "notes.ptb",
+    "positions.ptb",         "song_header.ptb",  "staves.ptb",
+    "tempo_markers.ptb",     "alt_endings.gp5",  "barlines.gp5",
+    "gracenote.gp5",         "irregular.gp5",    "keys.gp5",
+    "notes.gp5",             "positions.gp5",    "rehearsal_signs.gp5",
+    "tempos.gp5",            "text.gp5",         "time_signatures.gp5"
+};
+
+static void loadScore(const std::string &filename, Score &score)
+{
+    const std::string path =
+        AppInfo::getAbsolutePath(("data/" + filename).c_str());
+
+    if (filename.substr(filename.size() - 4) == ".ptb")
+    {
+        PowerTabOldImporter importer;
+        importer.load(path, score);
+    }
+    else
+    {
+        GuitarProImporter importer;
+        importer.load(path, score);
+    }
+}
+
+/// Adds vibrato, slides and bends throughout the score, to produce plenty of
+/// controller events.
+static void addEffects(Score &score)
+{
+    int count = 0;
+    for (System &system : score.getSystems())
+    {
+        for (Staff &staff : system.getStaves())
+        {
+            for (Voice &voice : staff.getVoices())
+            {
+                for (Position &pos : voice.getPositions())
+                {
+                    pos.setProperty(Position::Vibrato, count % 3 == 0);
+
+                    for (Note &note : pos.getNotes())
+                    {
+                        if (++count % 2)
+                            note.setProperty(Note::LegatoSlide);
+                        else
+                            note.setBend(Bend(Bend::BendAndRelease, 8, 0, 1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+static MidiFile::LoadOptions getOptions()
+{
+    MidiFile::LoadOptions options;
+    options.myVibratoStrength = 85;
+    options.myWideVibratoStrength = 127;
+    options.myEnableMetronome = true;
+    options.myStrongAccentVel = 127;
+    options.myWeakAccentVel = 80;
+    options.myMetronomePreset = 33;
+    options.myRecordPositionChanges = true;
+    return options;
+}
+
+static std::string describeEvent(const MidiEvent &event)
+{
+    std::ostringstream out;
+    out << event.getTicks() << ":" << std::hex;
+    for (size_t i = 0; i < event.getDataSize(); ++i)
+        out << " " << static_cast<int>(event.getData()[i]);
+
+    return out.str();
+}
+
+static std::vector<std::string> describeEvents(const MidiEventList &events)
+{
+    std::vector<std::string> descriptions;
+    for (const MidiEvent &event : events)
+        descriptions.push_back(describeEvent(event));
+
+    return descriptions;
+}
+
+/// Generates the events for each track (the master track, each player's
+/// track, and the metronome) without sorting them.
+static std::vector<std::vector<std::string>>
+generateTracks(const Score &score, bool parallel, bool cache_bars)
+{
+    MidiEventGenerator generator(score, getOptions(), cache_bars);
+    MidiEventList master_track;
+    std::vector<MidiEventList> player_tracks(score.getPlayers().size());
+    MidiEventList metronome_track;
+
+    if (parallel)
+    {
+        generator.generateRemainingBars(master_track, player_tracks,
+                                        metronome_track);
+    }
+    else
+    {
+        while (generator.generateNextBar(master_track, player_tracks,
+                                         metronome_track))
+        {
+        }
+    }
+
+    std::vector<std::vector<std::string>> tracks;
+    tracks.push_back(describeEvents(master_track));
+    for (const MidiEventList &track : player_tracks)
+        tracks.push_back(describeEvents(track));
+    tracks.push_back(describeEvents(metronome_track));
+    return tracks;
+}
+
+/// Describes the events for each channel, and each type of meta event.
+static std::map<int, std::vector<std::string>>
+describeChannels(const MidiEventList &events)
+{
+    std::map<int, std::vector<std::string>> channels;
+    for (const MidiEvent &event : events)
+    {
+        const int key = event.getStatusByte() < MidiEvent::SysEx
+                            ? event.getChannel()
+                            : event.getStatusByte() << 8 | event.getData()[1];
+        channels[key].push_back(describeEvent(event));
+    }
+
+    return channels;
+}
+
+/// Describes the events in each track, where the controller events (e.g.
+/// pitch bends) are replaced by the controller's value after each tick where
+/// it changes. Controller events that don't have an effect are ignored.
+static std::string describeTimelines(const MidiFile &file)
+{
+    std::ostringstream out;
+
+    for (const MidiEventList &track : file.getTracks())
+    {
+        out << "track\n";
+
+        MidiEventList events(track);
+        events.convertToAbsoluteTicks();
+
+        std::map<std::string, int> values;
+        std::map<std::string, int> changes;
+        int tick = 0;
+
+        auto flushChanges = [&]() {
+            for (const auto &change : changes)
+            {
+                auto value = values.find(change.first);
+                if (value == values.end() || value->second != change.second)
+                {
+                    out << tick << ": " << change.first << " = "
+                        << change.second << "\n";
+                    values[change.first] = change.second;
+                }
+            }
+            changes.clear();
+        };
+
+        for (const MidiEvent &event : events)
+        {
+            if (event.getTicks() != tick)
+            {
+                flushChanges();
+                tick = event.getTicks();
+            }
+
+            if (!event.isControllerValue())
+            {
+                out << describeEvent(event) << "\n";
+                continue;
+            }
+
+            // Pitch wheel events have a 14-bit value, while the other
+            // controllers are identified by their first data byte.
+            const uint8_t *data = event.getData();
+            std::ostringstream key;
+            key << std::hex << static_cast<int>(data[0]);
+
+            if ((data[0] & 0xf0) == MidiEvent::PitchWheel)
+                changes[key.str()] = data[1] | data[2] << 7;
+            else
+            {
+                key << " " << static_cast<int>(data[1]);
+                changes[key.str()] = data[2];
+            }
+        }
+
+        flushChanges();
+    }
+
+    return out.str();
+}
+
+/// Reads the expected descriptions for each score, which are separated by
+/// lines with the score's name.
+static std::map<std::string, std::string> readTimelines(const char *filename)
+{
+    std::ifstream file(AppInfo::getAbsolutePath(filename));
+    std::map<std::string, std::string> timelines;
+    std::string name;
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (line.compare(0, 6, "score ") == 0)
+            name = line.substr(6);
+        else
+            timelines[name] += line + "\n";
+    }
+
+    return timelines;
+}
+
+TEST_CASE("Midi/MidiFile/StreamMatchesFile", "")
+{
+    for (const char *filename : theScores)
+    {
+        INFO(filename);
+        Score score;
+        loadScore(filename, score);
+
+        MidiFile file;
+        file.load(score, getOptions());
+
+        MidiEventList expected;
+        for (const MidiEventList &track : file.getTracks())
+        {
+            MidiEventList events(track);
+            events.convertToAbsoluteTicks();
+            // The end of track events aren't streamed.
+            events.erase(events.end() - 1, events.end());
+            expected.merge(events);
+        }
+
+        MidiEventStream stream(score, getOptions(), 2);
+        MidiEventList streamed;
+        MidiEventList events;
+        while (stream.readEvents(events))
+            streamed.concat(events);
+
+        REQUIRE(std::is_sorted(streamed.begin(), streamed.end()));
+        // Simultaneous events from different tracks can be interleaved
+        // differently at the start of a bar.
+        REQUIRE(describeChannels(streamed) == describeChannels(expected));
+    }
+}
+
+TEST_CASE("Midi/MidiFile/ParallelMatchesSerial", "")
+{
+    for (const char *filename : theScores)
+    {
+        INFO(filename);
+        Score score;
+        loadScore(filename, score);
+        addEffects(score);
+
+        REQUIRE(generateTracks(score, true, true) ==
+                generateTracks(score, false, true));
+    }
+}
+
+TEST_CASE("Midi/MidiFile/CachedMatchesUncached", "")
+{
+    for (const char *filename : theScores)
+    {
+        INFO(filename);
+        Score score;
+        loadScore(filename, score);
+        addEffects(score);
+
+        REQUIRE(generateTracks(score, false, true) ==
+                generateTracks(score, false, false));
+        REQUIRE(generateTracks(score, true, true) ==
+                generateTracks(score, true, false));
+    }
+}
+
+TEST_CASE("Midi/MidiFile/CachedRepeatWithHeldBend", "")
+{
+    Score score;
+    score.insertPlayer(Player());
+    score.insertInstrument(Instrument());
+
+    System system;
+    Staff staff(6);
+    system.insertBarline(Barline(8, Barline::RepeatStart));
+    system.insertBarline(Barline(16, Barline::RepeatEnd, 2));
+
+    // The repeated bar releases a bend that is held from the previous bar,
+    // and then holds another bend. The second pass through the bar starts
+    // from a different bend than the first pass.
+    Voice &voice = staff.getVoices()[0];
+    Position first(1, Position::HalfNote);
+    first.insertNote(Note(2, 5));
+    first.getNotes()[0].setBend(Bend(Bend::BendAndHold, 2, 0, 1));
+    voice.insertPosition(first);
+
+    Position release(9, Position::QuarterNote);
+    release.insertNote(Note(2, 5));
+    release.getNotes()[0].setBend(Bend(Bend::GradualRelease, 0, 0));
+    voice.insertPosition(release);
+
+    Position hold(10, Position::QuarterNote);
+    hold.insertNote(Note(2, 5));
+    hold.getNotes()[0].setBend(Bend(Bend::BendAndHold, 4, 0, 1));
+    voice.insertPosition(hold);
+
+    Position last(17, Position::WholeNote);
+    last.insertNote(Note(2, 5));
+    voice.insertPosition(last);
+
+    system.insertStaff(staff);
+
+    PlayerChange change;
+    change.insertActivePlayer(0, ActivePlayer(0, 0));
+    system.insertPlayerChange(change);
+    score.insertSystem(system);
+
+    const std::vector<std::vector<std::string>> expected =
+        generateTracks(score, false, false);
+
+    REQUIRE(generateTracks(score, false, true) == expected);
+    REQUIRE(generateTracks(score, true, true) == expected);
+    REQUIRE(generateTracks(score, true, false) == expected);
+}
+
+TEST_CASE("Midi/MidiFile/UnlimitedControllerResolution", "")
+{
+    // The expected notes and controller values were generated before any
+    // redundant controller events were removed.
+    const std::map<std::string, std::string> expected =
+        readTimelines("data/midi_controller_timelines.txt");
+
+    for (const char *filename : theScores)
+    {
+        for (bool effects : { false, true })
+        {
+            const std::string name =
+                std::string(filename) + (effects ? " (effects)" : "");
+            INFO(name);
+
+            Score score;
+            loadScore(filename, score);
+            if (effects)
+                addEffects(score);
+
+            MidiFile::LoadOptions options = getOptions();
+            options.myControllerResolution = 0;
+            MidiFile file;
+            file.load(score, options);
+
+            REQUIRE(expected.count(name));
+            REQUIRE(describeTimelines(file) == expected.at(name));
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <midi/midifile.h>
+#include <midi/synthesizer.h>
+#include <score/generalmidi.h>
+#include <score/score.h>
+#include <vector>
+
+static const int SAMPLE_RATE = 8000;
+
+/// Creates a score with one bar of 4/4 at 120 bpm, where each player's staff
+/// has a whole note chord with the given number of notes (or a whole rest).
+static Score makeScore(int num_players, int num_notes)
+{
+    Score score;
+    System system;
+    PlayerChange change;
+
+    for (int i = 0; i < num_players; ++i)
+    {
+        score.insertPlayer(Player());
+        score.insertInstrument(Instrument());
+
+        Staff staff(6);
+        Position pos(1, Position::WholeNote);
+        pos.setRest(num_notes == 0);
+        for (int string = 0; string < num_notes; ++string)
+            pos.insertNote(Note(string, 5));
+        staff.getVoices()[0].insertPosition(pos);
+        system.insertStaff(staff);
+
+        change.insertActivePlayer(i, ActivePlayer(i, i));
+    }
+
+    system.insertPlayerChange(change);
+    score.insertSystem(system);
+    return score;
+}
+
+static MidiFile loadFile(const Score &score, bool metronome)
+{
+    MidiFile::LoadOptions options;
+    options.myEnableMetronome = metronome;
+    options.myMetronomePreset = Midi::MIDI_PERCUSSION_PRESET_OFFSET +
+                                Midi::MIDI_PERCUSSION_PRESET_SIDE_STICK;
+    options.myStrongAccentVel = 127;
+    options.myWeakAccentVel = 80;
+
+    MidiFile file;
+    file.load(score, options);
+    return file;
+}
+
+/// Renders the file, and returns the interleaved stereo samples.
+static std::vector<float> render(const MidiFile &file)
+{
+    std::vector<float> samples;
+    Synthesizer synth(SAMPLE_RATE);
+    synth.render(file, [&](const float *block, size_t frames) {
+        samples.insert(samples.end(), block,
+                       block + frames * Synthesizer::NUM_OUTPUT_CHANNELS);
+    });
+
+    return samples;
+}
+
+/// Returns the largest absolute value of the samples in the range of frames.
+static float getPeak(const std::vector<float> &samples, double start_seconds,
+                     double end_seconds)
+{
+    const size_t start = static_cast<size_t>(start_seconds * SAMPLE_RATE) *
+                         Synthesizer::NUM_OUTPUT_CHANNELS;
+    const size_t end = std::min(
+        samples.size(), static_cast<size_t>(end_seconds * SAMPLE_RATE) *
+                            Synthesizer::NUM_OUTPUT_CHANNELS);
+
+    float peak = 0;
+    for (size_t i = start; i < end; ++i)
+        peak = std::max(peak, std::abs(samples[i]));
+
+    return peak;
+}
+
+TEST_CASE("Midi/Synthesizer/Length", "")
+{
+    const std::vector<float> samples = render(loadFile(makeScore(1, 1), false));
+
+    // The bar lasts for two seconds, and is followed by 1.5 seconds for the
+    // notes to be released.
+    REQUIRE(samples.size() ==
+            static_cast<size_t>(3.5 * SAMPLE_RATE) *
+                Synthesizer::NUM_OUTPUT_CHANNELS);
+
+    // The release of the note is rendered after the end of the bar.
+    REQUIRE(getPeak(samples, 2, 2.05) > 0);
+    REQUIRE(getPeak(samples, 3, 3.5) < getPeak(samples, 2, 2.05));
+}
+
+TEST_CASE("Midi/Synthesizer/Silence", "")
+{
+    const std::vector<float> silence = render(loadFile(makeScore(1, 0), false));
+    REQUIRE(!silence.empty());
+    REQUIRE(getPeak(silence, 0, 3.5) == 0);
+
+    const std::vector<float> note = render(loadFile(makeScore(1, 1), false));
+    REQUIRE(getPeak(note, 0, 2) > 0.01);
+}
+
+TEST_CASE("Midi/Synthesizer/Percussion", "")
+{
+    // The metronome is played on the percussion channel (channel 10).
+    const MidiFile file = loadFile(makeScore(1, 0), true);
+
+    bool has_percussion = false;
+    for (const MidiEventList &track : file.getTracks())
+    {
+        for (const MidiEvent &event : track)
+        {
+            if (event.isNoteOn() && event.getChannel() == 9)
+                has_percussion = true;
+        }
+    }
+    REQUIRE(has_percussion);
+
+    // Each of the four beats has a click.
+    const std::vector<float> samples = render(file);
+    for (int beat = 0; beat < 4; ++beat)
+    {
+        INFO("beat " << beat);
+        REQUIRE(getPeak(samples, beat * 0.5, beat * 0.5 + 0.1) > 0.01);
+    }
+}
+
+TEST_CASE("Midi/Synthesizer/OverlappingVoices", "")
+{
+    // Eight players with six notes each would exceed the range if the voices
+    // weren't limited when they are mixed together.
+    const std::vector<float> samples = render(loadFile(makeScore(8, 6), true));
+
+    REQUIRE(std::all_of(samples.begin(), samples.end(), [](float sample) {
+        return sample >= -1 && sample <= 1;
+    }));
+    REQUIRE(getPeak(samples, 0, 2) > 0.5);
+}
@@ -0,0 +1,51 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#include <catch.hpp>
+
+#include <painters/detaillevel.h>
+
+/// Converts a zoom percentage in the same way as ScoreArea.
+static DetailLevel getZoomDetailLevel(int percent)
+{
+    return getDetailLevel(percent / 100.0);
+}
+
+TEST_CASE("Painters/DetailLevel/ZoomLevels", "")
+{
+    // These are the zoom levels offered by the playback widget.
+    REQUIRE(getZoomDetailLevel(10) == DetailLevel::Overview);
+    REQUIRE(getZoomDetailLevel(25) == DetailLevel::Reduced);
+    REQUIRE(getZoomDetailLevel(50) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(60) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(70) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(80) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(90) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(100) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(110) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(125) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(150) == DetailLevel::Full);
+    REQUIRE(getZoomDetailLevel(200) == DetailLevel::Full);
+}
+
+TEST_CASE("Painters/DetailLevel/Thresholds", "")
+{
+    REQUIRE(getDetailLevel(0.19) == DetailLevel::Overview);
+    REQUIRE(getDetailLevel(0.2) == DetailLevel::Reduced);
+    REQUIRE(getDetailLevel(0.39) == DetailLevel::Reduced);
+    REQUIRE(getDetailLevel(0.4) == DetailLevel::Full);
+}
@@ -0,0 +1,196 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#include <catch.hpp>
+
+#include <algorithm>
+#include <app/viewoptions.h>
+#include <memory>
+#include <painters/clickindex.h>
+#include <painters/layoutcache.h>
+#include <painters/staffpainter.h>
+#include <painters/systemrenderer.h>
+#include <score/score.h>
+#include <vector>
+
+/// Creates a score with a single system that has three staves.
+static Score makeScore()
+{
+    Score score;
+    System system;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Staff staff(6);
+        for (int j = 1; j <= 4; ++j)
+        {
+            Position pos(j * 2, Position::QuarterNote);
+            pos.insertNote(Note(i + 1, j));
+            staff.getVoices()[0].insertPosition(pos);
+        }
+        system.insertStaff(staff);
+    }
+
+    score.insertSystem(system);
+    return score;
+}
+
+/// Returns the staves of a rendered system, from top to bottom.
+static std::vector<StaffPainter *> getStaves(QGraphicsItem *system)
+{
+    std::vector<StaffPainter *> staves;
+    for (QGraphicsItem *item : system->childItems())
+    {
+        if (auto painter = dynamic_cast<StaffPainter *>(item))
+            staves.push_back(painter);
+    }
+
+    std::sort(staves.begin(), staves.end(),
+              [](const StaffPainter *a, const StaffPainter *b) {
+                  return a->y() < b->y();
+              });
+    return staves;
+}
+
+static bool isSameRegion(const ClickIndex::Region *a,
+                         const ClickIndex::Region *b)
+{
+    if (!a || !b)
+        return a == b;
+
+    return a->myRect == b->myRect && a->myType == b->myType &&
+           a->myStaff == b->myStaff && a->myPosition == b->myPosition &&
+           a->myToolTip == b->myToolTip;
+}
+
+static bool isSameStaff(const ClickIndex::StaffRegion *a,
+                        const ClickIndex::StaffRegion *b)
+{
+    if (!a || !b)
+        return a == b;
+
+    return a->myRect == b->myRect && a->myStaff == b->myStaff;
+}
+
+/// Checks that every point in the system resolves to the same symbols and
+/// staves in both indices.
+static void checkSameRegions(const ClickIndex &index,
+                             const ClickIndex &expected, const QRectF &bounds)
+{
+    for (double y = bounds.top(); y < bounds.bottom(); y += 2)
+    {
+        for (double x = bounds.left(); x < bounds.right(); x += 2)
+        {
+            const QPointF pos(x, y);
+            if (!isSameRegion(index.findRegion(pos),
+                              expected.findRegion(pos)) ||
+                !isSameStaff(index.findStaff(pos), expected.findStaff(pos)))
+            {
+                FAIL("Different regions at (" << x << ", " << y << ")");
+            }
+        }
+    }
+}
+
+TEST_CASE("Painters/SystemRenderer/RedrawStaves", "")
+{
+    Score score = makeScore();
+    const Score &const_score = score;
+    ViewOptions view_options;
+    auto layout_cache = std::make_shared<LayoutCache>();
+
+    SystemRenderer renderer(score, view_options, layout_cache);
+    std::unique_ptr<QGraphicsItem> system(
+        renderer(const_score.getSystems()[0], 0));
+    const ClickIndex click_index = renderer.getClickIndex();
+    const std::vector<StaffPainter *> old_staves = getStaves(system.get());
+    REQUIRE(old_staves.size() == 3);
+    const double old_height = system->boundingRect().height();
+
+    // Adding vibrato to the middle staff makes it taller, so the staff below
+    // it has to move down.
+    score.getSystems()[0].getStaves()[1].getVoices()[0].getPositions()[0]
+        .setProperty(Position::Vibrato);
+
+    SystemRenderer redraw(score, view_options, layout_cache);
+    REQUIRE(redraw.redrawStaves(system.get(), click_index,
+                                const_score.getSystems()[0], 0));
+    REQUIRE(system->boundingRect().height() > old_height);
+
+    // The unmodified staves are kept.
+    const std::vector<StaffPainter *> staves = getStaves(system.get());
+    REQUIRE(staves.size() == 3);
+    REQUIRE(staves[0] == old_staves[0]);
+    REQUIRE(staves[1] != old_staves[1]);
+    REQUIRE(staves[2] == old_staves[2]);
+
+    // The clickable regions of the unmodified staves are reused, along with
+    // their layouts.
+    const ClickIndex &new_index = redraw.getClickIndex();
+    for (int i : { 0, 2 })
+    {
+        const QPointF center =
+            staves[i]->mapRectToItem(system.get(), staves[i]->boundingRect())
+                .center();
+        const ClickIndex::StaffRegion *staff = new_index.findStaff(center);
+        REQUIRE(staff);
+        REQUIRE(staff->myStaff == i);
+        REQUIRE(staff->myLayout == staves[i]->getLayout());
+    }
+
+    // The result matches a full redraw of the system.
+    SystemRenderer full(score, view_options, std::make_shared<LayoutCache>());
+    std::unique_ptr<QGraphicsItem> expected(
+        full(const_score.getSystems()[0], 0));
+    const std::vector<StaffPainter *> expected_staves =
+        getStaves(expected.get());
+
+    REQUIRE(system->boundingRect() == expected->boundingRect());
+    for (size_t i = 0; i < staves.size(); ++i)
+    {
+        INFO("staff " << i);
+        REQUIRE(staves[i]->pos() == expected_staves[i]->pos());
+        REQUIRE(staves[i]->boundingRect() ==
+                expected_staves[i]->boundingRect());
+        REQUIRE(staves[i]->childItems().size() ==
+                expected_staves[i]->childItems().size());
+    }
+
+    checkSameRegions(new_index, full.getClickIndex(),
+                     expected->boundingRect());
+}
+
+TEST_CASE("Painters/SystemRenderer/RedrawModifiedSystem", "")
+{
+    Score score = makeScore();
+    const Score &const_score = score;
+    ViewOptions view_options;
+    auto layout_cache = std::make_shared<LayoutCache>();
+
+    SystemRenderer renderer(score, view_options, layout_cache);
+    std::unique_ptr<QGraphicsItem> system(
+        renderer(const_score.getSystems()[0], 0));
+    const ClickIndex click_index = renderer.getClickIndex();
+
+    // Changing the system's own symbols affects every staff, so none of them
+    // can be kept.
+    score.getSystems()[0].insertBarline(Barline(5, Barline::SingleBar));
+
+    SystemRenderer redraw(score, view_options, layout_cache);
+    REQUIRE(!redraw.redrawStaves(system.get(), click_index,
+                                 const_score.getSystems()[0], 0));
+}
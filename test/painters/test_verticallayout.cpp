@@ -0,0 +1,74 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+  
+#include <catch.hpp>
+
+#include <algorithm>
+#include <painters/verticallayout.h>
+#include <random>
+#include <vector>
+
+TEST_CASE("Painters/VerticalLayout/Stacking", "")
+{
+    VerticalLayout layout;
+
+    REQUIRE(layout.addBox(0, 4, 1) == 1);
+    REQUIRE(layout.addBox(2, 6, 1) == 2);
+    REQUIRE(layout.addBox(6, 8, 2) == 2);
+    REQUIRE(layout.addBox(4, 7, 1) == 3);
+
+    REQUIRE(layout.getHeight(0) == 1);
+    REQUIRE(layout.getHeight(3) == 2);
+    REQUIRE(layout.getHeight(6) == 3);
+    REQUIRE(layout.getHeight(7) == 2);
+    REQUIRE(layout.getHeight(100) == 0);
+
+    // Boxes can be placed beyond the current size of the layout.
+    REQUIRE(layout.addBox(500, 510, 1) == 1);
+    REQUIRE(layout.getHeight(3) == 2);
+}
+
+TEST_CASE("Painters/VerticalLayout/MatchesSimpleLayout", "")
+{
+    // Compare against the straightforward approach of updating every position
+    // that a box spans.
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> leftDist(0, 200);
+    std::uniform_int_distribution<int> widthDist(1, 30);
+    std::uniform_int_distribution<int> heightDist(1, 3);
+
+    VerticalLayout layout;
+    std::vector<int> heights;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        const int left = leftDist(generator);
+        const int right = left + widthDist(generator);
+        const int height = heightDist(generator);
+
+        heights.resize(std::max<size_t>(heights.size(), right));
+        const int expected =
+            *std::max_element(heights.begin() + left, heights.begin() + right) +
+            height;
+        std::fill(heights.begin() + left, heights.begin() + right, expected);
+
+        REQUIRE(layout.addBox(left, right, height) == expected);
+    }
+
+    for (size_t i = 0; i < heights.size(); ++i)
+        REQUIRE(layout.getHeight(static_cast<int>(i)) == heights[i]);
+}
@@ -32,6 +32,106 @@ TEST_CASE("Score/Score/Systems", "")
     REQUIRE(score.getSystems().size() == 0);
 }
 
+TEST_CASE("Score/Score/Snapshots", "")
+{
+    Score score;
+    System system;
+    system.insertStaff(Staff(6));
+    system.insertStaff(Staff(7));
+    score.insertSystem(system);
+    score.insertSystem(system);
+
+    const Score &constScore = score;
+    const Score::SystemList snapshot = score.getSystemsSnapshot();
+    REQUIRE(snapshot.isSameAs(score.getSystemsSnapshot()));
+
+    // Reading from the score should not copy anything.
+    REQUIRE(constScore.getSystems()[1].getStaves()[1].getStringCount() == 7);
+    REQUIRE(snapshot.isSameAs(score.getSystemsSnapshot()));
+
+    // Modifying a staff should only copy that staff.
+    score.getSystems()[1].getStaves()[1].setStringCount(5);
+    REQUIRE(constScore.getSystems()[1].getStaves()[1].getStringCount() == 5);
+    REQUIRE((*snapshot)[1]->getStaves()[1].getStringCount() == 7);
+    REQUIRE(&constScore.getSystems()[0] == &*(*snapshot)[0]);
+    REQUIRE(&constScore.getSystems()[1].getStaves()[0] ==
+            &(*snapshot)[1]->getStaves()[0]);
+
+    score.restoreSystemsSnapshot(snapshot);
+    REQUIRE(constScore.getSystems()[1].getStaves()[1].getStringCount() == 7);
+
+    // A copy of the score is independent from the original.
+    Score copy(score);
+    REQUIRE(copy == score);
+    copy.removeSystem(0);
+    REQUIRE(score.getSystems().size() == 2);
+    REQUIRE(copy.getSystems().size() == 1);
+}
+
+TEST_CASE("Score/Score/Revisions", "")
+{
+    Score score;
+    System system;
+    system.insertStaff(Staff());
+    system.insertStaff(Staff());
+    score.insertSystem(system);
+
+    const Score &constScore = score;
+    const uint64_t scoreRevision = score.getRevision();
+    const uint64_t systemRevision = constScore.getSystems()[0].getRevision();
+    const uint64_t staffRevision =
+        constScore.getSystems()[0].getStaves()[0].getRevision();
+    const uint64_t otherStaffRevision =
+        constScore.getSystems()[0].getStaves()[1].getRevision();
+
+    // Reading from the score does not change any revisions.
+    REQUIRE(constScore.getSystems()[0].getStaves()[1].getStringCount() == 6);
+    REQUIRE(score.getRevision() == scoreRevision);
+
+    score.getSystems()[0].getStaves()[0].setClefType(Staff::BassClef);
+    REQUIRE(score.getRevision() > scoreRevision);
+    REQUIRE(constScore.getSystems()[0].getRevision() > systemRevision);
+    REQUIRE(constScore.getSystems()[0].getStaves()[0].getRevision() >
+            staffRevision);
+    REQUIRE(constScore.getSystems()[0].getStaves()[1].getRevision() ==
+            otherStaffRevision);
+
+    // Copies keep the revision until they are modified.
+    Score copy(score);
+    REQUIRE(copy.getRevision() == score.getRevision());
+    copy.setLineSpacing(10);
+    REQUIRE(copy.getRevision() > score.getRevision());
+}
+
+TEST_CASE("Score/Score/ContentHash", "")
+{
+    Score score1;
+    Score score2;
+    System system;
+    system.insertStaff(Staff());
+    score1.insertSystem(system);
+    score2.insertSystem(system);
+
+    const Score &constScore1 = score1;
+    const Score &constScore2 = score2;
+    REQUIRE(score1.getContentHash() == score2.getContentHash());
+    REQUIRE(constScore1.getSystems()[0].getContentHash() ==
+            constScore2.getSystems()[0].getContentHash());
+
+    score2.getSystems()[0].getStaves()[0].setClefType(Staff::BassClef);
+    REQUIRE(score1.getContentHash() != score2.getContentHash());
+    REQUIRE(constScore1.getSystems()[0].getContentHash() !=
+            constScore2.getSystems()[0].getContentHash());
+    REQUIRE(constScore1.getSystems()[0].getStaves()[0].getContentHash() !=
+            constScore2.getSystems()[0].getStaves()[0].getContentHash());
+
+    score2.getSystems()[0].getStaves()[0].setClefType(Staff::TrebleClef);
+    REQUIRE(score1.getContentHash() == score2.getContentHash());
+
+    score2.setLineSpacing(12);
+    REQUIRE(score1.getContentHash() != score2.getContentHash());
+}
+
 TEST_CASE("Score/Score/Players", "")
 {
     Score score;
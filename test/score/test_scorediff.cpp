@@ -0,0 +1,80 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <score/score.h>
+#include <score/utils/scorediff.h>
+
+using ScoreUtils::SystemDifference;
+
+static System makeSystem(int stringCount)
+{
+    System system;
+    system.insertStaff(Staff(stringCount));
+    return system;
+}
+
+TEST_CASE("Score/ScoreDiff/Identical", "")
+{
+    Score oldScore;
+    Score newScore;
+    for (int i = 0; i < 5; ++i)
+    {
+        oldScore.insertSystem(makeSystem(i + 4));
+        newScore.insertSystem(makeSystem(i + 4));
+    }
+
+    REQUIRE(ScoreUtils::diffScores(oldScore, newScore).empty());
+}
+
+TEST_CASE("Score/ScoreDiff/Changes", "")
+{
+    Score oldScore;
+    for (int i = 0; i < 5; ++i)
+        oldScore.insertSystem(makeSystem(i + 4));
+
+    Score newScore(oldScore);
+    newScore.getSystems()[1].getStaves()[0].setClefType(Staff::BassClef);
+    newScore.removeSystem(3);
+    newScore.insertSystem(makeSystem(3), 0);
+
+    const std::vector<SystemDifference> expected = {
+        SystemDifference(SystemDifference::Inserted, -1, 0),
+        SystemDifference(SystemDifference::Changed, 1, 2),
+        SystemDifference(SystemDifference::Removed, 3, -1)
+    };
+
+    REQUIRE(ScoreUtils::diffScores(oldScore, newScore) == expected);
+}
+
+TEST_CASE("Score/ScoreDiff/AppendedSystems", "")
+{
+    Score oldScore;
+    oldScore.insertSystem(makeSystem(6));
+
+    Score newScore(oldScore);
+    newScore.insertSystem(makeSystem(7));
+    newScore.insertSystem(makeSystem(8));
+
+    const std::vector<SystemDifference> expected = {
+        SystemDifference(SystemDifference::Inserted, -1, 1),
+        SystemDifference(SystemDifference::Inserted, -1, 2)
+    };
+
+    REQUIRE(ScoreUtils::diffScores(oldScore, newScore) == expected);
+}
@@ -203,3 +203,22 @@ TEST_CASE("Score/System/TextItems", "")
     REQUIRE(system.getTextItems().size() == 1);
     REQUIRE(system.getTextItems()[0] == text1);
 }
+
+TEST_CASE("Score/System/Revisions", "")
+{
+    System system;
+    system.insertStaff(Staff());
+    system.insertStaff(Staff());
+
+    const uint64_t revision = system.getRevision();
+    const uint64_t ownRevision = system.getOwnRevision();
+
+    // Modifying a staff does not change the system's own revision.
+    system.getStaves()[1].setStringCount(7);
+    REQUIRE(system.getRevision() > revision);
+    REQUIRE(system.getOwnRevision() == ownRevision);
+
+    system.insertBarline(Barline(4, Barline::DoubleBar));
+    REQUIRE(system.getOwnRevision() > ownRevision);
+    REQUIRE(system.getOwnRevision() == system.getRevision());
+}
@@ -0,0 +1,121 @@
+/*
+  * Copyright (C) 2016 Cameron White
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <catch.hpp>
+
+#include <score/ticks.h>
+#include <score/voice.h>
+#include <score/voiceutils.h>
+
+static Position makePosition(int position, Position::DurationType duration)
+{
+    Position pos(position);
+    pos.setDurationType(duration);
+    return pos;
+}
+
+TEST_CASE("Score/VoiceTimeline/Onsets", "")
+{
+    Voice voice;
+    voice.insertPosition(makePosition(0, Position::QuarterNote));
+    voice.insertPosition(makePosition(2, Position::EighthNote));
+    voice.insertPosition(makePosition(4, Position::EighthNote));
+    voice.insertPosition(makePosition(6, Position::EighthNote));
+    voice.insertPosition(makePosition(8, Position::HalfNote));
+    voice.insertIrregularGrouping(IrregularGrouping(2, 3, 3, 2));
+
+    const VoiceTimeline &timeline = voice.getTimeline();
+    const int64_t quarter = Ticks::PER_QUARTER;
+
+    REQUIRE(timeline.getPositionCount() == 5);
+    REQUIRE(timeline.getOnset(0) == 0);
+    REQUIRE(timeline.getOnset(1) == quarter);
+    REQUIRE(timeline.getDuration(1) == quarter / 3);
+    REQUIRE(timeline.getOnset(4) == 2 * quarter);
+    REQUIRE(timeline.getTotalDuration() == 4 * quarter);
+
+    REQUIRE(timeline.findIndex(6) == 3);
+    REQUIRE(timeline.findIndex(5) == -1);
+
+    REQUIRE(timeline.findIndexAtTick(0) == 0);
+    REQUIRE(timeline.findIndexAtTick(quarter - 1) == 0);
+    REQUIRE(timeline.findIndexAtTick(quarter + quarter / 3) == 2);
+    REQUIRE(timeline.findIndexAtTick(3 * quarter) == 4);
+    REQUIRE(timeline.findIndexAtTick(4 * quarter) == -1);
+}
+
+TEST_CASE("Score/VoiceTimeline/GraceNotes", "")
+{
+    Voice voice;
+    Position grace = makePosition(0, Position::EighthNote);
+    grace.setProperty(Position::Acciaccatura);
+    voice.insertPosition(grace);
+    voice.insertPosition(makePosition(1, Position::QuarterNote));
+
+    const VoiceTimeline &timeline = voice.getTimeline();
+    REQUIRE(timeline.getDuration(0) == 0);
+    REQUIRE(timeline.findIndexAtTick(0) == 1);
+}
+
+TEST_CASE("Score/VoiceTimeline/MatchesDurationTime", "")
+{
+    Voice voice;
+    const Position::DurationType durations[] = {
+        Position::WholeNote, Position::SixtyFourthNote, Position::EighthNote,
+        Position::ThirtySecondNote, Position::SixteenthNote
+    };
+
+    for (int i = 0; i < 20; ++i)
+    {
+        Position pos = makePosition(i, durations[i % 5]);
+        if (i % 3 == 0)
+            pos.setProperty(Position::DoubleDotted);
+        else if (i % 4 == 0)
+            pos.setProperty(Position::Dotted);
+        voice.insertPosition(pos);
+    }
+
+    voice.insertIrregularGrouping(IrregularGrouping(2, 7, 7, 4));
+    voice.insertIrregularGrouping(IrregularGrouping(12, 5, 16, 5));
+
+    const Voice &constVoice = voice;
+    const VoiceTimeline &timeline = constVoice.getTimeline();
+    int index = 0;
+    for (const Position &pos : constVoice.getPositions())
+    {
+        REQUIRE(timeline.getDuration(index) ==
+                VoiceUtils::getDurationTime(voice, pos));
+        ++index;
+    }
+}
+
+TEST_CASE("Score/VoiceTimeline/Invalidation", "")
+{
+    Voice voice;
+    voice.insertPosition(makePosition(0, Position::QuarterNote));
+    REQUIRE(voice.getTimeline().getTotalDuration() == Ticks::PER_QUARTER);
+
+    voice.getPositions()[0].setDurationType(Position::HalfNote);
+    REQUIRE(voice.getTimeline().getTotalDuration() == 2 * Ticks::PER_QUARTER);
+
+    // Copies share the timeline until they are modified.
+    Voice copy(voice);
+    REQUIRE(&copy.getTimeline() == &voice.getTimeline());
+    copy.insertPosition(makePosition(4, Position::QuarterNote));
+    REQUIRE(copy.getTimeline().getTotalDuration() == 3 * Ticks::PER_QUARTER);
+    REQUIRE(voice.getTimeline().getTotalDuration() == 2 * Ticks::PER_QUARTER);
+}
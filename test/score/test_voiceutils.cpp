@@ -17,6 +17,7 @@
   
 #include <catch.hpp>
 
+#include <score/ticks.h>
 #include <score/voiceutils.h>
 #include <score/voice.h>
 
@@ -27,18 +28,22 @@ TEST_CASE("Score/VoiceUtils/GetDurationTime", "")
     Position &position = voice.getPositions().front();
 
     position.setDurationType(Position::QuarterNote);
-    REQUIRE(VoiceUtils::getDurationTime(voice, position) == 1);
+    REQUIRE(VoiceUtils::getDurationTime(voice, position) ==
+            Ticks::PER_QUARTER);
 
     position.setDurationType(Position::EighthNote);
     REQUIRE(VoiceUtils::getDurationTime(voice, position) ==
-            boost::rational<int>(1, 2));
+            Ticks::PER_QUARTER / 2);
 
     position.setDurationType(Position::WholeNote);
-    REQUIRE(VoiceUtils::getDurationTime(voice, position) == 4);
+    REQUIRE(VoiceUtils::getDurationTime(voice, position) ==
+            4 * Ticks::PER_QUARTER);
 
     position.setProperty(Position::Dotted);
-    REQUIRE(VoiceUtils::getDurationTime(voice, position) == 6);
+    REQUIRE(VoiceUtils::getDurationTime(voice, position) ==
+            6 * Ticks::PER_QUARTER);
 
     voice.insertIrregularGrouping(IrregularGrouping(7, 1, 3, 2));
-    REQUIRE(VoiceUtils::getDurationTime(voice, position) == 4);
+    REQUIRE(VoiceUtils::getDurationTime(voice, position) ==
+            4 * Ticks::PER_QUARTER);
 }
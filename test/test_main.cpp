@@ -17,13 +17,17 @@
 
 #define CATCH_CONFIG_RUNNER
 #include <catch.hpp>
-#include <QCoreApplication>
+#include <QApplication>
 
 int main(int argc, char *argv[])
 {
-    // Initialize QCoreApplication for any tests that use
-    // QCoreApplication::applicationDirPath().
-    QCoreApplication app(argc, argv);
+    // The painter tests need fonts, but shouldn't require a display.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // Initialize QApplication for any tests that use
+    // QCoreApplication::applicationDirPath() or render the score.
+    QApplication app(argc, argv);
 
     return Catch::Session().run(argc, argv);
 }